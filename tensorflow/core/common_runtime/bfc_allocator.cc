@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 
+#include <algorithm>
 #include <atomic>
 
 #include "absl/strings/string_view.h"
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -36,16 +38,38 @@ namespace tensorflow {
 
 constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
 constexpr uint64 BFCAllocator::kMemDebugHistorySize;
+constexpr size_t BFCAllocator::kMagazineCapacity;
+constexpr int64 BFCAllocator::kMagazineTrimInterval;
+
+namespace {
+
+// The number of shards of the live chunk index per magazine.
+constexpr int kLiveChunkShardsPerMagazine = 4;
+
+// Sets '*value' to 'v' if 'v' is larger.
+void AtomicMax(std::atomic<int64>* value, int64 v) {
+  int64 current = value->load(std::memory_order_relaxed);
+  while (v > current &&
+         !value->compare_exchange_weak(current, v, std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
 
 BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                            bool allow_growth, const string& name,
-                           bool garbage_collection)
+                           bool garbage_collection, bool thread_local_cache)
     : garbage_collection_(garbage_collection),
+      thread_local_cache_(thread_local_cache),
       coalesce_regions_(sub_allocator->SupportsCoalescing()),
       sub_allocator_(sub_allocator),
       name_(name),
       free_chunks_list_(kInvalidChunkHandle),
-      next_allocation_id_(1) {
+      next_allocation_id_(1),
+      magazines_(thread_local_cache ? port::MaxParallelism() : 0),
+      live_chunks_(thread_local_cache
+                       ? kLiveChunkShardsPerMagazine * port::MaxParallelism()
+                       : 0) {
   if (allow_growth) {
     // 2MiB smallest initial allocation, unless total memory available
     // is less.
@@ -253,6 +277,12 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(1) << "AllocateRaw " << Name() << "  " << num_bytes;
+  if (thread_local_cache_ && num_bytes > 0) {
+    void* ptr = AllocateFromMagazine(num_bytes);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
   if (!allocation_attr.retry_on_failure) {
     // Return immediately upon the first failure if this is for allocating an
     // optional scratch space.
@@ -435,6 +465,16 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // The chunks held in the per-thread magazines may coalesce into a chunk that
+  // is large enough.
+  if (thread_local_cache_ && FlushMagazines()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   // Reaching this point means that no chunks can satisfy the request. Also,
   // the unallocated bytes cannot satisfy the request. Before giving up, let's
   // try deallocating free regions so that suballocator can combine them with
@@ -565,6 +605,13 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
             std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
         stats_.largest_alloc_size =
             std::max<std::size_t>(stats_.largest_alloc_size, chunk->size);
+        if (thread_local_cache_) {
+          AddClientBytesInUse(chunk->size);
+          if (BinNumForSize(chunk->size) < kNumCachedBins) {
+            AddLiveChunk(chunk->ptr, chunk->size, num_bytes,
+                         chunk->allocation_id);
+          }
+        }
         if (ShouldRecordOpName()) {
           const auto& annotation =
               ScopedMemoryDebugAnnotation::CurrentAnnotation();
@@ -635,6 +682,11 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(1) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
+  if (thread_local_cache_ && ptr != nullptr && DeallocateToMagazine(ptr)) {
+    // The chunk is still in use as far as the bins are concerned, so there is
+    // no need to wake up the allocations waiting for memory.
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -655,6 +707,21 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   int64 req_bytes = chunk->requested_size;
   int64 alloc_bytes = chunk->size;
 
+  FreeChunk(h);
+  if (thread_local_cache_) {
+    AddClientBytesInUse(-alloc_bytes);
+  }
+
+  // TraceMe needs to be added after MarkFree and InsertFreeChunkIntoBin for
+  // correct aggregation stats (bytes_in_use, fragmentation).
+  AddTraceMe("MemoryDeallocation", chunk_ptr, req_bytes, alloc_bytes);
+
+  if (VLOG_IS_ON(4)) {
+    LOG(INFO) << "F: " << RenderOccupancy();
+  }
+}
+
+void BFCAllocator::FreeChunk(ChunkHandle h) {
   MarkFree(h);
 
   // Consider coalescing it.
@@ -664,14 +731,175 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   } else {
     InsertFreeChunkIntoBin(TryToCoalesce(h, false));
   }
+}
 
-  // TraceMe needs to be added after MarkFree and InsertFreeChunkIntoBin for
-  // correct aggregation stats (bytes_in_use, fragmentation).
-  AddTraceMe("MemoryDeallocation", chunk_ptr, req_bytes, alloc_bytes);
+BFCAllocator::Magazine* BFCAllocator::ThreadMagazine() {
+  static std::atomic<uint32> next_thread_index{0};
+  static thread_local const uint32 thread_index = next_thread_index++;
+  return &magazines_[thread_index % magazines_.size()];
+}
 
-  if (VLOG_IS_ON(4)) {
-    LOG(INFO) << "F: " << RenderOccupancy();
+void BFCAllocator::AddLiveChunk(void* ptr, size_t size, size_t requested_size,
+                                int64 allocation_id) {
+  LiveChunkShard* shard = LiveChunkShardFor(ptr);
+  mutex_lock l(shard->mu);
+  shard->chunks[ptr] = {size, requested_size, allocation_id};
+}
+
+bool BFCAllocator::FindLiveChunk(const void* ptr, LiveChunk* live_chunk) const {
+  if (!thread_local_cache_) {
+    return false;
+  }
+  LiveChunkShard* shard = LiveChunkShardFor(ptr);
+  mutex_lock l(shard->mu);
+  auto it = shard->chunks.find(ptr);
+  if (it == shard->chunks.end()) {
+    return false;
   }
+  *live_chunk = it->second;
+  return true;
+}
+
+void* BFCAllocator::AllocateFromMagazine(size_t num_bytes) {
+  const size_t rounded_bytes = RoundedBytes(num_bytes);
+  const BinNum bin_num = BinNumForSize(rounded_bytes);
+  if (bin_num >= kNumCachedBins) {
+    return nullptr;
+  }
+  CachedChunk chunk;
+  std::vector<CachedChunk> chunks_to_free;
+  Magazine* magazine = ThreadMagazine();
+  {
+    mutex_lock l(magazine->mu);
+    std::vector<CachedChunk>& bin = magazine->bins[bin_num];
+    // The chunks in a bin are up to twice as large as the bin size, so take
+    // the most recently freed one that fits.
+    auto it = std::find_if(bin.rbegin(), bin.rend(),
+                           [rounded_bytes](const CachedChunk& c) {
+                             return c.size >= rounded_bytes;
+                           });
+    if (it == bin.rend()) {
+      return nullptr;
+    }
+    chunk = *it;
+    bin.erase(std::next(it).base());
+    magazine->low_watermarks[bin_num] =
+        std::min(magazine->low_watermarks[bin_num], bin.size());
+    MaybeTrimMagazine(magazine, &chunks_to_free);
+  }
+  ReturnCachedChunks(chunks_to_free);
+  AddLiveChunk(chunk.ptr, chunk.size, num_bytes, next_allocation_id_++);
+  ++cache_stats_.num_allocs;
+  AddClientBytesInUse(chunk.size);
+  AtomicMax(&cache_stats_.largest_alloc_size, chunk.size);
+  VLOG(4) << "Returning from magazine: " << chunk.ptr;
+  return chunk.ptr;
+}
+
+bool BFCAllocator::DeallocateToMagazine(void* ptr) {
+  LiveChunk live_chunk;
+  {
+    LiveChunkShard* shard = LiveChunkShardFor(ptr);
+    mutex_lock l(shard->mu);
+    auto it = shard->chunks.find(ptr);
+    if (it == shard->chunks.end()) {
+      // The chunk is too large to be cached.
+      return false;
+    }
+    live_chunk = it->second;
+    shard->chunks.erase(it);
+  }
+  if (timing_counter_ != nullptr) {
+    // The chunk must be timestamped when it is freed.
+    return false;
+  }
+  AddClientBytesInUse(-static_cast<int64>(live_chunk.size));
+  const BinNum bin_num = BinNumForSize(live_chunk.size);
+  std::vector<CachedChunk> chunks_to_free;
+  Magazine* magazine = ThreadMagazine();
+  {
+    mutex_lock l(magazine->mu);
+    std::vector<CachedChunk>& bin = magazine->bins[bin_num];
+    bin.push_back({ptr, live_chunk.size});
+    if (bin.size() > kMagazineCapacity) {
+      // Return the least recently freed half of the bin.
+      const size_t n = bin.size() / 2;
+      chunks_to_free.assign(bin.begin(), bin.begin() + n);
+      bin.erase(bin.begin(), bin.begin() + n);
+      magazine->low_watermarks[bin_num] =
+          std::min(magazine->low_watermarks[bin_num], bin.size());
+    }
+    MaybeTrimMagazine(magazine, &chunks_to_free);
+  }
+  ReturnCachedChunks(chunks_to_free);
+  return true;
+}
+
+void BFCAllocator::MaybeTrimMagazine(Magazine* magazine,
+                                     std::vector<CachedChunk>* chunks) {
+  if (++magazine->ops_since_trim < kMagazineTrimInterval) {
+    return;
+  }
+  magazine->ops_since_trim = 0;
+  for (BinNum b = 0; b < kNumCachedBins; ++b) {
+    // The least recently freed chunks of the bin, up to its low watermark,
+    // were not needed during the last interval.
+    std::vector<CachedChunk>& bin = magazine->bins[b];
+    const size_t n = magazine->low_watermarks[b];
+    chunks->insert(chunks->end(), bin.begin(), bin.begin() + n);
+    bin.erase(bin.begin(), bin.begin() + n);
+    magazine->low_watermarks[b] = bin.size();
+  }
+}
+
+void BFCAllocator::FreeCachedChunks(const std::vector<CachedChunk>& chunks) {
+  for (const CachedChunk& chunk : chunks) {
+    BFCAllocator::ChunkHandle h = region_manager_.get_handle(chunk.ptr);
+    CHECK(h != kInvalidChunkHandle);
+    FreeChunk(h);
+  }
+}
+
+void BFCAllocator::ReturnCachedChunks(const std::vector<CachedChunk>& chunks) {
+  if (chunks.empty()) {
+    return;
+  }
+  {
+    mutex_lock l(lock_);
+    FreeCachedChunks(chunks);
+  }
+  retry_helper_.NotifyDealloc();
+}
+
+bool BFCAllocator::FlushMagazines() {
+  std::vector<CachedChunk> chunks;
+  for (Magazine& magazine : magazines_) {
+    mutex_lock l(magazine.mu);
+    for (BinNum b = 0; b < kNumCachedBins; ++b) {
+      chunks.insert(chunks.end(), magazine.bins[b].begin(),
+                    magazine.bins[b].end());
+      magazine.bins[b].clear();
+      magazine.low_watermarks[b] = 0;
+    }
+  }
+  VLOG(2) << "Returning " << chunks.size() << " chunks from magazines";
+  FreeCachedChunks(chunks);
+  return !chunks.empty();
+}
+
+void BFCAllocator::FlushThreadLocalCaches() {
+  {
+    mutex_lock l(lock_);
+    if (!FlushMagazines()) {
+      return;
+    }
+  }
+  retry_helper_.NotifyDealloc();
+}
+
+void BFCAllocator::AddClientBytesInUse(int64 bytes) {
+  const int64 bytes_in_use = cache_stats_.bytes_in_use.fetch_add(bytes) + bytes;
+  AtomicMax(&cache_stats_.peak_bytes_in_use, bytes_in_use);
 }
 
 // Merges h1 and h2 when Chunk(h1)->next is h2 and Chunk(h2)->prev is c1.
@@ -886,6 +1114,10 @@ bool BFCAllocator::TracksAllocationSizes() const { return true; }
 
 size_t BFCAllocator::RequestedSize(const void* ptr) const {
   CHECK(ptr);
+  LiveChunk live_chunk;
+  if (FindLiveChunk(ptr, &live_chunk)) {
+    return live_chunk.requested_size;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -895,6 +1127,10 @@ size_t BFCAllocator::RequestedSize(const void* ptr) const {
 }
 
 size_t BFCAllocator::AllocatedSize(const void* ptr) const {
+  LiveChunk live_chunk;
+  if (FindLiveChunk(ptr, &live_chunk)) {
+    return live_chunk.size;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -904,6 +1140,10 @@ size_t BFCAllocator::AllocatedSize(const void* ptr) const {
 }
 
 int64 BFCAllocator::AllocationId(const void* ptr) const {
+  LiveChunk live_chunk;
+  if (FindLiveChunk(ptr, &live_chunk)) {
+    return live_chunk.allocation_id;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -1151,7 +1391,16 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  if (thread_local_cache_) {
+    // stats_ counts the chunks held in magazines as in use.
+    stats.num_allocs += cache_stats_.num_allocs;
+    stats.bytes_in_use = cache_stats_.bytes_in_use;
+    stats.peak_bytes_in_use = cache_stats_.peak_bytes_in_use;
+    stats.largest_alloc_size = std::max<int64>(
+        stats.largest_alloc_size, cache_stats_.largest_alloc_size);
+  }
+  return stats;
 }
 
 void BFCAllocator::ClearStats() {
@@ -1159,6 +1408,9 @@ void BFCAllocator::ClearStats() {
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
   stats_.largest_alloc_size = 0;
+  cache_stats_.num_allocs = 0;
+  cache_stats_.peak_bytes_in_use = cache_stats_.bytes_in_use.load();
+  cache_stats_.largest_alloc_size = 0;
 }
 
 std::array<BFCAllocator::BinDebugInfo, BFCAllocator::kNumBins>
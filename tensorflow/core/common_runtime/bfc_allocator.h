@@ -17,12 +17,14 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_BFC_ALLOCATOR_H_
 
 #include <array>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
@@ -46,12 +48,18 @@ class MemoryDump;
 // coalescing.  One assumption we make is that the process using this
 // allocator owns pretty much all of the memory, and that nearly
 // all requests to allocate memory go through this interface.
+//
+// If thread_local_cache is true, small chunks freed by a thread are kept in a
+// cache (a "magazine") for that thread's later allocations, so that most
+// allocations and deallocations of small buffers do not take the allocator's
+// global lock.  See "Per-thread magazines" below.
 class BFCAllocator : public Allocator {
  public:
   // Takes ownership of sub_allocator.
   BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                bool allow_growth, const string& name,
-               bool garbage_collection = false);
+               bool garbage_collection = false,
+               bool thread_local_cache = false);
   ~BFCAllocator() override;
 
   string Name() override { return name_; }
@@ -85,6 +93,9 @@ class BFCAllocator : public Allocator {
 
   MemoryDump RecordMemoryMap();
 
+  // Returns the chunks held in the per-thread magazines to the bins.
+  void FlushThreadLocalCaches() TF_LOCKS_EXCLUDED(lock_);
+
  private:
   struct Bin;
 
@@ -98,6 +109,9 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // Marks the in-use chunk 'h' as free, and returns it to the bins.
+  void FreeChunk(ChunkHandle h) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -139,6 +153,9 @@ class BFCAllocator : public Allocator {
   static constexpr int kInvalidBinNum = -1;
   // The following means that the largest bin'd chunk size is 256 << 21 = 512MB.
   static constexpr int kNumBins = 21;
+  // Chunks in the first kNumCachedBins bins, i.e. of less than 64KB, are
+  // cached in the per-thread magazines.
+  static constexpr int kNumCachedBins = 8;
 
   // A Chunk points to a piece of memory that's either entirely free or entirely
   // in use by one user memory allocation.
@@ -517,6 +534,112 @@ class BFCAllocator : public Allocator {
   std::array<BinDebugInfo, kNumBins> get_bin_debug_info()
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Per-thread magazines.
+  //
+  // When thread_local_cache is enabled, a chunk in one of the first
+  // kNumCachedBins bins is not returned to the bins when it is freed.  It is
+  // pushed onto the magazine of the freeing thread instead, and the next
+  // allocation of a similar size by that thread pops it again.  Threads are
+  // assigned round-robin to a fixed set of magazines, one per schedulable
+  // core, each with its own lock, so these locks are rarely contended.
+  //
+  // Chunks in a magazine are still in use as far as the bins and stats_ are
+  // concerned.  They are returned to the bins in batches: half of a magazine
+  // bin when it grows past kMagazineCapacity chunks, the chunks that a
+  // magazine did not need during the last kMagazineTrimInterval operations
+  // (the low watermark of each of its bins), and all of them before an
+  // allocation is allowed to fail.
+  //
+  // The chunk metadata is guarded by lock_, so the size, requested size and
+  // allocation id of every live allocation from the cached bins is recorded
+  // in live_chunks_ instead, which is sharded by address.  This also lets
+  // DeallocateRaw() find out whether a pointer can be cached without taking
+  // lock_.  The TraceMe events and the op name annotations of the chunks only
+  // describe the allocations made from the bins.
+  struct CachedChunk {
+    void* ptr;
+    size_t size;
+  };
+
+  struct Magazine {
+    mutex mu;
+    // The free chunks of each cached bin, the most recently freed one last.
+    std::array<std::vector<CachedChunk>, kNumCachedBins> bins
+        TF_GUARDED_BY(mu);
+    // The smallest size of each bin since the magazine was last trimmed.
+    std::array<size_t, kNumCachedBins> low_watermarks TF_GUARDED_BY(mu) = {};
+    int64 ops_since_trim TF_GUARDED_BY(mu) = 0;
+  };
+
+  struct LiveChunk {
+    size_t size;
+    size_t requested_size;
+    int64 allocation_id;
+  };
+
+  struct LiveChunkShard {
+    mutable mutex mu;
+    absl::flat_hash_map<const void*, LiveChunk> chunks TF_GUARDED_BY(mu);
+  };
+
+  // Stats of the client allocations when the magazines are enabled.  Unlike
+  // stats_, they do not count the chunks held in magazines as in use.
+  struct CacheStats {
+    // The number of allocations served from magazines.
+    std::atomic<int64> num_allocs{0};
+    std::atomic<int64> bytes_in_use{0};
+    std::atomic<int64> peak_bytes_in_use{0};
+    // The largest allocation served from a magazine.
+    std::atomic<int64> largest_alloc_size{0};
+  };
+
+  static constexpr size_t kMagazineCapacity = 64;
+  static constexpr int64 kMagazineTrimInterval = 1 << 14;
+
+  // Returns the magazine of the calling thread.
+  Magazine* ThreadMagazine();
+
+  LiveChunkShard* LiveChunkShardFor(const void* ptr) const {
+    const uintptr_t index =
+        reinterpret_cast<uintptr_t>(ptr) >> kMinAllocationBits;
+    return &live_chunks_[index % live_chunks_.size()];
+  }
+
+  // Records a live allocation of a chunk of 'size' bytes at 'ptr'.
+  void AddLiveChunk(void* ptr, size_t size, size_t requested_size,
+                    int64 allocation_id);
+
+  // Looks up the live allocation at 'ptr', returning false if it was not
+  // recorded in live_chunks_.
+  bool FindLiveChunk(const void* ptr, LiveChunk* live_chunk) const;
+
+  // Serves an allocation of 'num_bytes' bytes from the calling thread's
+  // magazine.  Returns nullptr if the magazine has no suitable chunk.
+  void* AllocateFromMagazine(size_t num_bytes) TF_LOCKS_EXCLUDED(lock_);
+
+  // Pushes the allocation at 'ptr' onto the calling thread's magazine.
+  // Returns false if it must be returned to the bins instead.
+  bool DeallocateToMagazine(void* ptr) TF_LOCKS_EXCLUDED(lock_);
+
+  // Counts an operation on 'magazine', and appends to 'chunks' the chunks
+  // that it should return to the bins.
+  void MaybeTrimMagazine(Magazine* magazine, std::vector<CachedChunk>* chunks)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(magazine->mu);
+
+  // Returns chunks taken from magazines to the bins.
+  void FreeCachedChunks(const std::vector<CachedChunk>& chunks)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void ReturnCachedChunks(const std::vector<CachedChunk>& chunks)
+      TF_LOCKS_EXCLUDED(lock_);
+
+  // Returns the chunks of all magazines to the bins.  Returns false if the
+  // magazines were empty.
+  bool FlushMagazines() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Updates cache_stats_ for client allocations (positive 'bytes') and
+  // deallocations (negative 'bytes') of chunks.
+  void AddClientBytesInUse(int64 bytes);
+
   AllocatorRetry retry_helper_;
 
   // Structures immutable after construction
@@ -574,6 +697,9 @@ class BFCAllocator : public Allocator {
   // memory fragmentation.
   const bool garbage_collection_;
 
+  // Whether small chunks are cached in per-thread magazines.
+  const bool thread_local_cache_;
+
   // Whether the allocator will coalesce adjacent sub allocator provided
   // AllocationRegions. This may be disabled if discrete sub allocator
   // regions can't be treated as contiguous (e.g. if the allocation refers to
@@ -598,13 +724,19 @@ class BFCAllocator : public Allocator {
   ChunkHandle free_chunks_list_ TF_GUARDED_BY(lock_);
 
   // Counter containing the next unique identifier to assign to a
-  // newly-created chunk.
-  int64 next_allocation_id_ TF_GUARDED_BY(lock_);
+  // newly-created chunk.  It is atomic because allocations served from
+  // magazines do not hold lock_.
+  std::atomic<int64> next_allocation_id_;
 
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
   uint64 action_counter_ TF_GUARDED_BY(lock_);
 
+  // The per-thread magazines, which are empty unless thread_local_cache_.
+  std::vector<Magazine> magazines_;
+  mutable std::vector<LiveChunkShard> live_chunks_;
+  CacheStats cache_stats_;
+
   // The circular buffer used to track memory operation history.
   static constexpr uint64 kMemDebugHistorySize = 4096;
   int64 size_history_[kMemDebugHistorySize];
@@ -15,11 +15,15 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 
 #include <algorithm>
+#include <cstring>
 #include <random>
 
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
@@ -84,4 +88,134 @@ BENCHMARK(BM_Allocator)
     ->ArgPair(1000, 256)
     ->ArgPair(10000, 256);
 
+// A SubAllocator backed by host memory.
+class HostSubAllocator : public SubAllocator {
+ public:
+  HostSubAllocator() : SubAllocator({}, {}) {}
+
+  void* Alloc(size_t alignment, size_t num_bytes,
+              size_t* bytes_received) override {
+    *bytes_received = num_bytes;
+    return port::AlignedMalloc(num_bytes, Allocator::kAllocatorAlignment);
+  }
+
+  void Free(void* ptr, size_t num_bytes) override { port::AlignedFree(ptr); }
+
+  bool SupportsCoalescing() const override { return false; }
+};
+
+TEST(BFCAllocatorTest, ThreadLocalCacheReusesChunks) {
+  BFCAllocator a(new HostSubAllocator, 1 << 20, /*allow_growth=*/false,
+                 "bfc", /*garbage_collection=*/false,
+                 /*thread_local_cache=*/true);
+  void* p1 = a.AllocateRaw(1, 1000);
+  const int64 id1 = a.AllocationId(p1);
+  a.DeallocateRaw(p1);
+  EXPECT_EQ(a.GetStats()->bytes_in_use, 0);
+  // The freed chunk is served again from the magazine, with new metadata.
+  void* p2 = a.AllocateRaw(1, 900);
+  EXPECT_EQ(p2, p1);
+  EXPECT_EQ(a.RequestedSize(p2), 900);
+  EXPECT_EQ(a.AllocatedSize(p2), 1024);
+  EXPECT_GT(a.AllocationId(p2), id1);
+  a.DeallocateRaw(p2);
+  // The cached chunk is in the right bin, but too small.
+  void* p3 = a.AllocateRaw(1, 1500);
+  EXPECT_NE(p3, p1);
+  EXPECT_EQ(a.AllocatedSize(p3), 1536);
+
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  EXPECT_EQ(stats->num_allocs, 3);
+  EXPECT_EQ(stats->bytes_in_use, 1536);
+  EXPECT_EQ(stats->peak_bytes_in_use, 1536);
+  EXPECT_EQ(stats->largest_alloc_size, 1536);
+  a.DeallocateRaw(p3);
+  EXPECT_EQ(a.GetStats()->bytes_in_use, 0);
+}
+
+TEST(BFCAllocatorTest, ThreadLocalCacheFlushedBeforeRunningOutOfMemory) {
+  BFCAllocator a(new HostSubAllocator, 1 << 20, /*allow_growth=*/false,
+                 "bfc", /*garbage_collection=*/false,
+                 /*thread_local_cache=*/true);
+  // Fill the whole memory with small chunks, and free them into the
+  // magazine.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, 16 << 10));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+  for (void* ptr : ptrs) {
+    a.DeallocateRaw(ptr);
+  }
+  EXPECT_EQ(a.GetStats()->bytes_in_use, 0);
+  // The chunks must be returned to the bins and coalesced to serve a large
+  // allocation.
+  void* large = a.AllocateRaw(1, 1 << 20);
+  ASSERT_NE(large, nullptr);
+  EXPECT_EQ(a.GetStats()->bytes_in_use, 1 << 20);
+  a.DeallocateRaw(large);
+}
+
+TEST(BFCAllocatorTest, ThreadLocalCacheStatsWithManyThreads) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumIterations = 2000;
+  BFCAllocator a(new HostSubAllocator, 1 << 26, /*allow_growth=*/false,
+                 "bfc", /*garbage_collection=*/false,
+                 /*thread_local_cache=*/true);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&a, t]() {
+        std::mt19937 rng(t);
+        std::vector<void*> live;
+        for (int i = 0; i < kNumIterations; ++i) {
+          if (live.size() < 16 && rng() % 2 == 0) {
+            // Mostly cached sizes, with some larger allocations.
+            const size_t num_bytes = 1 + rng() % (128 << 10);
+            live.push_back(a.AllocateRaw(1, num_bytes));
+            memset(live.back(), 0, num_bytes);
+          } else if (!live.empty()) {
+            a.DeallocateRaw(live.back());
+            live.pop_back();
+          }
+        }
+        for (void* ptr : live) {
+          a.DeallocateRaw(ptr);
+        }
+      });
+    }
+  }
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  EXPECT_EQ(stats->bytes_in_use, 0);
+  EXPECT_GT(stats->peak_bytes_in_use, 0);
+  a.FlushThreadLocalCaches();
+  // All the memory forms a single free chunk again.
+  void* ptr = a.AllocateRaw(1, 1 << 26);
+  EXPECT_NE(ptr, nullptr);
+  a.DeallocateRaw(ptr);
+}
+
+// Allocates and deallocates small buffers of one size from several threads.
+void BM_AllocatorThreads(::testing::benchmark::State& state) {
+  const bool thread_local_cache = state.range(0);
+  // Shared by the threads of all runs of the benchmark.
+  static BFCAllocator* const allocators[] = {
+      new BFCAllocator(new HostSubAllocator, 1 << 26, false, "bfc"),
+      new BFCAllocator(new HostSubAllocator, 1 << 26, false, "bfc_cached",
+                       /*garbage_collection=*/false,
+                       /*thread_local_cache=*/true)};
+  BFCAllocator* allocator = allocators[thread_local_cache];
+  std::vector<void*> ptrs(16);
+  for (auto _ : state) {
+    for (void*& ptr : ptrs) {
+      ptr = allocator->AllocateRaw(1, 4096);
+    }
+    for (void* ptr : ptrs) {
+      allocator->DeallocateRaw(ptr);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * ptrs.size());
+}
+BENCHMARK(BM_AllocatorThreads)->Arg(0)->Arg(1)->ThreadRange(1, 16);
+
 }  // namespace tensorflow
@@ -70,6 +70,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
@@ -135,6 +136,33 @@ Status NewThreadPoolFromThreadPoolOptions(
   return Status::OK();
 }
 
+// Returns one inter-op thread pool per NUMA node, each with its threads pinned
+// to the node, if the session uses NUMA affinity on a host with more than one
+// NUMA node. The inter-op threads are divided evenly between the nodes.
+std::vector<std::unique_ptr<thread::ThreadPool>> NewNUMAThreadPools(
+    const SessionOptions& options) {
+  std::vector<std::unique_ptr<thread::ThreadPool>> pools;
+  const int num_numa_nodes = port::NUMANumNodes();
+  if (!options.config.experimental().use_numa_affinity() ||
+      num_numa_nodes <= 1) {
+    return pools;
+  }
+  const int32 num_threads = std::max<int32>(
+      1, NumInterOpThreadsFromSessionOptions(options) / num_numa_nodes);
+  for (int numa_node = 0; numa_node < num_numa_nodes; ++numa_node) {
+    VLOG(1) << "Direct session inter op parallelism threads for NUMA node "
+            << numa_node << ": " << num_threads;
+    ThreadOptions thread_options;
+    thread_options.numa_node = numa_node;
+    const string name = strings::StrCat("numa_", numa_node, "_Compute");
+    pools.emplace_back(new thread::ThreadPool(
+        options.env, thread_options, name, num_threads,
+        !options.config.experimental().disable_thread_spinning(),
+        /*allocator=*/nullptr));
+  }
+  return pools;
+}
+
 thread::ThreadPool* GlobalThreadPool(const SessionOptions& options) {
   static thread::ThreadPool* const thread_pool =
       NewThreadPoolFromSessionOptions(options);
@@ -339,6 +367,7 @@ DirectSession::DirectSession(const SessionOptions& options,
       run_in_caller_thread_ = true;
     }
   }
+  numa_thread_pools_ = NewNUMAThreadPools(options_);
   // The default value of sync_on_finish will be flipped soon and this
   // environment variable will be removed as well.
   const Status status =
@@ -651,6 +680,10 @@ Status DirectSession::RunInternal(
   args.sync_on_finish = sync_on_finish_;
   args.user_intra_op_threadpool = threadpool_options.intra_op_threadpool;
   args.run_all_kernels_inline = pool == nullptr;
+  args.use_step_arena_allocator =
+      run_options.experimental().use_step_arena_allocator();
+  args.inline_kernels_by_measured_cost =
+      run_options.experimental().inline_kernels_by_measured_cost();
 
   const bool do_trace = (run_options.trace_level() > RunOptions::NO_TRACE);
 
@@ -690,9 +723,17 @@ Status DirectSession::RunInternal(
 
   Status run_status;
 
+  // In NUMA mode, the partitions of the CPU devices that are bound to a NUMA
+  // node run on the inter-op pool of the node, so that their kernels run next
+  // to the memory that the device allocates for them.
+  const bool use_numa_thread_pools =
+      !numa_thread_pools_.empty() && pool != nullptr && handler == nullptr &&
+      threadpool_options.inter_op_threadpool == nullptr &&
+      run_options.inter_op_thread_pool() <= 0;
+
   auto set_threadpool_args_for_item =
-      [&default_runner, &handler](const PerPartitionExecutorsAndLib& item,
-                                  Executor::Args* args) {
+      [this, &default_runner, &handler, use_numa_thread_pools](
+          const PerPartitionExecutorsAndLib& item, Executor::Args* args) {
         // TODO(azaks): support partial run.
         // TODO(azaks): if the device picks its own threadpool, we need to
         // assign
@@ -701,7 +742,15 @@ Status DirectSession::RunInternal(
             item.device->tensorflow_device_thread_pool();
         // TODO(crk): Investigate usage of RunHandlerPool when using device
         // specific thread pool(s).
-        if (!device_thread_pool) {
+        const int numa_node = item.device->attributes().locality().numa_node();
+        if (!device_thread_pool && use_numa_thread_pools &&
+            item.device->device_type() == DEVICE_CPU && numa_node >= 0 &&
+            numa_node < static_cast<int>(numa_thread_pools_.size())) {
+          thread::ThreadPool* numa_pool = numa_thread_pools_[numa_node].get();
+          args->runner = [numa_pool](Executor::Args::Closure c) {
+            numa_pool->Schedule(std::move(c));
+          };
+        } else if (!device_thread_pool) {
           args->runner = default_runner;
         } else {
           args->runner = [device_thread_pool](Executor::Args::Closure c) {
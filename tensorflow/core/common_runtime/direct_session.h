@@ -350,6 +350,11 @@ class DirectSession : public Session {
   // is owned.
   std::vector<std::pair<thread::ThreadPool*, bool>> thread_pools_;
 
+  // If ConfigProto.Experimental.use_numa_affinity is set on a host with more
+  // than one NUMA node, the inter-op thread pool of each node, indexed by
+  // node.
+  std::vector<std::unique_ptr<thread::ThreadPool>> numa_thread_pools_;
+
   Status init_error_;  // Set to an error if construction failed.
 
   // If true, blocks until device has finished all queued operations in a step.
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/function_testlib.h"
+#include "tensorflow/core/common_runtime/process_state.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -44,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/test.h"
@@ -800,6 +802,133 @@ TEST_F(DirectSessionMinusAXTest, UseRunHandlerPool) {
   EXPECT_FLOAT_EQ(5.0, mat(0, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, UseStepArenaAllocator) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<string> output_names = {y_ + ":0"};
+  std::vector<string> target_nodes = {y_neg_};
+
+  RunOptions run_options;
+  run_options.mutable_experimental()->set_use_step_arena_allocator(true);
+
+  // The fetched output escapes the step, and must stay valid after the
+  // step's arena has been released.
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run(run_options, inputs, output_names, target_nodes,
+                              &outputs, nullptr));
+    ASSERT_EQ(1, outputs.size());
+    auto mat = outputs[0].matrix<float>();
+    ASSERT_TRUE(outputs[0].IsInitialized());
+    EXPECT_FLOAT_EQ(5.0, mat(0, 0));
+  }
+}
+
+TEST_F(DirectSessionMinusAXTest, UseNumaAffinity) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options(DefaultSessionOptions());
+  // On hosts with more than one NUMA node, each CPU device is bound to a node
+  // and its partition runs on the node's inter-op thread pool.
+  options.config.mutable_experimental()->set_use_numa_affinity(true);
+  auto session = absl::WrapUnique(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<string> output_names = {y_ + ":0"};
+  std::vector<string> target_nodes = {y_neg_};
+
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run(inputs, output_names, target_nodes, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    auto mat = outputs[0].matrix<float>();
+    ASSERT_TRUE(outputs[0].IsInitialized());
+    EXPECT_FLOAT_EQ(5.0, mat(0, 0));
+  }
+
+  // CPU devices are assigned to the NUMA nodes round-robin and allocate from
+  // their node's allocator.
+  const DeviceMgr* device_mgr;
+  TF_ASSERT_OK(session->LocalDeviceManager(&device_mgr));
+  ProcessState* process_state = ProcessState::singleton();
+  const int num_numa_nodes = port::NUMANumNodes();
+  int num_cpu_devices = 0;
+  for (Device* device : device_mgr->ListDevices()) {
+    if (device->device_type() != DEVICE_CPU) continue;
+    const int numa_node = num_cpu_devices++ % num_numa_nodes;
+    EXPECT_EQ(numa_node, device->attributes().locality().numa_node());
+    EXPECT_EQ(process_state->GetCPUAllocator(numa_node),
+              device->GetAllocator(AllocatorAttributes()));
+  }
+  EXPECT_EQ(2, num_cpu_devices);
+  if (process_state->numa_enabled()) {
+    // Allocations without an affinity are not pinned to node 0.
+    EXPECT_NE(process_state->GetCPUAllocator(0),
+              process_state->GetCPUAllocator(port::kNUMANoAffinity));
+    if (num_numa_nodes > 1) {
+      EXPECT_NE(process_state->GetCPUAllocator(0),
+                process_state->GetCPUAllocator(1));
+    }
+  }
+}
+
+TEST(DirectSessionTest, UseStaticMemoryPlan) {
+  Graph g(OpRegistry::Global());
+  Tensor a_tensor(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&a_tensor, {1, 2, 3, 4});
+  Node* a = test::graph::Constant(&g, a_tensor);
+  Node* b = test::graph::Matmul(&g, a, a, false, false);
+  Node* c = test::graph::Matmul(&g, b, b, false, false);
+  Node* d = test::graph::Unary(&g, "Neg", c);
+  for (Node* n : {a, b, c, d}) {
+    n->set_assigned_device_name("/job:localhost/replica:0/task:0/cpu:0");
+  }
+  GraphDef def;
+  g.ToGraphDef(&def);
+
+  SessionOptions options(DefaultSessionOptions());
+  // Keep constant folding from evaluating the whole graph ahead of time.
+  options.config.mutable_graph_options()
+      ->mutable_optimizer_options()
+      ->set_opt_level(OptimizerOptions::L0);
+  options.config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_constant_folding(RewriterConfig::OFF);
+  options.config.mutable_experimental()->set_use_static_memory_plan(true);
+  auto session = absl::WrapUnique(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+
+  RunOptions run_options;
+  run_options.set_output_partition_graphs(true);
+  // The fetched output escapes the step, and must stay valid after the step's
+  // buffer has been released.
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> outputs;
+    RunMetadata run_metadata;
+    TF_ASSERT_OK(session->Run(run_options, {}, {d->name() + ":0"}, {},
+                              &outputs, &run_metadata));
+    ASSERT_EQ(1, outputs.size());
+    test::ExpectTensorEqual<float>(
+        outputs[0],
+        test::AsTensor<float>({-199, -290, -435, -634}, TensorShape({2, 2})));
+
+    ASSERT_EQ(1, run_metadata.partition_graphs_size());
+    bool found_planned_matmul = false;
+    for (const NodeDef& node : run_metadata.partition_graphs(0).node()) {
+      if (node.name() == b->name()) {
+        // The output is a 2x2 float matrix.
+        EXPECT_EQ(node.attr().at("_planned_output_bytes").list().i(0), 16);
+        found_planned_matmul = true;
+      }
+    }
+    EXPECT_TRUE(found_planned_matmul);
+  }
+}
+
 TEST(DirectSessionTest, KeepsStateAcrossRunsOfSession) {
   GraphDef def;
   Graph g(OpRegistry::Global());
@@ -29,6 +29,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -163,7 +165,10 @@ class ExecutorImpl : public Executor {
         if (gview.node(i)) {
           is_expensive_[i] =
               gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
-          cost_estimates_[i] = kInitialCostEstimateCycles;
+          // The estimates of kernels that are not marked as expensive are only
+          // used by IsExpensiveByMeasuredCost(), and start out inexpensive.
+          cost_estimates_[i] =
+              is_expensive_[i] ? kInitialCostEstimateCycles : 0;
         }
       }
     }
@@ -177,6 +182,15 @@ class ExecutorImpl : public Executor {
               kOpIsExpensiveThresholdCycles);
     }
 
+    // Returns true iff the cost estimate of the given node exceeds the
+    // threshold for inlining, regardless of kernel->IsExpensive(). Used when
+    // kernels are inlined by their measured cost (see
+    // Executor::Args::inline_kernels_by_measured_cost).
+    bool IsExpensiveByMeasuredCost(const NodeItem& node) const {
+      return cost_estimates_[node.node_id].load(std::memory_order_relaxed) >
+             kOpIsExpensiveThresholdCycles;
+    }
+
     // Returns the value of kernel->IsExpensive().
     bool HasExpensiveMarker(const NodeItem& node) const {
       return is_expensive_[node.node_id];
@@ -185,8 +199,11 @@ class ExecutorImpl : public Executor {
     // Updates the dynamic cost estimate, which is used to determine whether the
     // given node is expensive. The new cost estimate is a weighted average of
     // the old cost estimate and the latest cost. We only update cost estimates
-    // for kernels for which IsExpensive() return true.
-    void UpdateCostEstimate(const NodeItem& node, uint64 elapsed_cycles) {
+    // for kernels for which IsExpensive() return true, unless kernels are
+    // inlined by their measured cost. If `replace_initial_estimate` is true,
+    // the first measurement replaces the initial estimate instead.
+    void UpdateCostEstimate(const NodeItem& node, uint64 elapsed_cycles,
+                            bool replace_initial_estimate = false) {
       // N.B. Updates to `cost_estimate` are atomic but unlocked.  Simultaneous
       // updates may result in one or more updates being ignored.  This does not
       // affect correctness but may slow down the update frequency.
@@ -195,6 +212,10 @@ class ExecutorImpl : public Executor {
 
       uint64 new_estimate =
           ((kCostDecay - 1) * prev_estimate + elapsed_cycles) / kCostDecay;
+      if (replace_initial_estimate &&
+          prev_estimate == kInitialCostEstimateCycles) {
+        new_estimate = elapsed_cycles;
+      }
 
       cost_estimate.store(new_estimate, std::memory_order_relaxed);
     }
@@ -324,6 +345,13 @@ class ExecutorState {
   // REQUIRES: `!ready->empty()`.
   void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
 
+  // Returns true if `item` should not be run inline on the scheduling thread.
+  bool IsExpensive(const NodeItem& item) const {
+    return inline_kernels_by_measured_cost_
+               ? kernel_stats_->IsExpensiveByMeasuredCost(item)
+               : kernel_stats_->IsExpensive(item);
+  }
+
   // A wrapper for runner_ to keep track of the pending queue length. Op
   // execution should dispatch work using this function instead of using runner_
   // directly.
@@ -366,9 +394,16 @@ class ExecutorState {
   CancellationManager* cancellation_manager_;
   // If not null, use this device to schedule intra-op operation
   std::unique_ptr<DeviceBase> user_device_;
+  // If not null, the arena for tensors of this step. Released (rather than
+  // deleted) at the end of the step, since tensors may escape the step.
+  StepArenaAllocator* step_arena_allocator_ = nullptr;
+  // If not null, serves the statically planned outputs of this step. Released
+  // at the end of the step, like `step_arena_allocator_`.
+  StaticPlanStepAllocator* static_plan_allocator_ = nullptr;
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
+  const bool inline_kernels_by_measured_cost_;
 
   PropagatorStateType propagator_;
 
@@ -413,6 +448,7 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       runner_(args.runner),
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
+      inline_kernels_by_measured_cost_(args.inline_kernels_by_measured_cost),
       propagator_(immutable_state, step_id_, vlog_),
       num_outstanding_ops_(0) {
   if (args.user_intra_op_threadpool != nullptr) {
@@ -420,6 +456,22 @@ ExecutorState<PropagatorStateType>::ExecutorState(
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (args.use_step_arena_allocator) {
+    Device* device = immutable_state_.params().device;
+    if (device->device_type() == DEVICE_CPU) {
+      step_arena_allocator_ =
+          new StepArenaAllocator(device->GetAllocator(AllocatorAttributes()));
+    }
+  }
+  if (immutable_state_.static_memory_plan() != nullptr) {
+    Allocator* base = step_arena_allocator_;
+    if (base == nullptr) {
+      base = immutable_state_.params().device->GetAllocator(
+          AllocatorAttributes());
+    }
+    static_plan_allocator_ = new StaticPlanStepAllocator(
+        immutable_state_.static_memory_plan(), base);
+  }
 }
 
 template <class PropagatorStateType>
@@ -428,6 +480,12 @@ ExecutorState<PropagatorStateType>::~ExecutorState() {
     device_context_->Unref();
   }
   delete slice_reader_cache_;
+  if (static_plan_allocator_) {
+    static_plan_allocator_->Release();
+  }
+  if (step_arena_allocator_) {
+    step_arena_allocator_->Release();
+  }
 }
 
 template <class PropagatorStateType>
@@ -555,7 +613,7 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
 
   OpKernel* op_kernel = item.kernel;
   Device* device = immutable_state_.params().device;
-  const bool is_expensive = kernel_stats_->IsExpensive(item);
+  const bool is_expensive = IsExpensive(item);
 
   if (TF_PREDICT_FALSE(MightTrace(event_collector_, is_expensive))) {
     tracing::ScopedRegion region(tracing::EventCategory::kCompute,
@@ -567,7 +625,8 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
         },
         profiler::GetTFTraceMeLevel(is_expensive));
     device->Compute(op_kernel, &ctx);
-  } else if (kernel_stats_->HasExpensiveMarker(item)) {
+  } else if (kernel_stats_->HasExpensiveMarker(item) ||
+             inline_kernels_by_measured_cost_) {
     KernelTimer timer;
     device->Compute(op_kernel, &ctx);
     // For expensive kernels, always update the cost estimate. For inexpensive
@@ -576,7 +635,8 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
     constexpr int kKernelExecutionTrackingInvocationSkipCount = 16;
     if (is_expensive ||
         timer.start_cycles % kKernelExecutionTrackingInvocationSkipCount == 0) {
-      kernel_stats_->UpdateCostEstimate(item, timer.ElapsedCycles());
+      kernel_stats_->UpdateCostEstimate(item, timer.ElapsedCycles(),
+                                        inline_kernels_by_measured_cost_);
     }
   } else {
     device->Compute(op_kernel, &ctx);
@@ -707,6 +767,7 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
   params.resource_manager = device->resource_manager();
   params.step_container = step_container_;
   params.slice_reader_cache = slice_reader_cache_;
+  params.step_allocator = step_arena_allocator_;
   params.inputs = &inputs;
   params.input_alloc_attrs = &input_alloc_attrs;
   params.runner = &runner_;
@@ -798,6 +859,11 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
 
       // Set up compute params.
       params.op_kernel = item.kernel;
+      if (static_plan_allocator_) {
+        Allocator* node_allocator = static_plan_allocator_->NodeAllocator(id);
+        params.step_allocator =
+            node_allocator ? node_allocator : step_arena_allocator_;
+      }
       params.frame_iter = propagator_.GetFrameAndIter(tagged_node);
       params.is_input_dead = is_input_dead;
       params.output_attr_array = item.output_attrs();
@@ -1165,7 +1231,29 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     }
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
-    if (inline_ready == nullptr) {
+    if (inline_ready == nullptr && inline_kernels_by_measured_cost_) {
+      // Schedule the expensive ops to run in the thread pool, and run all the
+      // inexpensive ones (and the nodes that become ready after them) from a
+      // single closure, since dispatching each of them would cost more than
+      // running it.
+      TaggedNodeSeq inexpensive_nodes;
+      for (auto& tagged_node : *ready) {
+        const NodeItem& item = *tagged_node.node_item;
+        if (tagged_node.get_is_dead() || !IsExpensive(item)) {
+          inexpensive_nodes.push_back(tagged_node);
+        } else {
+          RunTask([=]() { Process(tagged_node, scheduled_nsec); });
+        }
+      }
+      if (!inexpensive_nodes.empty()) {
+        RunTask([this, inexpensive_nodes = std::move(inexpensive_nodes),
+                 scheduled_nsec]() {
+          for (auto& tagged_node : inexpensive_nodes) {
+            Process(tagged_node, scheduled_nsec);
+          }
+        });
+      }
+    } else if (inline_ready == nullptr) {
       // Schedule to run all the ready ops in thread pool.
       for (auto& tagged_node : *ready) {
         RunTask([=]() { Process(tagged_node, scheduled_nsec); });
@@ -1173,7 +1261,7 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     } else {
       for (auto& tagged_node : *ready) {
         const NodeItem& item = *tagged_node.node_item;
-        if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
+        if (tagged_node.get_is_dead() || !IsExpensive(item)) {
           // Inline this inexpensive node.
           inline_ready->push_back(tagged_node);
         } else {
@@ -116,6 +116,17 @@ class Executor {
     // If true, all kernels will be treated as "inexpensive", and hence executed
     // on the scheduling thread.
     bool run_all_kernels_inline = false;
+
+    // If true, kernels are considered "inexpensive", and hence executed on
+    // the scheduling thread, based on their measured execution time rather
+    // than on OpKernel::IsExpensive(). Chains of inexpensive kernels run on a
+    // single thread, and work is dispatched to the runner on fan-out only.
+    bool inline_kernels_by_measured_cost = false;
+
+    // If true and the executor runs on a CPU device, tensors allocated with
+    // default attributes are carved from a per-step arena, which is freed in
+    // bulk when the step ends.
+    bool use_step_arena_allocator = false;
   };
   typedef std::function<void(const Status&)> DoneCallback;
   virtual void RunAsync(const Args& args, DoneCallback done) = 0;
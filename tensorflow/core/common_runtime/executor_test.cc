@@ -91,6 +91,7 @@ class ExecutorTest : public ::testing::Test {
     args.rendezvous = rendez;
     args.stats_collector = &step_stats_collector_;
     args.runner = runner_;
+    args.inline_kernels_by_measured_cost = inline_kernels_by_measured_cost_;
     return exec_->Run(args);
   }
 
@@ -101,6 +102,7 @@ class ExecutorTest : public ::testing::Test {
   StepStats step_stats_;
   Executor::Args::Runner runner_;
   Rendezvous* rendez_ = nullptr;
+  bool inline_kernels_by_measured_cost_ = false;
 };
 
 // A float val -> Tensor<float>
@@ -175,6 +177,33 @@ TEST_F(ExecutorTest, SimpleAdd) {
   EXPECT_EQ(2.0, V(out));  // out = 1.0 + 1.0 = 2.0
 }
 
+TEST_F(ExecutorTest, InlineKernelsByMeasuredCost) {
+  // b = AddN(-(-(...(-a))), ...), with 8 chains of 10 negations.
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  auto a = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  std::vector<Node*> chains;
+  for (int i = 0; i < 8; ++i) {
+    Node* v = a;
+    for (int j = 0; j < 10; ++j) {
+      v = test::graph::Unary(g.get(), "Neg", v);
+    }
+    chains.push_back(v);
+  }
+  auto sum = test::graph::Multi(g.get(), "AddN", chains);
+  test::graph::Send(g.get(), sum, "b", BOB, 1, ALICE);
+  Create(std::move(g));
+  inline_kernels_by_measured_cost_ = true;
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(8.0, V(out));
+}
+
 TEST_F(ExecutorTest, SelfAdd) {
   // v0 <- a
   // v1 = v0 + v0
@@ -511,6 +540,72 @@ BENCHMARK(BM_const_identity)
     ->ArgPair(100, 1)
     ->ArgPair(100, 100);
 
+// Create a graph with 'width' chains of 'depth' scalar negations, which fan out
+// from a single constant, and run it with kernels inlined either by their
+// static IsExpensive() hint (if 'measured_cost' is 0) or by their measured
+// cost. Reports the time per op.
+static void BM_CheapKernelChains(::testing::benchmark::State& state) {
+  const bool measured_cost = state.range(0);
+  const int width = state.range(1);
+  const int depth = state.range(2);
+
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  Node* input = test::graph::Constant(g.get(), V(1.0));
+  for (int i = 0; i < width; ++i) {
+    Node* v = input;
+    for (int j = 0; j < depth; ++j) {
+      v = test::graph::Unary(g.get(), "Neg", v);
+    }
+  }
+  FixupSourceAndSinkEdges(g.get());
+
+  std::unique_ptr<Device> device(
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+  const int version = g->versions().producer();
+  LocalExecutorParams params;
+  params.device = device.get();
+  params.create_kernel =
+      [&device, version](const std::shared_ptr<const NodeProperties>& props,
+                         OpKernel** kernel) {
+        return CreateNonCachedKernel(device.get(), nullptr, props, version,
+                                     kernel);
+      };
+  params.delete_kernel = [](OpKernel* kernel) {
+    DeleteNonCachedKernel(kernel);
+  };
+  Executor* exec = nullptr;
+  TF_CHECK_OK(NewLocalExecutor(params, *g, &exec));
+  std::unique_ptr<Executor> exec_holder(exec);
+
+  SessionOptions options;
+  thread::ThreadPool* pool = ComputePool(options);
+  Executor::Args args;
+  args.runner = [pool](std::function<void()> closure) {
+    pool->Schedule(std::move(closure));
+  };
+  args.inline_kernels_by_measured_cost = measured_cost;
+  // Let the cost estimates of the kernels settle.
+  for (int i = 0; i < 100; ++i) {
+    TF_CHECK_OK(exec->Run(args));
+  }
+
+  for (auto s : state) {
+    TF_CHECK_OK(exec->Run(args));
+  }
+  state.SetLabel(measured_cost ? "measured cost" : "static cost");
+  state.SetItemsProcessed(static_cast<int64>(width) * depth *
+                          state.iterations());
+}
+
+BENCHMARK(BM_CheapKernelChains)
+    ->UseRealTime()
+    ->Args({0, 1, 256})
+    ->Args({1, 1, 256})
+    ->Args({0, 16, 16})
+    ->Args({1, 16, 16})
+    ->Args({0, 256, 1})
+    ->Args({1, 256, 1});
+
 static void BM_FeedInputFetchOutput(::testing::benchmark::State& state) {
   Graph* g = new Graph(OpRegistry::Global());
   // z = x + y: x and y are provided as benchmark inputs.  z is the
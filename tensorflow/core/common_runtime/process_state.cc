@@ -61,79 +61,118 @@ ProcessState::MemDesc ProcessState::PtrType(const void* ptr) {
   return MemDesc();
 }
 
+bool ProcessState::EnableNUMA() {
+  mutex_lock lock(mu_);
+  if (numa_enabled_.load(std::memory_order_relaxed)) return true;
+  if (!cpu_allocators_.empty()) {
+    // Devices and tensors already hold the node 0 allocator, which is not
+    // pinned to any node. Replacing it now would leave them with an
+    // allocator that no longer matches GetCPUAllocator(0).
+    LOG(WARNING) << "Not enabling NUMA allocators because a CPU allocator "
+                 << "has already been created. Enable NUMA affinity in the "
+                 << "first session that is created in this process.";
+    return false;
+  }
+  numa_enabled_.store(true, std::memory_order_release);
+  return true;
+}
+
 Allocator* ProcessState::GetCPUAllocator(int numa_node) {
-  if (!numa_enabled_ || numa_node == port::kNUMANoAffinity) numa_node = 0;
+  const bool numa_enabled = numa_enabled_.load(std::memory_order_acquire);
+  if (!numa_enabled) numa_node = 0;
 
   // Check if allocator for the numa node is in lock-free cache.
-  if (numa_node < cpu_allocators_cached_.load(std::memory_order_acquire)) {
+  if (numa_node != port::kNUMANoAffinity &&
+      numa_node < cpu_allocators_cached_.load(std::memory_order_acquire)) {
     return cpu_allocators_cache_[numa_node];
   }
 
   mutex_lock lock(mu_);
-  while (cpu_allocators_.size() <= static_cast<size_t>(numa_node)) {
-    // If visitors have been defined we need an Allocator built from
-    // a SubAllocator.  Prefer BFCAllocator, but fall back to PoolAllocator
-    // depending on env var setting.
-    const bool alloc_visitors_defined =
-        (!cpu_alloc_visitors_.empty() || !cpu_free_visitors_.empty());
-    bool use_bfc_allocator = false;
-    Status status = ReadBoolFromEnvVar(
-        "TF_CPU_ALLOCATOR_USE_BFC", alloc_visitors_defined, &use_bfc_allocator);
-    if (!status.ok()) {
-      LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
-    }
-    Allocator* allocator = nullptr;
-    SubAllocator* sub_allocator =
-        (numa_enabled_ || alloc_visitors_defined || use_bfc_allocator)
-            ? new BasicCPUAllocator(
-                  numa_enabled_ ? numa_node : port::kNUMANoAffinity,
-                  cpu_alloc_visitors_, cpu_free_visitors_)
-            : nullptr;
-    if (use_bfc_allocator) {
-      // TODO(reedwm): evaluate whether 64GB by default is the best choice.
-      int64 cpu_mem_limit_in_mb = -1;
-      Status status = ReadInt64FromEnvVar("TF_CPU_BFC_MEM_LIMIT_IN_MB",
-                                          1LL << 16 /*64GB max by default*/,
-                                          &cpu_mem_limit_in_mb);
-      if (!status.ok()) {
-        LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
-      }
-      int64 cpu_mem_limit = cpu_mem_limit_in_mb * (1LL << 20);
-      DCHECK(sub_allocator);
-      allocator =
-          new BFCAllocator(sub_allocator, cpu_mem_limit, /*allow_growth=*/true,
-                           /*name=*/"bfc_cpu_allocator_for_gpu");
-      VLOG(2) << "Using BFCAllocator with memory limit of "
-              << cpu_mem_limit_in_mb << " MB for ProcessState CPU allocator";
-    } else if (sub_allocator) {
-      DCHECK(sub_allocator);
-      allocator =
-          new PoolAllocator(/*pool_size_limit=*/100, /*auto_resize=*/true,
-                            sub_allocator, new NoopRounder, "cpu_pool");
-      VLOG(2) << "Using PoolAllocator for ProcessState CPU allocator "
-              << "numa_enabled_=" << numa_enabled_
-              << " numa_node=" << numa_node;
-    } else {
-      DCHECK(!sub_allocator);
-      allocator = cpu_allocator_base();
-    }
-    if (LogMemory::IsEnabled() && !allocator->TracksAllocationSizes()) {
-      // Wrap the allocator to track allocation ids for better logging
-      // at the cost of performance.
-      allocator = new TrackingAllocator(allocator, true);
+  if (numa_node == port::kNUMANoAffinity) {
+    // The node 0 allocator is pinned to node 0, so callers without an
+    // affinity get an allocator of their own.
+    if (cpu_no_affinity_allocator_ == nullptr) {
+      cpu_no_affinity_allocator_ = NewCPUAllocator(port::kNUMANoAffinity);
     }
+    return cpu_no_affinity_allocator_;
+  }
+  while (cpu_allocators_.size() <= static_cast<size_t>(numa_node)) {
+    Allocator* allocator = NewCPUAllocator(
+        numa_enabled ? static_cast<int>(cpu_allocators_.size())
+                     : port::kNUMANoAffinity);
     cpu_allocators_.push_back(allocator);
     if (cpu_allocators_.size() < cpu_allocators_cache_.max_size()) {
       cpu_allocators_cache_[cpu_allocators_.size() - 1] = allocator;
       cpu_allocators_cached_.fetch_add(1, std::memory_order_release);
     }
-    if (!sub_allocator) {
-      DCHECK(cpu_alloc_visitors_.empty() && cpu_free_visitors_.empty());
-    }
   }
   return cpu_allocators_[numa_node];
 }
 
+Allocator* ProcessState::NewCPUAllocator(int numa_node) {
+  // If visitors have been defined we need an Allocator built from
+  // a SubAllocator.  Prefer BFCAllocator, but fall back to PoolAllocator
+  // depending on env var setting.
+  const bool alloc_visitors_defined =
+      (!cpu_alloc_visitors_.empty() || !cpu_free_visitors_.empty());
+  bool use_bfc_allocator = false;
+  Status status = ReadBoolFromEnvVar(
+      "TF_CPU_ALLOCATOR_USE_BFC", alloc_visitors_defined, &use_bfc_allocator);
+  if (!status.ok()) {
+    LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
+  }
+  Allocator* allocator = nullptr;
+  SubAllocator* sub_allocator =
+      (numa_node != port::kNUMANoAffinity || alloc_visitors_defined ||
+       use_bfc_allocator)
+          ? new BasicCPUAllocator(numa_node, cpu_alloc_visitors_,
+                                  cpu_free_visitors_)
+          : nullptr;
+  if (use_bfc_allocator) {
+    // TODO(reedwm): evaluate whether 64GB by default is the best choice.
+    int64 cpu_mem_limit_in_mb = -1;
+    Status status = ReadInt64FromEnvVar("TF_CPU_BFC_MEM_LIMIT_IN_MB",
+                                        1LL << 16 /*64GB max by default*/,
+                                        &cpu_mem_limit_in_mb);
+    if (!status.ok()) {
+      LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
+    }
+    int64 cpu_mem_limit = cpu_mem_limit_in_mb * (1LL << 20);
+    bool thread_local_cache = false;
+    status = ReadBoolFromEnvVar("TF_CPU_BFC_THREAD_LOCAL_CACHE", false,
+                                &thread_local_cache);
+    if (!status.ok()) {
+      LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
+    }
+    DCHECK(sub_allocator);
+    allocator =
+        new BFCAllocator(sub_allocator, cpu_mem_limit, /*allow_growth=*/true,
+                         /*name=*/"bfc_cpu_allocator_for_gpu",
+                         /*garbage_collection=*/false, thread_local_cache);
+    VLOG(2) << "Using BFCAllocator with memory limit of "
+            << cpu_mem_limit_in_mb << " MB for ProcessState CPU allocator";
+  } else if (sub_allocator) {
+    DCHECK(sub_allocator);
+    allocator =
+        new PoolAllocator(/*pool_size_limit=*/100, /*auto_resize=*/true,
+                          sub_allocator, new NoopRounder, "cpu_pool");
+    VLOG(2) << "Using PoolAllocator for ProcessState CPU allocator "
+            << "numa_node=" << numa_node;
+  } else {
+    DCHECK(!sub_allocator);
+    allocator = cpu_allocator_base();
+  }
+  if (LogMemory::IsEnabled() && !allocator->TracksAllocationSizes()) {
+    // Wrap the allocator to track allocation ids for better logging
+    // at the cost of performance.
+    allocator = new TrackingAllocator(allocator, true);
+  }
+  if (!sub_allocator) {
+    DCHECK(cpu_alloc_visitors_.empty() && cpu_free_visitors_.empty());
+  }
+  return allocator;
+}
+
 void ProcessState::AddCPUAllocVisitor(SubAllocator::Visitor visitor) {
   VLOG(1) << "AddCPUAllocVisitor";
   mutex_lock lock(mu_);
@@ -160,6 +199,10 @@ void ProcessState::TestOnlyReset() {
     if (a != default_cpu_allocator) delete a;
   }
   cpu_allocators_.clear();
+  if (cpu_no_affinity_allocator_ != default_cpu_allocator) {
+    delete cpu_no_affinity_allocator_;
+  }
+  cpu_no_affinity_allocator_ = nullptr;
   for (Allocator* a : cpu_al_) {
     delete a;
   }
@@ -56,15 +56,25 @@ class ProcessState : public ProcessStateInterface {
   };
 
   // If NUMA Allocators are desired, call this before calling any
-  // Allocator accessor.
-  void EnableNUMA() { numa_enabled_ = true; }
+  // Allocator accessor. Returns true if NUMA allocators are in use; if a CPU
+  // allocator has already been created, logs a warning and leaves NUMA
+  // allocators disabled.
+  bool EnableNUMA();
+
+  // Returns true if GetCPUAllocator() returns allocators pinned to the
+  // requested NUMA node.
+  bool numa_enabled() const {
+    return numa_enabled_.load(std::memory_order_acquire);
+  }
 
   // Returns what we know about the memory at ptr.
   // If we know nothing, it's called CPU 0 with no other attributes.
   MemDesc PtrType(const void* ptr);
 
   // Returns the one CPUAllocator used for the given numa_node.
-  // Treats numa_node == kNUMANoAffinity as numa_node == 0.
+  // If NUMA allocators are disabled, treats every numa_node as 0. Otherwise
+  // numa_node == kNUMANoAffinity gets its own allocator, not pinned to any
+  // node.
   Allocator* GetCPUAllocator(int numa_node) override;
 
   // Registers alloc visitor for the CPU allocator(s).
@@ -91,14 +101,20 @@ class ProcessState : public ProcessStateInterface {
   // cleaning up everything. Never use in production.
   void TestOnlyReset();
 
+  // Creates a CPU allocator whose memory is placed on `numa_node`, or
+  // anywhere if `numa_node` is kNUMANoAffinity.
+  Allocator* NewCPUAllocator(int numa_node) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   static ProcessState* instance_;
-  bool numa_enabled_;
+  std::atomic<bool> numa_enabled_;
 
   mutex mu_;
 
   // Indexed by numa_node.  If we want numa-specific allocators AND a
   // non-specific allocator, maybe should index by numa_node+1.
   std::vector<Allocator*> cpu_allocators_ TF_GUARDED_BY(mu_);
+  // Used for numa_node == kNUMANoAffinity once NUMA allocators are enabled.
+  Allocator* cpu_no_affinity_allocator_ TF_GUARDED_BY(mu_) = nullptr;
   std::vector<SubAllocator::Visitor> cpu_alloc_visitors_ TF_GUARDED_BY(mu_);
   std::vector<SubAllocator::Visitor> cpu_free_visitors_ TF_GUARDED_BY(mu_);
 
@@ -0,0 +1,314 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+const char* const kPlannedOutputBytesAttr = "_planned_output_bytes";
+
+namespace {
+
+// The ancestors of every node are computed as a bitset, so larger graphs are
+// not planned.
+constexpr int kMaxPlannedGraphNodes = 8192;
+
+constexpr size_t kSlotAlignment = Allocator::kAllocatorAlignment;
+
+size_t RoundUp(size_t n, size_t alignment) {
+  return (n + alignment - 1) / alignment * alignment;
+}
+
+struct PlannedOutput {
+  int node_id;
+  size_t bytes;
+  // The positions in the topological order of the producer of the output,
+  // and of the producer and the consumers.
+  int producer;
+  std::vector<int> users;
+  size_t offset;
+};
+
+}  // namespace
+
+std::unique_ptr<StaticMemoryPlan> StaticMemoryPlan::Create(
+    const Graph& graph) {
+  std::vector<PlannedOutput> outputs;
+  for (const Node* n : graph.op_nodes()) {
+    std::vector<int64> output_bytes;
+    if (!TryGetNodeAttr(n->attrs(), kPlannedOutputBytesAttr, &output_bytes)) {
+      continue;
+    }
+    for (int i = 0; i < output_bytes.size() && i < n->num_outputs(); ++i) {
+      if (output_bytes[i] > 0) {
+        PlannedOutput output;
+        output.node_id = n->id();
+        output.bytes = output_bytes[i];
+        for (const Edge* e : n->out_edges()) {
+          if (e->src_output() == i) {
+            output.users.push_back(e->dst()->id());
+          }
+        }
+        outputs.push_back(std::move(output));
+      }
+    }
+  }
+  if (outputs.empty()) {
+    return nullptr;
+  }
+  if (graph.num_nodes() > kMaxPlannedGraphNodes) {
+    VLOG(1) << "Not planning the memory of a graph with " << graph.num_nodes()
+            << " nodes";
+    return nullptr;
+  }
+
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+  std::vector<int> position(graph.num_node_ids(), -1);
+  for (int i = 0; i < order.size(); ++i) {
+    if (order[i]->IsNextIteration()) {
+      // The tensors in a loop are produced many times per step, and their
+      // liveness does not follow the order of the graph.
+      VLOG(1) << "Not planning the memory of a graph with loops";
+      return nullptr;
+    }
+    position[order[i]->id()] = i;
+  }
+  // Bit j of ancestors[i] is set if order[j] is an ancestor of order[i].
+  const int num_words = (order.size() + 63) / 64;
+  std::vector<uint64> ancestors(order.size() * num_words, 0);
+  for (int i = 0; i < order.size(); ++i) {
+    uint64* dst = &ancestors[i * num_words];
+    for (const Edge* e : order[i]->in_edges()) {
+      const int j = position[e->src()->id()];
+      const uint64* src = &ancestors[j * num_words];
+      for (int w = 0; w < num_words; ++w) {
+        dst[w] |= src[w];
+      }
+      dst[j / 64] |= uint64{1} << (j % 64);
+    }
+  }
+  auto is_ancestor = [&ancestors, num_words](int a, int b) {
+    return (ancestors[b * num_words + a / 64] >> (a % 64)) & 1;
+  };
+
+  for (PlannedOutput& output : outputs) {
+    output.producer = position[output.node_id];
+    for (int& user : output.users) {
+      user = position[user];
+    }
+    output.users.push_back(output.producer);
+  }
+  // Returns true if every user of 'a' completes before 'b' is produced.
+  auto dead_before = [&outputs, &is_ancestor](int a, int b) {
+    const int producer = outputs[b].producer;
+    for (int user : outputs[a].users) {
+      if (!is_ancestor(user, producer)) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  // Place the outputs from the largest to the smallest, each at the lowest
+  // offset where it does not overlap an already placed output that may be
+  // live at the same time.
+  std::vector<int> by_size(outputs.size());
+  std::iota(by_size.begin(), by_size.end(), 0);
+  std::stable_sort(by_size.begin(), by_size.end(), [&outputs](int a, int b) {
+    return outputs[a].bytes > outputs[b].bytes;
+  });
+  std::vector<int> placed;
+  size_t buffer_size = 0;
+  size_t total_bytes = 0;
+  for (int t : by_size) {
+    std::vector<int> conflicts;
+    for (int u : placed) {
+      if (!dead_before(t, u) && !dead_before(u, t)) {
+        conflicts.push_back(u);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end(), [&outputs](int a, int b) {
+      return outputs[a].offset < outputs[b].offset;
+    });
+    size_t offset = 0;
+    for (int u : conflicts) {
+      if (offset + outputs[t].bytes <= outputs[u].offset) {
+        break;
+      }
+      const size_t end = outputs[u].offset + outputs[u].bytes;
+      offset = std::max(offset, RoundUp(end, kSlotAlignment));
+    }
+    outputs[t].offset = offset;
+    placed.push_back(t);
+    buffer_size = std::max(buffer_size, offset + outputs[t].bytes);
+    total_bytes += RoundUp(outputs[t].bytes, kSlotAlignment);
+  }
+
+  std::unique_ptr<StaticMemoryPlan> plan(new StaticMemoryPlan);
+  plan->buffer_size_ = buffer_size;
+  plan->planned_node_indices_.assign(graph.num_node_ids(), -1);
+  plan->slots_.resize(outputs.size());
+  for (int s = 0; s < outputs.size(); ++s) {
+    plan->slots_[s].offset = outputs[s].offset;
+    plan->slots_[s].bytes = outputs[s].bytes;
+    int& index = plan->planned_node_indices_[outputs[s].node_id];
+    if (index < 0) {
+      index = plan->planned_node_slots_.size();
+      plan->planned_node_slots_.emplace_back();
+    }
+    plan->planned_node_slots_[index].push_back(s);
+  }
+  for (int s = 0; s < outputs.size(); ++s) {
+    for (int r = s + 1; r < outputs.size(); ++r) {
+      if (outputs[s].offset < outputs[r].offset + outputs[r].bytes &&
+          outputs[r].offset < outputs[s].offset + outputs[s].bytes) {
+        plan->slots_[s].overlapping.push_back(r);
+        plan->slots_[r].overlapping.push_back(s);
+      }
+    }
+  }
+  VLOG(1) << "Planned " << outputs.size() << " outputs of "
+          << plan->num_planned_nodes() << " nodes in a buffer of "
+          << buffer_size << " bytes, instead of " << total_bytes;
+  return plan;
+}
+
+class StaticPlanStepAllocator::NodeAllocatorImpl : public Allocator {
+ public:
+  void Init(StaticPlanStepAllocator* parent, const std::vector<int>* slots) {
+    parent_ = parent;
+    slots_ = slots;
+  }
+
+  std::string Name() override { return "static_plan"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return parent_->Allocate(*slots_, alignment, num_bytes);
+  }
+
+  void DeallocateRaw(void* ptr) override { parent_->Deallocate(*slots_, ptr); }
+
+ private:
+  StaticPlanStepAllocator* parent_ = nullptr;
+  // The slots of the outputs of the node.
+  const std::vector<int>* slots_ = nullptr;
+};
+
+StaticPlanStepAllocator::StaticPlanStepAllocator(const StaticMemoryPlan* plan,
+                                                 Allocator* base)
+    : plan_(plan),
+      base_(base),
+      buffer_(static_cast<char*>(base->AllocateRaw(
+          Allocator::kAllocatorAlignment, plan->buffer_size()))),
+      node_allocators_(new NodeAllocatorImpl[plan->num_planned_nodes()]),
+      live_(plan->slots().size(), false) {
+  for (int i = 0; i < plan->num_planned_nodes(); ++i) {
+    node_allocators_[i].Init(this, &plan->planned_node_slots(i));
+  }
+}
+
+StaticPlanStepAllocator::~StaticPlanStepAllocator() {
+  if (buffer_ != nullptr) {
+    base_->DeallocateRaw(buffer_);
+  }
+}
+
+Allocator* StaticPlanStepAllocator::NodeAllocator(int node_id) {
+  const int index = plan_->planned_node_index(node_id);
+  return index >= 0 ? &node_allocators_[index] : nullptr;
+}
+
+void* StaticPlanStepAllocator::Allocate(const std::vector<int>& slots,
+                                        size_t alignment, size_t num_bytes) {
+  {
+    mutex_lock l(mu_);
+    if (!released_ && buffer_ != nullptr &&
+        alignment <= Allocator::kAllocatorAlignment) {
+      for (int s : slots) {
+        const StaticMemoryPlan::Slot& slot = plan_->slots()[s];
+        if (slot.bytes != num_bytes || live_[s]) {
+          continue;
+        }
+        bool overlaps_live_slot = false;
+        for (int o : slot.overlapping) {
+          overlaps_live_slot |= live_[o];
+        }
+        if (overlaps_live_slot) {
+          // A tensor planned to be dead by now is still alive.
+          VLOG(2) << "Slot " << s << " of the static memory plan is in use";
+          continue;
+        }
+        live_[s] = true;
+        ++num_live_;
+        return buffer_ + slot.offset;
+      }
+    }
+  }
+  void* ptr = base_->AllocateRaw(alignment, num_bytes);
+  if (ptr != nullptr) {
+    mutex_lock l(mu_);
+    ++num_live_;
+  }
+  return ptr;
+}
+
+void StaticPlanStepAllocator::Deallocate(const std::vector<int>& slots,
+                                         void* ptr) {
+  char* const p = static_cast<char*>(ptr);
+  const bool in_buffer = buffer_ != nullptr && p >= buffer_ &&
+                         p < buffer_ + plan_->buffer_size();
+  if (!in_buffer) {
+    base_->DeallocateRaw(ptr);
+  }
+  bool destroy = false;
+  {
+    mutex_lock l(mu_);
+    if (in_buffer) {
+      const size_t offset = p - buffer_;
+      for (int s : slots) {
+        if (live_[s] && plan_->slots()[s].offset == offset) {
+          live_[s] = false;
+          break;
+        }
+      }
+    }
+    --num_live_;
+    destroy = released_ && num_live_ == 0;
+  }
+  if (destroy) {
+    delete this;
+  }
+}
+
+void StaticPlanStepAllocator::Release() {
+  bool destroy = false;
+  {
+    mutex_lock l(mu_);
+    released_ = true;
+    destroy = num_live_ == 0;
+  }
+  if (destroy) {
+    delete this;
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,134 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// The attribute holding the size in bytes of each output of a node, as
+// inferred statically (see StaticMemoryPlanningPass).  Outputs whose size is
+// not known, or that are not expected to be allocated by the node, have a
+// size of 0.
+extern const char* const kPlannedOutputBytesAttr;
+
+// A layout of the outputs of the nodes of a graph in a single buffer, for the
+// outputs whose sizes are annotated with kPlannedOutputBytesAttr.
+//
+// Two outputs may share memory if one of them is dead, i.e. all of its
+// consumers have completed, before the node producing the other one starts.
+// Since the executor runs independent nodes concurrently, this is the case
+// only if every consumer of one output is an ancestor of the producer of the
+// other.  The offsets are assigned greedily, largest output first, as in
+// TensorFlow Lite's ArenaPlanner.
+class StaticMemoryPlan {
+ public:
+  struct Slot {
+    size_t offset;
+    size_t bytes;
+    // The slots whose memory overlaps this one.
+    std::vector<int> overlapping;
+  };
+
+  // Returns nullptr if no output of 'graph' can be planned.
+  static std::unique_ptr<StaticMemoryPlan> Create(const Graph& graph);
+
+  size_t buffer_size() const { return buffer_size_; }
+  const std::vector<Slot>& slots() const { return slots_; }
+  int num_planned_nodes() const { return planned_node_slots_.size(); }
+
+  // Returns the index of the node with the given id among the planned nodes,
+  // or -1 if none of its outputs is planned.
+  int planned_node_index(int node_id) const {
+    return node_id < static_cast<int>(planned_node_indices_.size())
+               ? planned_node_indices_[node_id]
+               : -1;
+  }
+
+  // The slots of the outputs of a planned node.
+  const std::vector<int>& planned_node_slots(int planned_node_index) const {
+    return planned_node_slots_[planned_node_index];
+  }
+
+ private:
+  StaticMemoryPlan() = default;
+
+  size_t buffer_size_ = 0;
+  std::vector<Slot> slots_;
+  std::vector<int> planned_node_indices_;
+  std::vector<std::vector<int>> planned_node_slots_;
+};
+
+// Serves the allocations of the planned nodes of one step from a buffer laid
+// out according to a StaticMemoryPlan.
+//
+// An allocation by a planned node is placed in one of the node's slots if it
+// has the exact size of the slot, and no allocation is live in the slot or in
+// the slots that overlap it; otherwise it is passed through to the base
+// allocator.  This keeps the step correct when a tensor lives longer than
+// planned, e.g. because a kernel forwarded it to its output or it is fetched.
+//
+// Like StepArenaAllocator, it deletes itself once it has been released and
+// all of its allocations are freed.
+class StaticPlanStepAllocator {
+ public:
+  // 'plan' and 'base' must outlive this allocator.
+  StaticPlanStepAllocator(const StaticMemoryPlan* plan, Allocator* base);
+
+  // Returns the allocator to use for the allocations with default attributes
+  // of the node with the given id, or nullptr if the node has no planned
+  // outputs.
+  Allocator* NodeAllocator(int node_id);
+
+  // Ends the step.  The caller must not use this allocator afterwards, except
+  // through tensors that it has already allocated.
+  void Release() TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  class NodeAllocatorImpl;
+
+  // Only Release() and Deallocate() may destroy the allocator.
+  ~StaticPlanStepAllocator();
+
+  void* Allocate(const std::vector<int>& slots, size_t alignment,
+                 size_t num_bytes) TF_LOCKS_EXCLUDED(mu_);
+  void Deallocate(const std::vector<int>& slots, void* ptr)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  const StaticMemoryPlan* const plan_;  // Not owned.
+  Allocator* const base_;               // Not owned.
+  char* buffer_;
+  std::unique_ptr<NodeAllocatorImpl[]> node_allocators_;
+
+  mutex mu_;
+  std::vector<bool> live_ TF_GUARDED_BY(mu_);
+  // The number of allocations (in slots or from the base allocator) that have
+  // not been deallocated.
+  int64 num_live_ TF_GUARDED_BY(mu_) = 0;
+  bool released_ TF_GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticPlanStepAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
@@ -0,0 +1,181 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <atomic>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Counts the allocations made through it that are still live.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_live_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --num_live_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+  int num_live() const { return num_live_; }
+
+ private:
+  std::atomic<int> num_live_{0};
+};
+
+// Each planned output is a float tensor of shape [64].
+constexpr size_t kOutputBytes = 64 * sizeof(float);
+
+Node* PlannedNeg(Graph* g, Node* input) {
+  Node* n = test::graph::Unary(g, "Neg", input);
+  n->AddAttr(kPlannedOutputBytesAttr, std::vector<int64>{kOutputBytes});
+  return n;
+}
+
+Node* FloatConstant(Graph* g) {
+  Tensor t(DT_FLOAT, TensorShape({64}));
+  test::FillIota<float>(&t, 0.0f);
+  return test::graph::Constant(g, t);
+}
+
+size_t SlotOffset(const StaticMemoryPlan& plan, const Node* n) {
+  const int index = plan.planned_node_index(n->id());
+  CHECK_GE(index, 0);
+  return plan.slots()[plan.planned_node_slots(index)[0]].offset;
+}
+
+TEST(StaticMemoryPlanTest, NoPlannedOutputs) {
+  Graph g(OpRegistry::Global());
+  test::graph::Unary(&g, "Neg", FloatConstant(&g));
+  EXPECT_EQ(StaticMemoryPlan::Create(g), nullptr);
+}
+
+TEST(StaticMemoryPlanTest, SequentialChainReusesMemory) {
+  Graph g(OpRegistry::Global());
+  Node* a = PlannedNeg(&g, FloatConstant(&g));
+  Node* b = PlannedNeg(&g, a);
+  Node* c = PlannedNeg(&g, b);
+  auto plan = StaticMemoryPlan::Create(g);
+  ASSERT_NE(plan, nullptr);
+  EXPECT_EQ(plan->num_planned_nodes(), 3);
+  // `a` is dead once `b` completes, so `c` can take its place.
+  EXPECT_EQ(plan->buffer_size(), 2 * kOutputBytes);
+  EXPECT_EQ(SlotOffset(*plan, a), SlotOffset(*plan, c));
+  EXPECT_NE(SlotOffset(*plan, a), SlotOffset(*plan, b));
+}
+
+TEST(StaticMemoryPlanTest, ConcurrentBranchesDoNotShareMemory) {
+  Graph g(OpRegistry::Global());
+  Node* input = FloatConstant(&g);
+  Node* a = PlannedNeg(&g, input);
+  Node* b = PlannedNeg(&g, input);
+  Node* sum = test::graph::Add(&g, a, b);
+  sum->AddAttr(kPlannedOutputBytesAttr, std::vector<int64>{kOutputBytes});
+  // `a` and `b` may run at the same time, and are both used by `sum`.
+  auto plan = StaticMemoryPlan::Create(g);
+  ASSERT_NE(plan, nullptr);
+  EXPECT_EQ(plan->buffer_size(), 3 * kOutputBytes);
+}
+
+TEST(StaticMemoryPlanTest, GraphsWithLoopsAreNotPlanned) {
+  Graph g(OpRegistry::Global());
+  Node* a = PlannedNeg(&g, FloatConstant(&g));
+  test::graph::Next(&g, "next", a);
+  EXPECT_EQ(StaticMemoryPlan::Create(g), nullptr);
+}
+
+class StaticPlanStepAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    input_ = FloatConstant(&graph_);
+    a_ = PlannedNeg(&graph_, input_);
+    b_ = PlannedNeg(&graph_, a_);
+    c_ = PlannedNeg(&graph_, b_);
+    plan_ = StaticMemoryPlan::Create(graph_);
+    ASSERT_NE(plan_, nullptr);
+  }
+
+  Graph graph_{OpRegistry::Global()};
+  Node* input_;
+  Node* a_;
+  Node* b_;
+  Node* c_;
+  std::unique_ptr<StaticMemoryPlan> plan_;
+  CountingAllocator base_;
+};
+
+TEST_F(StaticPlanStepAllocatorTest, ServesPlannedSlots) {
+  auto* allocator = new StaticPlanStepAllocator(plan_.get(), &base_);
+  // Only the buffer is allocated from the base allocator.
+  EXPECT_EQ(base_.num_live(), 1);
+  EXPECT_EQ(allocator->NodeAllocator(input_->id()), nullptr);
+  void* a = allocator->NodeAllocator(a_->id())->AllocateRaw(64, kOutputBytes);
+  void* b = allocator->NodeAllocator(b_->id())->AllocateRaw(64, kOutputBytes);
+  allocator->NodeAllocator(a_->id())->DeallocateRaw(a);
+  void* c = allocator->NodeAllocator(c_->id())->AllocateRaw(64, kOutputBytes);
+  EXPECT_EQ(c, a);
+  EXPECT_NE(c, b);
+  EXPECT_EQ(base_.num_live(), 1);
+  allocator->NodeAllocator(b_->id())->DeallocateRaw(b);
+  allocator->NodeAllocator(c_->id())->DeallocateRaw(c);
+  allocator->Release();
+  EXPECT_EQ(base_.num_live(), 0);
+}
+
+TEST_F(StaticPlanStepAllocatorTest, FallsBackWhenPlanDoesNotHold) {
+  auto* allocator = new StaticPlanStepAllocator(plan_.get(), &base_);
+  Allocator* a_allocator = allocator->NodeAllocator(a_->id());
+  Allocator* c_allocator = allocator->NodeAllocator(c_->id());
+  // `a` lives longer than planned, e.g. because it was forwarded to the
+  // output of `b`, so `c` cannot take its place.
+  void* a = a_allocator->AllocateRaw(64, kOutputBytes);
+  void* c = c_allocator->AllocateRaw(64, kOutputBytes);
+  EXPECT_NE(c, a);
+  EXPECT_EQ(base_.num_live(), 2);
+  // Allocations of a different size than planned are passed through too.
+  void* small = a_allocator->AllocateRaw(64, kOutputBytes / 2);
+  EXPECT_EQ(base_.num_live(), 3);
+  a_allocator->DeallocateRaw(small);
+  c_allocator->DeallocateRaw(c);
+  a_allocator->DeallocateRaw(a);
+  EXPECT_EQ(base_.num_live(), 1);
+  allocator->Release();
+  EXPECT_EQ(base_.num_live(), 0);
+}
+
+TEST_F(StaticPlanStepAllocatorTest, EscapingTensorsOutliveStep) {
+  auto* allocator = new StaticPlanStepAllocator(plan_.get(), &base_);
+  Tensor escaping(allocator->NodeAllocator(a_->id()), DT_FLOAT,
+                  TensorShape({64}));
+  test::FillIota<float>(&escaping, 0.0f);
+  allocator->Release();
+  // The buffer is kept alive as long as a tensor in it is.
+  EXPECT_EQ(base_.num_live(), 1);
+  Tensor expected(DT_FLOAT, TensorShape({64}));
+  test::FillIota<float>(&expected, 0.0f);
+  test::ExpectTensorEqual<float>(escaping, expected);
+  escaping = Tensor();
+  EXPECT_EQ(base_.num_live(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,110 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/static_memory_planning_pass.h"
+
+#include "tensorflow/core/common_runtime/shape_refiner.h"
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Returns true if the outputs of 'n' are usually not allocated by its kernel,
+// but alias an input or a persistent tensor.
+bool OutputsAreNotAllocated(const Node* n) {
+  return n->IsArg() || n->IsConstant() || n->IsRecv() || n->IsIdentity() ||
+         n->IsVariable() || n->type_string() == "Reshape" ||
+         n->type_string() == "ExpandDims" || n->type_string() == "Squeeze" ||
+         n->type_string() == "ReadVariableOp";
+}
+
+bool IsCpuPartition(const string& device_name) {
+  DeviceNameUtils::ParsedName parsed_name;
+  return DeviceNameUtils::ParseFullName(device_name, &parsed_name) &&
+         parsed_name.type == DEVICE_CPU;
+}
+
+void AnnotateOutputBytes(Graph* g) {
+  for (const Node* n : g->nodes()) {
+    if (n->IsNextIteration()) {
+      return;
+    }
+  }
+  ShapeRefiner refiner(g->versions(), g->op_registry());
+  refiner.set_require_shape_inference_fns(false);
+  std::vector<Node*> order;
+  GetReversePostOrder(*g, &order);
+  for (Node* n : order) {
+    // Nodes whose shapes cannot be inferred have unknown output shapes, so
+    // are simply not planned.
+    refiner.AddNode(n).IgnoreError();
+  }
+  int num_annotated = 0;
+  for (Node* n : order) {
+    if (!n->IsOp() || OutputsAreNotAllocated(n)) {
+      continue;
+    }
+    shape_inference::InferenceContext* c = refiner.GetContext(n);
+    if (c == nullptr) {
+      continue;
+    }
+    std::vector<int64> output_bytes(n->num_outputs(), 0);
+    bool any_planned = false;
+    for (int i = 0; i < n->num_outputs(); ++i) {
+      const DataType dtype = n->output_type(i);
+      if (IsRefType(dtype) || !DataTypeCanUseMemcpy(dtype)) {
+        continue;
+      }
+      shape_inference::ShapeHandle shape = c->output(i);
+      if (!c->FullyDefined(shape)) {
+        continue;
+      }
+      const int64 num_elements = c->Value(c->NumElements(shape));
+      output_bytes[i] = num_elements * DataTypeSize(dtype);
+      any_planned |= output_bytes[i] > 0;
+    }
+    if (any_planned) {
+      n->AddAttr(kPlannedOutputBytesAttr, output_bytes);
+      ++num_annotated;
+    }
+  }
+  VLOG(1) << "Annotated the output sizes of " << num_annotated << " nodes";
+}
+
+}  // namespace
+
+Status StaticMemoryPlanningPass::Run(
+    const GraphOptimizationPassOptions& options) {
+  if (options.session_options == nullptr ||
+      !options.session_options->config.experimental()
+           .use_static_memory_plan() ||
+      options.partition_graphs == nullptr) {
+    return Status::OK();
+  }
+  for (auto& partition : *options.partition_graphs) {
+    if (IsCpuPartition(partition.first)) {
+      AnnotateOutputBytes(partition.second.get());
+    }
+  }
+  return Status::OK();
+}
+
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_PARTITIONING, 50,
+                      StaticMemoryPlanningPass);
+
+}  // namespace tensorflow
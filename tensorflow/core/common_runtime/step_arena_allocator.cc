@@ -0,0 +1,216 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The smallest block carved from a chunk is 2^kMinSizeClass bytes.
+constexpr int kMinSizeClass = 8;
+// Chunks are allocated with (and blocks are carved at offsets that are
+// multiples of) this alignment. Allocations that need a larger alignment are
+// passed through to the base allocator.
+constexpr size_t kChunkAlignment = Allocator::kAllocatorAlignment;
+
+size_t RoundUp(size_t n, size_t alignment) {
+  return (n + alignment - 1) / alignment * alignment;
+}
+
+int SizeClass(size_t num_bytes) {
+  int size_class = kMinSizeClass;
+  while ((size_t{1} << size_class) < num_bytes) {
+    ++size_class;
+  }
+  return size_class;
+}
+
+}  // namespace
+
+StepArenaAllocator::StepArenaAllocator(Allocator* base, size_t chunk_size)
+    : base_(base),
+      chunk_size_(chunk_size),
+      // Only blocks of up to a quarter of a chunk are carved from chunks, which
+      // bounds the space wasted at the end of a chunk when a new one is
+      // started.
+      max_size_class_(chunk_size >= 4 ? Log2Floor64(chunk_size / 4) : 0),
+      free_lists_(max_size_class_ + 1) {}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  for (const auto& chunk : chunks_) {
+    base_->DeallocateRaw(chunk->data);
+  }
+}
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  alignment = std::max(alignment, alignof(Header));
+  const size_t header_size = RoundUp(sizeof(Header), alignment);
+  const int size_class = SizeClass(header_size + num_bytes);
+  if (alignment > kChunkAlignment || size_class > max_size_class_) {
+    return AllocateDirect(alignment, num_bytes);
+  }
+  const size_t block_size = size_t{1} << size_class;
+  char* block = nullptr;
+  Chunk* chunk = nullptr;
+  {
+    mutex_lock l(mu_);
+    // Once the step is over, chunks are no longer used for new allocations.
+    if (!released_) {
+      FreeList& free_list = free_lists_[size_class];
+      if (!free_list.empty()) {
+        block = free_list.back().first;
+        chunk = free_list.back().second;
+        free_list.pop_back();
+      } else {
+        if (current_chunk_ == nullptr ||
+            current_offset_ + block_size > chunk_size_) {
+          void* data = base_->AllocateRaw(kChunkAlignment, chunk_size_);
+          if (data == nullptr) {
+            return nullptr;
+          }
+          chunks_.emplace_back(new Chunk{static_cast<char*>(data)});
+          current_chunk_ = chunks_.back().get();
+          current_offset_ = 0;
+          stats_.bytes_reserved += chunk_size_;
+          stats_.peak_bytes_reserved =
+              std::max(stats_.peak_bytes_reserved, stats_.bytes_reserved);
+        }
+        block = current_chunk_->data + current_offset_;
+        chunk = current_chunk_;
+        current_offset_ += block_size;
+      }
+      ++chunk->num_live;
+      ++num_live_;
+      ++stats_.num_allocs;
+      stats_.bytes_in_use += block_size;
+      stats_.peak_bytes_in_use =
+          std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+      stats_.largest_alloc_size =
+          std::max<int64>(stats_.largest_alloc_size, num_bytes);
+    }
+  }
+  if (chunk == nullptr) {
+    return AllocateDirect(alignment, num_bytes);
+  }
+  char* ptr = block + header_size;
+  Header* header = reinterpret_cast<Header*>(ptr) - 1;
+  header->chunk = chunk;
+  header->block = block;
+  header->size = block_size;
+  return ptr;
+}
+
+void* StepArenaAllocator::AllocateDirect(size_t alignment, size_t num_bytes) {
+  const size_t header_size = RoundUp(sizeof(Header), alignment);
+  char* block = static_cast<char*>(
+      base_->AllocateRaw(alignment, header_size + num_bytes));
+  if (block == nullptr) {
+    return nullptr;
+  }
+  char* ptr = block + header_size;
+  Header* header = reinterpret_cast<Header*>(ptr) - 1;
+  header->chunk = nullptr;
+  header->block = block;
+  header->size = header_size + num_bytes;
+  mutex_lock l(mu_);
+  ++num_live_;
+  ++stats_.num_allocs;
+  stats_.bytes_in_use += header->size;
+  stats_.peak_bytes_in_use =
+      std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+  stats_.largest_alloc_size =
+      std::max<int64>(stats_.largest_alloc_size, num_bytes);
+  return ptr;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  const Header* header = reinterpret_cast<Header*>(ptr) - 1;
+  Chunk* const chunk = header->chunk;
+  char* const block = header->block;
+  const size_t size = header->size;
+  bool destroy = false;
+  {
+    mutex_lock l(mu_);
+    --num_live_;
+    stats_.bytes_in_use -= size;
+    if (chunk != nullptr) {
+      --chunk->num_live;
+      if (!released_) {
+        free_lists_[Log2Floor64(size)].emplace_back(block, chunk);
+      } else if (chunk->num_live == 0) {
+        // The last escaping tensor in this chunk has been freed.
+        FreeChunk(chunk);
+      }
+    }
+    destroy = released_ && num_live_ == 0;
+  }
+  if (chunk == nullptr) {
+    base_->DeallocateRaw(block);
+  }
+  if (destroy) {
+    delete this;
+  }
+}
+
+absl::optional<AllocatorStats> StepArenaAllocator::GetStats() {
+  mutex_lock l(mu_);
+  return stats_;
+}
+
+void StepArenaAllocator::Release() {
+  bool destroy = false;
+  {
+    mutex_lock l(mu_);
+    released_ = true;
+    current_chunk_ = nullptr;
+    free_lists_.clear();
+    std::vector<Chunk*> idle_chunks;
+    for (const auto& chunk : chunks_) {
+      if (chunk->num_live == 0) {
+        idle_chunks.push_back(chunk.get());
+      }
+    }
+    for (Chunk* chunk : idle_chunks) {
+      FreeChunk(chunk);
+    }
+    if (num_live_ > 0) {
+      VLOG(2) << num_live_ << " allocations escape the step, keeping "
+              << chunks_.size() << " chunks of " << chunk_size_
+              << " bytes alive";
+    }
+    destroy = num_live_ == 0;
+  }
+  if (destroy) {
+    delete this;
+  }
+}
+
+void StepArenaAllocator::FreeChunk(Chunk* chunk) {
+  base_->DeallocateRaw(chunk->data);
+  stats_.bytes_reserved -= chunk_size_;
+  auto it = std::find_if(chunks_.begin(), chunks_.end(),
+                         [chunk](const std::unique_ptr<Chunk>& c) {
+                           return c.get() == chunk;
+                         });
+  DCHECK(it != chunks_.end());
+  chunks_.erase(it);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,110 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// An allocator for the short-lived tensors of a single executor step.
+//
+// Small allocations are carved out of large chunks obtained from a base
+// allocator, in power-of-two size classes; freed blocks are recycled for later
+// allocations of the same class in the step, and the chunks are returned to the
+// base allocator in bulk once the step is over. This avoids a call into the
+// base allocator (e.g. malloc) for most tensors of the step.
+//
+// Tensors may outlive the step (e.g. fetched outputs, or buffers forwarded into
+// variables). Each chunk counts its live allocations, so when the step calls
+// Release() only the chunks that hold such escaping tensors are kept, and each
+// of them is freed when its last tensor is deallocated. The allocator deletes
+// itself once it has been released and all of its allocations are freed.
+class StepArenaAllocator : public Allocator {
+ public:
+  static constexpr size_t kDefaultChunkSize = 1 << 20;
+
+  // `base` must outlive this allocator.
+  explicit StepArenaAllocator(Allocator* base,
+                              size_t chunk_size = kDefaultChunkSize);
+
+  std::string Name() override { return "step_arena"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override
+      TF_LOCKS_EXCLUDED(mu_);
+  void DeallocateRaw(void* ptr) override TF_LOCKS_EXCLUDED(mu_);
+  absl::optional<AllocatorStats> GetStats() override TF_LOCKS_EXCLUDED(mu_);
+
+  // Ends the step. Chunks without live allocations are freed immediately, and
+  // later allocations are passed through to the base allocator. The caller
+  // must not use this allocator afterwards, except through tensors that it
+  // has already allocated.
+  void Release() TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Chunk {
+    char* data;
+    // The number of allocations in this chunk that have not been deallocated.
+    int64 num_live = 0;
+  };
+
+  // Stored immediately before every pointer returned by AllocateRaw().
+  struct Header {
+    // The chunk containing the allocation, or null if the allocation was
+    // passed through to the base allocator.
+    Chunk* chunk;
+    // The start of the block (for chunk allocations) or of the base
+    // allocation that contains the returned pointer.
+    char* block;
+    // The size of the block, or of the base allocation.
+    size_t size;
+  };
+
+  // The free blocks of one size class.
+  typedef std::vector<std::pair<char*, Chunk*>> FreeList;
+
+  // Only Release() and DeallocateRaw() may destroy the allocator.
+  ~StepArenaAllocator() override;
+
+  void* AllocateDirect(size_t alignment, size_t num_bytes);
+  void FreeChunk(Chunk* chunk) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const base_;  // Not owned.
+  const size_t chunk_size_;
+  const int max_size_class_;
+
+  mutex mu_;
+  std::vector<std::unique_ptr<Chunk>> chunks_ TF_GUARDED_BY(mu_);
+  // The chunk from which new blocks are carved, and the offset of its unused
+  // remainder.
+  Chunk* current_chunk_ TF_GUARDED_BY(mu_) = nullptr;
+  size_t current_offset_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<FreeList> free_lists_ TF_GUARDED_BY(mu_);
+  // The number of allocations (from chunks or the base allocator) that have
+  // not been deallocated.
+  int64 num_live_ TF_GUARDED_BY(mu_) = 0;
+  bool released_ TF_GUARDED_BY(mu_) = false;
+  AllocatorStats stats_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
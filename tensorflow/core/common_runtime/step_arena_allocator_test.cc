@@ -0,0 +1,127 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Counts the allocations made through it that are still live.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_live_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --num_live_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+  int num_live() const { return num_live_; }
+
+ private:
+  std::atomic<int> num_live_{0};
+};
+
+TEST(StepArenaAllocatorTest, RecyclesFreedBlocks) {
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, 1 << 16);
+  void* p1 = arena->AllocateRaw(64, 100);
+  void* p2 = arena->AllocateRaw(64, 100);
+  // Both allocations are carved from the same chunk.
+  EXPECT_EQ(base.num_live(), 1);
+  arena->DeallocateRaw(p1);
+  // A freed block is reused for the next allocation of the same size class.
+  void* p3 = arena->AllocateRaw(64, 90);
+  EXPECT_EQ(p3, p1);
+  EXPECT_EQ(base.num_live(), 1);
+  EXPECT_EQ(arena->GetStats()->num_allocs, 3);
+  arena->DeallocateRaw(p2);
+  arena->DeallocateRaw(p3);
+  arena->Release();
+  EXPECT_EQ(base.num_live(), 0);
+}
+
+TEST(StepArenaAllocatorTest, Alignment) {
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, 1 << 16);
+  std::vector<void*> ptrs;
+  for (size_t alignment : {1, 8, 16, 32, 64, 128, 256}) {
+    for (size_t num_bytes : {1, 7, 64, 1000, 1 << 15}) {
+      void* ptr = arena->AllocateRaw(alignment, num_bytes);
+      ASSERT_NE(ptr, nullptr);
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignment, 0)
+          << "alignment = " << alignment << ", num_bytes = " << num_bytes;
+      memset(ptr, 0xff, num_bytes);
+      ptrs.push_back(ptr);
+    }
+  }
+  for (void* ptr : ptrs) {
+    arena->DeallocateRaw(ptr);
+  }
+  arena->Release();
+  EXPECT_EQ(base.num_live(), 0);
+}
+
+TEST(StepArenaAllocatorTest, LargeAllocationsPassThrough) {
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, 1 << 16);
+  void* ptr = arena->AllocateRaw(64, 1 << 16);
+  // The allocation does not fit a block, so no chunk is allocated for it.
+  EXPECT_EQ(base.num_live(), 1);
+  EXPECT_EQ(arena->GetStats()->bytes_reserved, 0);
+  arena->DeallocateRaw(ptr);
+  EXPECT_EQ(base.num_live(), 0);
+  arena->Release();
+}
+
+TEST(StepArenaAllocatorTest, EscapingTensorsOutliveStep) {
+  CountingAllocator base;
+  auto* arena = new StepArenaAllocator(&base, 1 << 12);
+  Tensor escaping;
+  {
+    // Fill a chunk and a half with 512-byte blocks, and keep a tensor from the
+    // second chunk alive past the end of the step.
+    std::vector<Tensor> temporaries;
+    for (int i = 0; i < 12; ++i) {
+      temporaries.emplace_back(arena, DT_FLOAT, TensorShape({64}));
+    }
+    EXPECT_EQ(base.num_live(), 2);
+    escaping = temporaries.back();
+    test::FillIota<float>(&escaping, 0.0f);
+  }
+  arena->Release();
+  // Only the chunk that holds the escaping tensor is kept.
+  EXPECT_EQ(base.num_live(), 1);
+  Tensor expected(DT_FLOAT, TensorShape({64}));
+  test::FillIota<float>(&expected, 0.0f);
+  test::ExpectTensorEqual<float>(escaping, expected);
+  // Allocations after the end of the step are passed through.
+  Tensor late(arena, DT_FLOAT, TensorShape({64}));
+  EXPECT_EQ(base.num_live(), 2);
+  late = Tensor();
+  escaping = Tensor();
+  EXPECT_EQ(base.num_live(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
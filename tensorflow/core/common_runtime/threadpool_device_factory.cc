@@ -42,6 +42,16 @@ class ThreadPoolDeviceFactory : public DeviceFactory {
     auto iter = options.config.device_count().find("CPU");
     if (iter != options.config.device_count().end()) {
       n = iter->second;
+    } else if (options.config.experimental().use_numa_affinity()) {
+      n = num_numa_nodes;
+    }
+    if (options.config.experimental().use_numa_affinity() &&
+        num_numa_nodes > 1) {
+      // Give each NUMA node its own CPU allocator, backed by memory on that
+      // node. This only takes effect if no CPU allocator exists yet, i.e. if
+      // this is the first session in the process. Otherwise every device
+      // keeps using the shared allocator.
+      ProcessState::singleton()->EnableNUMA();
     }
     for (int i = 0; i < n; i++) {
       string name = strings::StrCat(name_prefix, "/device:CPU:", i);
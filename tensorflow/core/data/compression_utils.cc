@@ -14,20 +14,253 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/platform/coding.h"
 #include "tensorflow/core/platform/snappy.h"
 
 namespace tensorflow {
 namespace data {
+namespace {
+
+template <typename T>
+void DeltaVarintEncode(const Tensor& tensor, std::string* out) {
+  auto values = tensor.flat<T>();
+  uint64 previous = 0;
+  for (int64 i = 0; i < values.size(); ++i) {
+    uint64 value = static_cast<uint64>(static_cast<int64>(values(i)));
+    int64 delta = static_cast<int64>(value - previous);
+    core::PutVarint64(out, (static_cast<uint64>(delta) << 1) ^
+                               static_cast<uint64>(delta >> 63));
+    previous = value;
+  }
+}
+
+template <typename T>
+Status DeltaVarintDecode(StringPiece input, Tensor* tensor) {
+  auto values = tensor->flat<T>();
+  uint64 previous = 0;
+  for (int64 i = 0; i < values.size(); ++i) {
+    uint64 zigzag;
+    if (!core::GetVarint64(&input, &zigzag)) {
+      return errors::Internal("Truncated delta encoded component.");
+    }
+    previous += (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+    values(i) = static_cast<T>(static_cast<int64>(previous));
+  }
+  return Status::OK();
+}
+
+// Groups the i-th bytes of all values together, so that the slowly varying
+// sign and exponent bytes form long runs that snappy compresses well.
+Status ByteShuffleEncode(const Tensor& tensor, std::string* out) {
+  const TensorBuffer* buffer = DMAHelper::buffer(&tensor);
+  const char* data = static_cast<const char*>(buffer->data());
+  const size_t width = DataTypeSize(tensor.dtype());
+  const size_t num_values = tensor.NumElements();
+  std::string shuffled(width * num_values, '\0');
+  for (size_t byte = 0; byte < width; ++byte) {
+    for (size_t i = 0; i < num_values; ++i) {
+      shuffled[byte * num_values + i] = data[i * width + byte];
+    }
+  }
+  if (!port::Snappy_Compress(shuffled.data(), shuffled.size(), out)) {
+    return errors::Internal("Failed to compress using snappy.");
+  }
+  return Status::OK();
+}
+
+Status ByteShuffleDecode(StringPiece input, Tensor* tensor) {
+  TensorBuffer* buffer = DMAHelper::buffer(tensor);
+  char* data = static_cast<char*>(buffer->data());
+  const size_t width = DataTypeSize(tensor->dtype());
+  const size_t num_values = tensor->NumElements();
+  size_t uncompressed_size;
+  if (!port::Snappy_GetUncompressedLength(input.data(), input.size(),
+                                          &uncompressed_size) ||
+      uncompressed_size != width * num_values) {
+    return errors::Internal("Byte shuffled component has ", input.size(),
+                            " bytes, but expected ", width * num_values,
+                            " bytes after decompression.");
+  }
+  std::string shuffled(uncompressed_size, '\0');
+  if (!port::Snappy_Uncompress(input.data(), input.size(), &shuffled[0])) {
+    return errors::Internal("Failed to perform snappy decompression.");
+  }
+  for (size_t byte = 0; byte < width; ++byte) {
+    for (size_t i = 0; i < num_values; ++i) {
+      data[i * width + byte] = shuffled[byte * num_values + i];
+    }
+  }
+  return Status::OK();
+}
+
+// Returns false without encoding if fewer than half of the values repeat an
+// earlier value, in which case the dictionary would not pay for itself.
+bool DictionaryEncode(const Tensor& tensor, std::string* out) {
+  auto values = tensor.flat<tstring>();
+  absl::flat_hash_map<absl::string_view, uint64> ids;
+  std::vector<absl::string_view> dictionary;
+  std::vector<uint64> indices;
+  indices.reserve(values.size());
+  for (int64 i = 0; i < values.size(); ++i) {
+    absl::string_view value(values(i).data(), values(i).size());
+    const uint64 next_id = dictionary.size();
+    auto inserted = ids.emplace(value, next_id);
+    if (inserted.second) {
+      dictionary.push_back(value);
+    }
+    indices.push_back(inserted.first->second);
+  }
+  if (dictionary.size() * 2 > indices.size()) {
+    return false;
+  }
+  core::PutVarint64(out, dictionary.size());
+  for (const auto& value : dictionary) {
+    core::PutVarint64(out, value.size());
+    out->append(value.data(), value.size());
+  }
+  for (uint64 index : indices) {
+    core::PutVarint64(out, index);
+  }
+  return true;
+}
+
+Status DictionaryDecode(StringPiece input, Tensor* tensor) {
+  auto values = tensor->flat<tstring>();
+  uint64 dictionary_size;
+  if (!core::GetVarint64(&input, &dictionary_size)) {
+    return errors::Internal("Truncated dictionary encoded component.");
+  }
+  std::vector<StringPiece> dictionary;
+  for (uint64 i = 0; i < dictionary_size; ++i) {
+    uint64 length;
+    if (!core::GetVarint64(&input, &length) || input.size() < length) {
+      return errors::Internal("Truncated dictionary encoded component.");
+    }
+    dictionary.push_back(input.substr(0, length));
+    input.remove_prefix(length);
+  }
+  for (int64 i = 0; i < values.size(); ++i) {
+    uint64 index;
+    if (!core::GetVarint64(&input, &index) || index >= dictionary.size()) {
+      return errors::Internal("Invalid dictionary index in component.");
+    }
+    values(i).assign(dictionary[index].data(), dictionary[index].size());
+  }
+  return Status::OK();
+}
+
+// Encodes `component` into `metadata->encoded_data()` if one of the columnar
+// encodings applies to its dtype and shrinks it. Otherwise leaves the
+// component to be compressed as part of the element-wide snappy block.
+Status EncodeComponent(const Tensor& component,
+                       CompressedComponentMetadata* metadata) {
+  if (component.NumElements() == 0) {
+    return Status::OK();
+  }
+  std::string* encoded = metadata->mutable_encoded_data();
+  switch (component.dtype()) {
+    case DT_INT32:
+      DeltaVarintEncode<int32>(component, encoded);
+      metadata->set_encoding(CompressedComponentMetadata::DELTA_VARINT);
+      break;
+    case DT_INT64:
+      DeltaVarintEncode<int64>(component, encoded);
+      metadata->set_encoding(CompressedComponentMetadata::DELTA_VARINT);
+      break;
+    case DT_HALF:
+    case DT_BFLOAT16:
+    case DT_FLOAT:
+    case DT_DOUBLE:
+      TF_RETURN_IF_ERROR(ByteShuffleEncode(component, encoded));
+      metadata->set_encoding(CompressedComponentMetadata::BYTE_SHUFFLE_SNAPPY);
+      break;
+    case DT_STRING:
+      if (DictionaryEncode(component, encoded)) {
+        metadata->set_encoding(CompressedComponentMetadata::DICTIONARY);
+      }
+      break;
+    default:
+      break;
+  }
+  if (DataTypeCanUseMemcpy(component.dtype()) &&
+      encoded->size() >= DMAHelper::buffer(&component)->size()) {
+    metadata->clear_encoded_data();
+    metadata->set_encoding(CompressedComponentMetadata::SNAPPY_BLOCK);
+  }
+  return Status::OK();
+}
+
+Status DecodeComponent(const CompressedComponentMetadata& metadata,
+                       Tensor* out) {
+  StringPiece encoded = metadata.encoded_data();
+  switch (metadata.encoding()) {
+    case CompressedComponentMetadata::DELTA_VARINT:
+      if (metadata.dtype() == DT_INT32) {
+        return DeltaVarintDecode<int32>(encoded, out);
+      }
+      if (metadata.dtype() == DT_INT64) {
+        return DeltaVarintDecode<int64>(encoded, out);
+      }
+      break;
+    case CompressedComponentMetadata::BYTE_SHUFFLE_SNAPPY:
+      if (DataTypeCanUseMemcpy(metadata.dtype())) {
+        return ByteShuffleDecode(encoded, out);
+      }
+      break;
+    case CompressedComponentMetadata::DICTIONARY:
+      if (metadata.dtype() == DT_STRING) {
+        return DictionaryDecode(encoded, out);
+      }
+      break;
+    default:
+      break;
+  }
+  return errors::Internal(
+      "Unsupported encoding ",
+      CompressedComponentMetadata::Encoding_Name(metadata.encoding()),
+      " for a component of type ", DataTypeString(metadata.dtype()));
+}
+
+}  // namespace
 
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out) {
+  return CompressElement(element, ElementCodec::kSnappy, out);
+}
+
+Status CompressElement(const std::vector<Tensor>& element, ElementCodec codec,
+                       CompressedElement* out) {
+  // Step 0: Write the component metadata, encoding components on their own
+  // where the codec allows it.
+  for (auto& component : element) {
+    CompressedComponentMetadata* metadata =
+        out->mutable_component_metadata()->Add();
+    metadata->set_dtype(component.dtype());
+    component.shape().AsProto(metadata->mutable_tensor_shape());
+    if (codec == ElementCodec::kColumnar) {
+      TF_RETURN_IF_ERROR(EncodeComponent(component, metadata));
+    }
+  }
+  auto in_block = [out](int i) {
+    return out->component_metadata(i).encoding() ==
+           CompressedComponentMetadata::SNAPPY_BLOCK;
+  };
+
   // Step 1: Determine the total uncompressed size. This requires serializing
   // non-memcopyable tensors, which we save to use again later.
   std::vector<TensorProto> non_memcpy_components;
   int64 total_size = 0;
-  for (auto& component : element) {
+  int num_block_components = 0;
+  for (int i = 0; i < element.size(); ++i) {
+    const Tensor& component = element[i];
+    if (!in_block(i)) {
+      continue;
+    }
+    ++num_block_components;
     if (DataTypeCanUseMemcpy(component.dtype())) {
       // Some datatypes can be memcopied, allowing us to save two copies
       // (AsProtoTensorContent and SerializeToArray).
@@ -46,11 +279,13 @@ Status CompressElement(const std::vector<Tensor>& element,
   // Position in `uncompressed` to write the next component.
   char* position = uncompressed.mdata();
   int non_memcpy_component_index = 0;
-  for (auto& component : element) {
+  for (int i = 0; i < element.size(); ++i) {
+    const Tensor& component = element[i];
+    if (!in_block(i)) {
+      continue;
+    }
     CompressedComponentMetadata* metadata =
-        out->mutable_component_metadata()->Add();
-    metadata->set_dtype(component.dtype());
-    component.shape().AsProto(metadata->mutable_tensor_shape());
+        out->mutable_component_metadata(i);
     if (DataTypeCanUseMemcpy(component.dtype())) {
       const TensorBuffer* buffer = DMAHelper::buffer(&component);
       memcpy(position, buffer->data(), buffer->size());
@@ -64,6 +299,9 @@ Status CompressElement(const std::vector<Tensor>& element,
   }
   DCHECK_EQ(position, uncompressed.mdata() + total_size);
 
+  if (codec == ElementCodec::kColumnar && num_block_components == 0) {
+    return Status::OK();
+  }
   if (!port::Snappy_Compress(uncompressed.mdata(), total_size,
                              out->mutable_data())) {
     return errors::Internal("Failed to compress using snappy.");
@@ -80,7 +318,8 @@ Status UncompressElement(const CompressedElement& compressed,
   out->reserve(num_components);
 
   // Step 1: Prepare the memory that we will uncompress into.
-  std::vector<struct iovec> iov(num_components);
+  std::vector<struct iovec> iov;
+  iov.reserve(num_components);
   // We use tstring for access to resize_uninitialized.
   std::vector<tstring> tensor_proto_strs;
   // num_components is a conservative estimate. It is important to reserve
@@ -91,11 +330,17 @@ Status UncompressElement(const CompressedElement& compressed,
   for (int i = 0; i < num_components; ++i) {
     const CompressedComponentMetadata& metadata =
         compressed.component_metadata(i);
+    if (metadata.encoding() != CompressedComponentMetadata::SNAPPY_BLOCK) {
+      out->emplace_back(metadata.dtype(), metadata.tensor_shape());
+      TF_RETURN_IF_ERROR(DecodeComponent(metadata, &out->back()));
+      continue;
+    }
+    iov.emplace_back();
     if (DataTypeCanUseMemcpy(metadata.dtype())) {
       out->emplace_back(metadata.dtype(), metadata.tensor_shape());
       TensorBuffer* buffer = DMAHelper::buffer(&out->back());
-      iov[i].iov_base = buffer->data();
-      iov[i].iov_len = buffer->size();
+      iov.back().iov_base = buffer->data();
+      iov.back().iov_len = buffer->size();
     } else {
       // Allocate an empty Tensor. We will fill it out later after
       // uncompressing into the tensor_proto_str.
@@ -103,13 +348,16 @@ Status UncompressElement(const CompressedElement& compressed,
       tensor_proto_strs.emplace_back();
       tstring& tensor_proto_str = tensor_proto_strs.back();
       tensor_proto_str.resize_uninitialized(metadata.tensor_size_bytes());
-      iov[i].iov_base = tensor_proto_str.mdata();
-      iov[i].iov_len = tensor_proto_str.size();
+      iov.back().iov_base = tensor_proto_str.mdata();
+      iov.back().iov_len = tensor_proto_str.size();
     }
-    total_size += iov[i].iov_len;
+    total_size += iov.back().iov_len;
   }
 
   // Step 2: Uncompress into the iovec.
+  if (iov.empty() && compressed.data().empty()) {
+    return Status::OK();
+  }
   const std::string& compressed_data = compressed.data();
   size_t uncompressed_size;
   if (!port::Snappy_GetUncompressedLength(
@@ -125,14 +373,17 @@ Status UncompressElement(const CompressedElement& compressed,
   }
   if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
                                       compressed_data.size(), iov.data(),
-                                      num_components)) {
+                                      iov.size())) {
     return errors::Internal("Failed to perform snappy decompression.");
   }
 
   // Step 3: Deserialize tensor proto strings to tensors.
   int tensor_proto_strs_index = 0;
   for (int i = 0; i < num_components; ++i) {
-    if (DataTypeCanUseMemcpy(compressed.component_metadata(i).dtype())) {
+    const CompressedComponentMetadata& metadata =
+        compressed.component_metadata(i);
+    if (DataTypeCanUseMemcpy(metadata.dtype()) ||
+        metadata.encoding() != CompressedComponentMetadata::SNAPPY_BLOCK) {
       continue;
     }
     TensorProto tp;
@@ -22,6 +22,18 @@ limitations under the License.
 namespace tensorflow {
 namespace data {
 
+// Codecs supported by `CompressElement`.
+enum class ElementCodec {
+  // Snappy-compresses all components of the element as a single block.
+  kSnappy,
+  // Encodes each component on its own, choosing the encoding from the
+  // component dtype: integers are delta coded as zigzag varints, floating
+  // point values are byte-shuffled before snappy compression, and strings
+  // with repeated values are dictionary coded. Components that no encoding
+  // shrinks are snappy-compressed as a single block as with `kSnappy`.
+  kColumnar,
+};
+
 // Compresses the components of `element` into the `CompressedElement` proto.
 //
 // In addition to writing the actual compressed bytes, `Compress` fills
@@ -29,7 +41,12 @@ namespace data {
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
 
-// Uncompresses a `CompressedElement` into a vector of tensor components.
+// Like `CompressElement` above, but compresses using `codec`.
+Status CompressElement(const std::vector<Tensor>& element, ElementCodec codec,
+                       CompressedElement* out);
+
+// Uncompresses a `CompressedElement` into a vector of tensor components. Both
+// codecs are decoded transparently.
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out);
 
@@ -35,6 +35,48 @@ TEST_P(ParameterizedCompressionUtilsTest, RoundTrip) {
       ExpectEqual(element, round_trip_element, /*compare_order=*/true));
 }
 
+TEST_P(ParameterizedCompressionUtilsTest, ColumnarRoundTrip) {
+  std::vector<Tensor> element = GetParam();
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, ElementCodec::kColumnar, &compressed));
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+}
+
+TEST(CompressionUtilsTest, ColumnarEncodings) {
+  std::vector<int64> ids(1000);
+  std::vector<float> values(1000);
+  std::vector<tstring> labels(1000);
+  for (int i = 0; i < 1000; ++i) {
+    ids[i] = 1000000 + 3 * i;
+    values[i] = 0.5f + i % 7;
+    labels[i] = i % 2 == 0 ? "even" : "odd";
+  }
+  std::vector<Tensor> element = {
+      test::AsTensor<int64>(ids), test::AsTensor<float>(values),
+      test::AsTensor<tstring>(labels), test::AsTensor<bool>({true, false})};
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, ElementCodec::kColumnar, &compressed));
+  ASSERT_EQ(compressed.component_metadata_size(), 4);
+  EXPECT_EQ(compressed.component_metadata(0).encoding(),
+            CompressedComponentMetadata::DELTA_VARINT);
+  EXPECT_LT(compressed.component_metadata(0).encoded_data().size(),
+            ids.size() * sizeof(int64));
+  EXPECT_EQ(compressed.component_metadata(1).encoding(),
+            CompressedComponentMetadata::BYTE_SHUFFLE_SNAPPY);
+  EXPECT_EQ(compressed.component_metadata(2).encoding(),
+            CompressedComponentMetadata::DICTIONARY);
+  EXPECT_EQ(compressed.component_metadata(3).encoding(),
+            CompressedComponentMetadata::SNAPPY_BLOCK);
+
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+}
+
 std::vector<std::vector<Tensor>> TestCases() {
   return {
       CreateTensors<int64>(TensorShape{1}, {{1}}),             // int64
@@ -43,6 +85,15 @@ std::vector<std::vector<Tensor>> TestCases() {
       {CreateTensor<tstring>(TensorShape{1}, {"a"}),
        CreateTensor<int64>(TensorShape{1}, {1})},  // mixed tstring/int64
       {},                                          // empty
+      CreateTensors<int32>(TensorShape{4},
+                           {{-5, 7, kint32min, kint32max}}),  // int32
+      CreateTensors<int64>(TensorShape{3},
+                           {{kint64max, kint64min, 0}}),  // int64 extremes
+      CreateTensors<double>(TensorShape{2, 2},
+                            {{1.5, -2.0, 1e300, 0.0}}),  // double
+      CreateTensors<tstring>(TensorShape{4},
+                             {{"x", "y", "x", "x"}}),  // repeated tstring
+      CreateTensors<int64>(TensorShape{0}, {{}}),      // no values
   };
 }
 
@@ -59,8 +59,8 @@ std::string ProcessingModeToString(ProcessingMode mode) {
 
 Status DataServiceDispatcherClient::WorkerHeartbeat(
     const std::string& worker_address, const std::string& transfer_address,
-    const std::vector<int64>& current_tasks, std::vector<TaskDef>& new_tasks,
-    std::vector<int64>& tasks_to_delete) {
+    const std::vector<int64>& current_tasks, const WorkerLoad& load,
+    std::vector<TaskDef>& new_tasks, std::vector<int64>& tasks_to_delete) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
   WorkerHeartbeatRequest req;
   req.set_worker_address(worker_address);
@@ -68,6 +68,7 @@ Status DataServiceDispatcherClient::WorkerHeartbeat(
   for (int64 task : current_tasks) {
     req.add_current_tasks(task);
   }
+  *req.mutable_load() = load;
   WorkerHeartbeatResponse resp;
   grpc::ClientContext client_ctx;
   grpc::Status status = stub_->WorkerHeartbeat(&client_ctx, req, &resp);
@@ -208,6 +209,12 @@ Status DataServiceDispatcherClient::ClientHeartbeat(
 
 Status DataServiceDispatcherClient::GetWorkers(
     std::vector<WorkerInfo>& workers) {
+  int64 unused_recommended_num_workers;
+  return GetWorkers(workers, unused_recommended_num_workers);
+}
+
+Status DataServiceDispatcherClient::GetWorkers(
+    std::vector<WorkerInfo>& workers, int64& recommended_num_workers) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
   GetWorkersRequest req;
   GetWorkersResponse resp;
@@ -220,6 +227,7 @@ Status DataServiceDispatcherClient::GetWorkers(
   for (auto& worker : resp.workers()) {
     workers.push_back(worker);
   }
+  recommended_num_workers = resp.recommended_num_workers();
   return Status::OK();
 }
 
@@ -273,6 +281,35 @@ class GrpcDataTransferClient : public DataTransferClient {
     return Status::OK();
   }
 
+  Status GetElements(const GetElementsRequest& req,
+                     GetElementsResponse& resp) override {
+    {
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        return errors::Cancelled("Client was cancelled.");
+      }
+    }
+    grpc::ClientContext ctx;
+    {
+      mutex_lock l(mu_);
+      active_contexts_.insert(&ctx);
+    }
+    grpc::Status s = stub_->GetElements(&ctx, req, &resp);
+    {
+      mutex_lock l(mu_);
+      active_contexts_.erase(&ctx);
+    }
+    if (s.error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+      // The worker predates GetElements; fetch the elements one at a time.
+      resp.Clear();
+      return DataTransferClient::GetElements(req, resp);
+    }
+    if (!s.ok()) {
+      return grpc_util::WrapError("Failed to get elements", s);
+    }
+    return Status::OK();
+  }
+
   void TryCancel() override {
     mutex_lock l(mu_);
     cancelled_ = true;
@@ -326,6 +363,12 @@ Status DataServiceWorkerClient::EnsureInitialized() {
   return Status::OK();
 }
 
+Status DataServiceWorkerClient::GetElements(const GetElementsRequest& req,
+                                            GetElementsResponse& resp) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  return client_->GetElements(req, resp);
+}
+
 void DataServiceWorkerClient::TryCancel() { client_->TryCancel(); }
 
 Status CreateDataServiceDispatcherClient(
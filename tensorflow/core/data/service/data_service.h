@@ -82,10 +82,12 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   // registered with the dispatcher, this will register the worker. The
   // dispatcher will report which new tasks the worker should run, and which
   // tasks it should delete. This is stored into `new_tasks` and
-  // `tasks_to_delete`.
+  // `tasks_to_delete`. `load` reports the worker's current load, which the
+  // dispatcher uses when assigning tasks.
   Status WorkerHeartbeat(const std::string& worker_address,
                          const std::string& transfer_address,
                          const std::vector<int64>& current_tasks,
+                         const WorkerLoad& load,
                          std::vector<TaskDef>& new_tasks,
                          std::vector<int64>& tasks_to_delete);
 
@@ -126,6 +128,11 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   // stored in `workers`.
   Status GetWorkers(std::vector<WorkerInfo>& workers);
 
+  // Like `GetWorkers`, but also stores the number of workers the dispatcher
+  // recommends for the current load into `recommended_num_workers`.
+  Status GetWorkers(std::vector<WorkerInfo>& workers,
+                    int64& recommended_num_workers);
+
  protected:
   Status EnsureInitialized() override;
 
@@ -148,6 +155,9 @@ class DataServiceWorkerClient : public DataServiceClientBase {
   // Fetches an element from the worker.
   Status GetElement(const GetElementRequest& req, GetElementResponse& resp);
 
+  // Fetches up to `req.max_elements()` consecutive elements from the worker.
+  Status GetElements(const GetElementsRequest& req, GetElementsResponse& resp);
+
   // Makes a best effort to cancel all outstanding calls in progress for the
   // client, and causes further calls to return Cancelled status.
   void TryCancel();
@@ -15,10 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/data_service.h"
 
+#include <algorithm>
+#include <numeric>
+
 #include "grpcpp/create_channel.h"
 #include "grpcpp/security/credentials.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_split.h"
 #include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/grpc_util.h"
@@ -27,6 +32,9 @@ limitations under the License.
 #include "tensorflow/core/data/service/test_util.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/kernels/data/dataset_test_base.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
@@ -36,9 +44,233 @@ namespace tensorflow {
 namespace data {
 
 namespace {
+using ::tensorflow::test::function::GDef;
+using ::tensorflow::test::function::NDef;
+using FDH = ::tensorflow::FunctionDefHelper;
+
 constexpr const char kProtocol[] = "grpc+local";
+constexpr const char kCountingTransferProtocol[] = "counting_grpc";
+constexpr int64 kPrefetchBytes = 1 << 20;
+
+// Requests made through the counting transfer protocol.
+struct TransferStats {
+  mutex mu;
+  // The number of elements that in-flight requests may return.
+  int64 in_flight_elements TF_GUARDED_BY(mu) = 0;
+  int64 max_in_flight_elements TF_GUARDED_BY(mu) = 0;
+  // The most elements requested by a single request.
+  int64 max_request_elements TF_GUARDED_BY(mu) = 0;
+};
+
+TransferStats& GetTransferStats() {
+  static TransferStats* stats = new TransferStats();
+  return *stats;
+}
+
+void ResetTransferStats() {
+  TransferStats& stats = GetTransferStats();
+  mutex_lock l(stats.mu);
+  stats.in_flight_elements = 0;
+  stats.max_in_flight_elements = 0;
+  stats.max_request_elements = 0;
+}
+
+// Transfer client which forwards requests to the grpc transfer client and
+// records them in `GetTransferStats()`.
+class CountingTransferClient : public DataTransferClient {
+ public:
+  explicit CountingTransferClient(std::unique_ptr<DataTransferClient> client)
+      : client_(std::move(client)) {}
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResponse& resp) override {
+    StartRequest(/*num_elements=*/1);
+    Status s = client_->GetElement(req, resp);
+    FinishRequest(/*num_elements=*/1);
+    return s;
+  }
+
+  Status GetElements(const GetElementsRequest& req,
+                     GetElementsResponse& resp) override {
+    StartRequest(req.max_elements());
+    Status s = client_->GetElements(req, resp);
+    FinishRequest(req.max_elements());
+    return s;
+  }
+
+  void TryCancel() override { client_->TryCancel(); }
+
+ private:
+  static void StartRequest(int64 num_elements) {
+    TransferStats& stats = GetTransferStats();
+    mutex_lock l(stats.mu);
+    stats.in_flight_elements += num_elements;
+    stats.max_in_flight_elements =
+        std::max(stats.max_in_flight_elements, stats.in_flight_elements);
+    stats.max_request_elements =
+        std::max(stats.max_request_elements, num_elements);
+  }
+
+  static void FinishRequest(int64 num_elements) {
+    TransferStats& stats = GetTransferStats();
+    mutex_lock l(stats.mu);
+    stats.in_flight_elements -= num_elements;
+  }
+
+  std::unique_ptr<DataTransferClient> client_;
+};
+
+class CountingTransferClientRegistrar {
+ public:
+  CountingTransferClientRegistrar() {
+    DataTransferClient::Register(
+        kCountingTransferProtocol,
+        [](DataTransferClient::Config config,
+           std::unique_ptr<DataTransferClient>* out) {
+          std::unique_ptr<DataTransferClient> client;
+          TF_RETURN_IF_ERROR(
+              DataTransferClient::Build("grpc", config, &client));
+          *out = absl::make_unique<CountingTransferClient>(std::move(client));
+          return Status::OK();
+        });
+  }
+};
+static CountingTransferClientRegistrar registrar;
+
+NodeDef Int64Const(const std::string& name, int64 value) {
+  return NDef(name, "Const", {},
+              {{"value", test::AsScalar<int64>(value)}, {"dtype", DT_INT64}});
+}
+
+NodeDef StringConst(const std::string& name, const std::string& value) {
+  return NDef(name, "Const", {},
+              {{"value", test::AsScalar<tstring>(value)},
+               {"dtype", DT_STRING}});
 }
 
+// Returns the graph of `range(num_elements)` with compressed elements, as the
+// tf.data service expects. If `fail_at_end`, the dataset claims infinite
+// cardinality and fails with FailedPrecondition after its last element.
+GraphDef RangeDatasetGraph(int64 num_elements, bool fail_at_end) {
+  const std::vector<PartialTensorShape> scalar_shapes = {
+      PartialTensorShape({})};
+  std::vector<NodeDef> nodes = {
+      Int64Const("start", 0), Int64Const("stop", num_elements),
+      Int64Const("step", 1),
+      NDef("range", "RangeDataset", {"start", "stop", "step"},
+           {{"output_types", DataTypeVector{DT_INT64}},
+            {"output_shapes", scalar_shapes}})};
+  std::string input = "range";
+  if (fail_at_end) {
+    nodes.push_back(Int64Const("cardinality", kInfiniteCardinality));
+    nodes.push_back(NDef("assert_cardinality", "AssertCardinalityDataset",
+                         {"range", "cardinality"},
+                         {{"output_types", DataTypeVector{DT_INT64}},
+                          {"output_shapes", scalar_shapes}}));
+    input = "assert_cardinality";
+  }
+  nodes.push_back(NDef("compress", "MapDataset", {input},
+                       {{"f", FDH::FunctionRef("Compress")},
+                        {"Targuments", DataTypeVector{}},
+                        {"output_types", DataTypeVector{DT_VARIANT}},
+                        {"output_shapes", scalar_shapes},
+                        {"use_inter_op_parallelism", true},
+                        {"preserve_cardinality", true}}));
+  nodes.push_back(NDef("dataset", "_Retval", {"compress"},
+                       {{"T", DT_VARIANT}, {"index", 0}}));
+  FunctionDef compress = FDH::Create(
+      "Compress", {"x: int64"}, {"y: variant"}, {},
+      {{{"compressed"},
+        "CompressElement",
+        {"x"},
+        {{"input_types", DataTypeVector{DT_INT64}}}}},
+      {{"y", "compressed:compressed:0"}});
+  return GDef(nodes, {compress});
+}
+
+// Returns the graph of a `DataServiceDatasetV2` reading `dataset_id` from
+// `cluster`. A non-empty `job_name` makes a round-robin read with a single
+// consumer.
+GraphDef DataServiceDatasetGraph(TestCluster& cluster, int64 dataset_id,
+                                 const std::string& job_name,
+                                 int64 max_outstanding_requests) {
+  const int64 num_consumers = job_name.empty() ? -1 : 1;
+  const int64 consumer_index = job_name.empty() ? -1 : 0;
+  return GDef({
+      Int64Const("dataset_id", dataset_id),
+      StringConst("processing_mode", "parallel_epochs"),
+      StringConst("address", cluster.DispatcherAddress()),
+      StringConst("protocol", kProtocol),
+      StringConst("job_name", job_name),
+      Int64Const("consumer_index", consumer_index),
+      Int64Const("num_consumers", num_consumers),
+      Int64Const("max_outstanding_requests", max_outstanding_requests),
+      NDef("iteration_counter", "DummyIterationCounter", {}),
+      NDef("data_service", "DataServiceDatasetV2",
+           {"dataset_id", "processing_mode", "address", "protocol", "job_name",
+            "consumer_index", "num_consumers", "max_outstanding_requests",
+            "iteration_counter"},
+           {{"task_refresh_interval_hint_ms", 20},
+            {"output_types", DataTypeVector{DT_VARIANT}},
+            {"output_shapes",
+             std::vector<PartialTensorShape>{PartialTensorShape({})}},
+            {"data_transfer_protocol", kCountingTransferProtocol}}),
+      NDef("dataset", "_Retval", {"data_service"},
+           {{"T", DT_VARIANT}, {"index", 0}}),
+  });
+}
+
+// Registers `range(num_elements)` with the dispatcher of `cluster` and reads
+// up to `max_elements` elements from it through `DataServiceDatasetV2` into
+// `elements`. Returns the first error the iterator reports.
+Status ReadFromDataService(TestCluster& cluster, int64 num_elements,
+                           bool fail_at_end, const std::string& job_name,
+                           int64 max_outstanding_requests, int64 max_elements,
+                           std::vector<int64>& elements) {
+  DataServiceDispatcherClient dispatcher(cluster.DispatcherAddress(),
+                                         kProtocol);
+  int64 dataset_id;
+  TF_RETURN_IF_ERROR(dispatcher.RegisterDataset(
+      RangeDatasetGraph(num_elements, fail_at_end), dataset_id));
+  std::unique_ptr<standalone::Dataset> dataset;
+  TF_RETURN_IF_ERROR(standalone::Dataset::FromGraph(
+      {}, DataServiceDatasetGraph(cluster, dataset_id, job_name,
+                                  max_outstanding_requests),
+      &dataset));
+  std::unique_ptr<standalone::Iterator> iterator;
+  TF_RETURN_IF_ERROR(dataset->MakeIterator(&iterator));
+  while (static_cast<int64>(elements.size()) < max_elements) {
+    std::vector<Tensor> outputs;
+    bool end_of_input;
+    TF_RETURN_IF_ERROR(iterator->GetNext(&outputs, &end_of_input));
+    if (end_of_input) {
+      break;
+    }
+    const CompressedElement* compressed =
+        outputs[0].scalar<Variant>()().get<CompressedElement>();
+    if (compressed == nullptr) {
+      return errors::Internal("Expected a CompressedElement");
+    }
+    std::vector<Tensor> components;
+    TF_RETURN_IF_ERROR(UncompressElement(*compressed, &components));
+    elements.push_back(components[0].scalar<int64>()());
+  }
+  return Status::OK();
+}
+
+std::vector<int64> Range(int64 num_elements) {
+  std::vector<int64> elements(num_elements);
+  std::iota(elements.begin(), elements.end(), 0);
+  return elements;
+}
+
+experimental::WorkerConfig PrefetchingWorkerConfig() {
+  experimental::WorkerConfig config;
+  config.set_element_prefetch_bytes(kPrefetchBytes);
+  return config;
+}
+}  // namespace
+
 TEST(DataService, ParseParallelEpochsProcessingMode) {
   ProcessingMode mode;
   TF_ASSERT_OK(ParseProcessingMode("parallel_epochs", mode));
@@ -74,5 +306,201 @@ TEST(DataService, GetWorkers) {
   EXPECT_EQ(1, workers.size());
 }
 
+TEST(DataService, RecommendedNumWorkers) {
+  TestCluster cluster(1);
+  TF_ASSERT_OK(cluster.Initialize());
+  DataServiceDispatcherClient dispatcher(cluster.DispatcherAddress(),
+                                         kProtocol);
+  WorkerLoad load;
+  load.set_cpu_utilization(1.0);
+  load.set_cpu_utilization_measured(true);
+  std::vector<TaskDef> new_tasks;
+  std::vector<int64> tasks_to_delete;
+  TF_ASSERT_OK(dispatcher.WorkerHeartbeat("overloaded_worker:1234",
+                                          "overloaded_worker:1235", {}, load,
+                                          new_tasks, tasks_to_delete));
+  std::vector<WorkerInfo> workers;
+  int64 recommended_num_workers;
+  TF_ASSERT_OK(dispatcher.GetWorkers(workers, recommended_num_workers));
+  EXPECT_EQ(2, workers.size());
+  // A fully loaded worker alone needs more than one worker at the target
+  // utilization.
+  EXPECT_GE(recommended_num_workers, 2);
+}
+
+TEST(DataService, RecommendedNumWorkersIgnoresUnmeasuredLoad) {
+  TestCluster cluster(/*num_workers=*/0);
+  TF_ASSERT_OK(cluster.Initialize());
+  DataServiceDispatcherClient dispatcher(cluster.DispatcherAddress(),
+                                         kProtocol);
+  WorkerLoad load;
+  load.set_cpu_utilization(1.0);
+  load.set_cpu_utilization_measured(true);
+  std::vector<TaskDef> new_tasks;
+  std::vector<int64> tasks_to_delete;
+  TF_ASSERT_OK(dispatcher.WorkerHeartbeat("busy_worker:1234",
+                                          "busy_worker:1235", {}, load,
+                                          new_tasks, tasks_to_delete));
+  // A worker's first heartbeat has no utilization to report yet.
+  TF_ASSERT_OK(dispatcher.WorkerHeartbeat("new_worker:1234", "new_worker:1235",
+                                          {}, WorkerLoad(), new_tasks,
+                                          tasks_to_delete));
+  std::vector<WorkerInfo> workers;
+  int64 recommended_num_workers;
+  TF_ASSERT_OK(dispatcher.GetWorkers(workers, recommended_num_workers));
+  EXPECT_EQ(2, workers.size());
+  // The new worker is assumed to be as busy as the busy worker, so together
+  // they need ceil(2.0 / 0.7) workers at the target utilization.
+  EXPECT_EQ(3, recommended_num_workers);
+}
+
+TEST(DataService, DeferTasksForOverloadedWorkers) {
+  TestCluster cluster(/*num_workers=*/0);
+  TF_ASSERT_OK(cluster.Initialize());
+  DataServiceDispatcherClient dispatcher(cluster.DispatcherAddress(),
+                                         kProtocol);
+  std::vector<TaskDef> new_tasks;
+  std::vector<int64> tasks_to_delete;
+  WorkerLoad idle_load;
+  idle_load.set_cpu_utilization(0.1);
+  idle_load.set_cpu_utilization_measured(true);
+  TF_ASSERT_OK(dispatcher.WorkerHeartbeat("idle_worker:1234",
+                                          "idle_worker:1235", {}, idle_load,
+                                          new_tasks, tasks_to_delete));
+  const std::string worker_address = "overloaded_worker:1234";
+  const std::string transfer_address = "overloaded_worker:1235";
+  WorkerLoad load;
+  load.set_cpu_utilization(1.0);
+  load.set_cpu_utilization_measured(true);
+  TF_ASSERT_OK(dispatcher.WorkerHeartbeat(worker_address, transfer_address,
+                                          {}, load, new_tasks,
+                                          tasks_to_delete));
+
+  test_util::GraphDefTestCase test_case;
+  TF_ASSERT_OK(test_util::map_test_case(&test_case));
+  int64 dataset_id;
+  TF_ASSERT_OK(dispatcher.RegisterDataset(test_case.graph_def, dataset_id));
+  int64 job_client_id;
+  TF_ASSERT_OK(dispatcher.GetOrCreateJob(
+      dataset_id, ProcessingMode::DISTRIBUTED_EPOCH,
+      /*job_key=*/absl::nullopt, /*num_consumers=*/absl::nullopt,
+      job_client_id));
+  ClientHeartbeatRequest client_request;
+  client_request.set_job_client_id(job_client_id);
+  ClientHeartbeatResponse client_response;
+  TF_ASSERT_OK(dispatcher.ClientHeartbeat(client_request, client_response));
+  // Only the idle worker got a task.
+  ASSERT_EQ(1, client_response.task_info_size());
+  EXPECT_EQ("idle_worker:1234", client_response.task_info(0).worker_address());
+
+  // The task isn't created while the worker stays overloaded.
+  TF_ASSERT_OK(dispatcher.WorkerHeartbeat(worker_address, transfer_address,
+                                          {}, load, new_tasks,
+                                          tasks_to_delete));
+  EXPECT_TRUE(new_tasks.empty());
+
+  load.set_cpu_utilization(0.1);
+  TF_ASSERT_OK(dispatcher.WorkerHeartbeat(worker_address, transfer_address,
+                                          {}, load, new_tasks,
+                                          tasks_to_delete));
+  ASSERT_EQ(1, new_tasks.size());
+  EXPECT_EQ(client_response.task_info(0).job_id(), new_tasks[0].job_id());
+}
+
+class BatchedGetElementsTest : public ::testing::TestWithParam<int64> {};
+
+TEST_P(BatchedGetElementsTest, ProducesElementsInOrder) {
+  const int64 max_outstanding_requests = GetParam();
+  ResetTransferStats();
+  TestCluster cluster(/*num_workers=*/1, PrefetchingWorkerConfig());
+  TF_ASSERT_OK(cluster.Initialize());
+  std::vector<int64> elements;
+  TF_ASSERT_OK(ReadFromDataService(
+      cluster, /*num_elements=*/100, /*fail_at_end=*/false, /*job_name=*/"",
+      max_outstanding_requests, /*max_elements=*/kint64max, elements));
+  EXPECT_EQ(elements, Range(100));
+
+  TransferStats& stats = GetTransferStats();
+  mutex_lock l(stats.mu);
+  EXPECT_LE(stats.max_in_flight_elements, max_outstanding_requests);
+  if (max_outstanding_requests > 1) {
+    // The only task's requests reserve all free space.
+    EXPECT_GT(stats.max_request_elements, 1);
+  } else {
+    EXPECT_EQ(stats.max_request_elements, 1);
+  }
+}
+
+TEST_P(BatchedGetElementsTest, ReservesMaxOutstandingRequestsAcrossTasks) {
+  const int64 max_outstanding_requests = GetParam();
+  ResetTransferStats();
+  TestCluster cluster(/*num_workers=*/2, PrefetchingWorkerConfig());
+  TF_ASSERT_OK(cluster.Initialize());
+  std::vector<int64> elements;
+  TF_ASSERT_OK(ReadFromDataService(
+      cluster, /*num_elements=*/100, /*fail_at_end=*/false, /*job_name=*/"",
+      max_outstanding_requests, /*max_elements=*/kint64max, elements));
+  // Each of the two tasks produces the whole range.
+  std::vector<int64> expected = Range(100);
+  expected.insert(expected.end(), expected.begin(), expected.end());
+  std::sort(expected.begin(), expected.end());
+  std::sort(elements.begin(), elements.end());
+  EXPECT_EQ(elements, expected);
+
+  TransferStats& stats = GetTransferStats();
+  mutex_lock l(stats.mu);
+  EXPECT_LE(stats.max_in_flight_elements, max_outstanding_requests);
+}
+
+TEST_P(BatchedGetElementsTest, PropagatesErrorAfterPartialBatch) {
+  ResetTransferStats();
+  TestCluster cluster(/*num_workers=*/1, PrefetchingWorkerConfig());
+  TF_ASSERT_OK(cluster.Initialize());
+  std::vector<int64> elements;
+  Status s = ReadFromDataService(
+      cluster, /*num_elements=*/25, /*fail_at_end=*/true, /*job_name=*/"",
+      /*max_outstanding_requests=*/GetParam(), /*max_elements=*/kint64max,
+      elements);
+  EXPECT_EQ(s.code(), error::FAILED_PRECONDITION) << s;
+  // Elements fetched before the error may be dropped with it, but the ones
+  // produced are in order.
+  ASSERT_LE(elements.size(), 25u);
+  EXPECT_EQ(elements, Range(elements.size()));
+}
+
+INSTANTIATE_TEST_SUITE_P(MaxOutstandingRequests, BatchedGetElementsTest,
+                         ::testing::Values(1, 3, 16));
+
+TEST(DataService, RoundRobinReadProducesElementsInOrder) {
+  ResetTransferStats();
+  TestCluster cluster(/*num_workers=*/1, PrefetchingWorkerConfig());
+  TF_ASSERT_OK(cluster.Initialize());
+  std::vector<int64> elements;
+  TF_ASSERT_OK(ReadFromDataService(
+      cluster, /*num_elements=*/100, /*fail_at_end=*/true,
+      /*job_name=*/"round_robin", /*max_outstanding_requests=*/16,
+      /*max_elements=*/20, elements));
+  EXPECT_EQ(elements, Range(20));
+
+  TransferStats& stats = GetTransferStats();
+  mutex_lock l(stats.mu);
+  EXPECT_LE(stats.max_in_flight_elements, 16);
+  // Round-robin reads fetch one element per request.
+  EXPECT_EQ(stats.max_request_elements, 1);
+}
+
+TEST(DataService, RoundRobinReadPropagatesError) {
+  TestCluster cluster(/*num_workers=*/1, PrefetchingWorkerConfig());
+  TF_ASSERT_OK(cluster.Initialize());
+  std::vector<int64> elements;
+  Status s = ReadFromDataService(
+      cluster, /*num_elements=*/5, /*fail_at_end=*/true,
+      /*job_name=*/"round_robin", /*max_outstanding_requests=*/16,
+      /*max_elements=*/kint64max, elements);
+  EXPECT_EQ(s.code(), error::FAILED_PRECONDITION) << s;
+  ASSERT_LE(elements.size(), 5u);
+  EXPECT_EQ(elements, Range(elements.size()));
+}
+
 }  // namespace data
 }  // namespace tensorflow
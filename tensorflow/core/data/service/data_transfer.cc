@@ -47,6 +47,23 @@ DataTransferClientFactories& transfer_client_factories() {
 }
 }  // namespace
 
+Status DataTransferClient::GetElements(const GetElementsRequest& req,
+                                       GetElementsResponse& resp) {
+  GetElementRequest element_req;
+  element_req.set_task_id(req.task_id());
+  for (int64 i = 0; i < req.max_elements(); ++i) {
+    GetElementResponse element_resp;
+    TF_RETURN_IF_ERROR(GetElement(element_req, element_resp));
+    if (element_resp.end_of_sequence()) {
+      resp.set_end_of_sequence(true);
+      break;
+    }
+    resp.add_compressed_elements()->Swap(
+        element_resp.mutable_compressed_element());
+  }
+  return Status::OK();
+}
+
 void DataTransferServer::Register(
     std::string name,
     std::function<std::shared_ptr<DataTransferServer>(GetElementT)> factory) {
@@ -42,6 +42,12 @@ class DataTransferClient {
   virtual Status GetElement(const GetElementRequest& req,
                             GetElementResponse& resp) = 0;
 
+  // Fetches up to `req.max_elements()` elements. Transports that can batch
+  // elements into one round trip should override this; the default fetches
+  // the elements one at a time with `GetElement`.
+  virtual Status GetElements(const GetElementsRequest& req,
+                             GetElementsResponse& resp);
+
   // Makes a best effort to cancel all outstanding calls in progress for the
   // client, and causes further calls to return Cancelled status.
   virtual void TryCancel() = 0;
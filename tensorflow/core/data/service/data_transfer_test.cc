@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/data_transfer.h"
 
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
@@ -49,6 +52,55 @@ TEST(DataTransferTest, RegisterDataTransferServerBuilder) {
   EXPECT_TRUE(called);
 }
 
+// Client which produces `num_elements` elements whose data is their index.
+class TestDataTransferClient : public DataTransferClient {
+ public:
+  explicit TestDataTransferClient(int64 num_elements)
+      : num_elements_(num_elements) {}
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResponse& resp) override {
+    if (next_element_ >= num_elements_) {
+      resp.set_end_of_sequence(true);
+      return Status::OK();
+    }
+    resp.mutable_compressed_element()->set_data(
+        absl::StrCat(next_element_++));
+    return Status::OK();
+  }
+
+  void TryCancel() override {}
+
+ private:
+  const int64 num_elements_;
+  int64 next_element_ = 0;
+};
+
+TEST(DataTransferTest, DefaultGetElements) {
+  DataTransferClient::Register(
+      "test_batching", [](DataTransferClient::Config config,
+                          std::unique_ptr<DataTransferClient>* out) {
+        *out = absl::make_unique<TestDataTransferClient>(/*num_elements=*/5);
+        return Status::OK();
+      });
+  std::unique_ptr<DataTransferClient> client;
+  TF_ASSERT_OK(DataTransferClient::Build("test_batching", {}, &client));
+
+  GetElementsRequest req;
+  req.set_max_elements(3);
+  GetElementsResponse resp;
+  TF_ASSERT_OK(client->GetElements(req, resp));
+  ASSERT_EQ(resp.compressed_elements_size(), 3);
+  EXPECT_EQ(resp.compressed_elements(2).data(), "2");
+  EXPECT_FALSE(resp.end_of_sequence());
+
+  resp.Clear();
+  TF_ASSERT_OK(client->GetElements(req, resp));
+  ASSERT_EQ(resp.compressed_elements_size(), 2);
+  EXPECT_EQ(resp.compressed_elements(0).data(), "3");
+  EXPECT_TRUE(resp.end_of_sequence());
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/dispatcher_impl.h"
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <tuple>
 #include <utility>
@@ -54,6 +56,13 @@ namespace {
 constexpr char kJournalDir[] = "tf_data_dispatcher_journal";
 // The name of the datasets directory inside the dispatcher's working directory.
 constexpr char kDatasetsDir[] = "datasets";
+// Default number of journaled updates between journal snapshots.
+constexpr int64 kDefaultJournalUpdatesPerSnapshot = 10000;
+// Workers reporting a CPU utilization above this threshold are not assigned
+// new distributed epoch tasks.
+constexpr double kOverloadedCpuUtilization = 0.9;
+// The CPU utilization that the recommended number of workers is sized for.
+constexpr double kTargetCpuUtilization = 0.7;
 
 constexpr std::array<const char*, 8> kNodeNameSharingOps = {
     "HashTable",
@@ -168,6 +177,7 @@ Status DataServiceDispatcherImpl::Start() {
   } else {
     while (!end_of_journal) {
       TF_RETURN_IF_ERROR(ApplyWithoutJournaling(update));
+      ++updates_since_snapshot_;
       TF_RETURN_IF_ERROR(reader.Read(update, end_of_journal));
     }
   }
@@ -180,6 +190,7 @@ Status DataServiceDispatcherImpl::Start() {
   // Initialize the journal writer in `Start` so that we fail fast in case it
   // can't be initialized.
   TF_RETURN_IF_ERROR(journal_writer_.value()->EnsureInitialized());
+  MaybeSnapshotJournal();
   started_ = true;
   return Status::OK();
 }
@@ -209,6 +220,7 @@ Status DataServiceDispatcherImpl::WorkerHeartbeat(
           << request->worker_address();
   mutex_lock l(mu_);
   const std::string& worker_address = request->worker_address();
+  worker_loads_[worker_address] = request->load();
   std::vector<std::shared_ptr<const Task>> correct_tasks;
   Status s = state_.TasksForWorker(worker_address, correct_tasks);
   if (!s.ok()) {
@@ -223,6 +235,10 @@ Status DataServiceDispatcherImpl::WorkerHeartbeat(
     TF_RETURN_IF_ERROR(Apply(update));
     TF_RETURN_IF_ERROR(CreateTasksForWorker(worker_address));
     TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, correct_tasks));
+  } else if (deferred_jobs_.contains(worker_address) &&
+             !IsOverloaded(worker_address)) {
+    TF_RETURN_IF_ERROR(CreateDeferredTasks(worker_address));
+    TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, correct_tasks));
   }
 
   absl::flat_hash_set<int64> current_tasks;
@@ -276,7 +292,14 @@ Status DataServiceDispatcherImpl::WorkerUpdate(
   for (auto& update : request->updates()) {
     int64 task_id = update.task_id();
     std::shared_ptr<const Task> task;
-    TF_RETURN_IF_ERROR(state_.TaskFromId(task_id, task));
+    Status s = state_.TaskFromId(task_id, task);
+    if (errors::IsNotFound(s) && update.completed()) {
+      // Tasks of finished jobs are dropped when the journal is snapshotted.
+      VLOG(1) << "Received completion update for unknown task " << task_id
+              << " on worker " << request->worker_address();
+      continue;
+    }
+    TF_RETURN_IF_ERROR(s);
     if (update.completed()) {
       if (task->finished) {
         VLOG(1) << "Received completion update for already-finished task "
@@ -567,9 +590,27 @@ Status DataServiceDispatcherImpl::CreateTasksForJob(
     std::vector<std::shared_ptr<const Task>>& tasks)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   std::vector<std::shared_ptr<const Worker>> workers = state_.ListWorkers();
+  // Only distributed epoch jobs can run with a subset of the workers, since
+  // their splits are shared between whichever tasks exist.
+  bool can_defer = false;
+  if (job->processing_mode == ProcessingMode::DISTRIBUTED_EPOCH &&
+      !job->num_consumers.has_value()) {
+    for (const auto& worker : workers) {
+      if (!IsOverloaded(worker->address)) {
+        can_defer = true;
+        break;
+      }
+    }
+  }
   tasks.clear();
   tasks.reserve(workers.size());
   for (const auto& worker : workers) {
+    if (can_defer && IsOverloaded(worker->address)) {
+      VLOG(1) << "Deferring task for job " << job->job_id << " on worker "
+              << worker->address << " because the worker is overloaded";
+      deferred_jobs_[worker->address].insert(job->job_id);
+      continue;
+    }
     std::shared_ptr<const Task> task;
     TF_RETURN_IF_ERROR(CreateTask(job, worker->address, task));
     tasks.push_back(task);
@@ -577,6 +618,60 @@ Status DataServiceDispatcherImpl::CreateTasksForJob(
   return Status::OK();
 }
 
+Status DataServiceDispatcherImpl::CreateDeferredTasks(
+    const std::string& worker_address) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  auto it = deferred_jobs_.find(worker_address);
+  if (it == deferred_jobs_.end()) {
+    return Status::OK();
+  }
+  absl::flat_hash_set<int64> job_ids = std::move(it->second);
+  deferred_jobs_.erase(it);
+  for (int64 job_id : job_ids) {
+    std::shared_ptr<const Job> job;
+    TF_RETURN_IF_ERROR(state_.JobFromId(job_id, job));
+    if (job->finished) {
+      continue;
+    }
+    VLOG(1) << "Creating deferred task for job " << job_id << " on worker "
+            << worker_address;
+    std::shared_ptr<const Task> task;
+    TF_RETURN_IF_ERROR(CreateTask(job, worker_address, task));
+  }
+  return Status::OK();
+}
+
+bool DataServiceDispatcherImpl::IsOverloaded(const std::string& worker_address)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  auto it = worker_loads_.find(worker_address);
+  return it != worker_loads_.end() &&
+         it->second.cpu_utilization_measured() &&
+         it->second.cpu_utilization() > kOverloadedCpuUtilization;
+}
+
+int64 DataServiceDispatcherImpl::RecommendedNumWorkers()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<std::shared_ptr<const Worker>> workers = state_.ListWorkers();
+  double total_cpu_utilization = 0.0;
+  int64 num_reporting_workers = 0;
+  for (const auto& worker : workers) {
+    auto it = worker_loads_.find(worker->address);
+    if (it == worker_loads_.end() || !it->second.cpu_utilization_measured()) {
+      continue;
+    }
+    total_cpu_utilization += it->second.cpu_utilization();
+    ++num_reporting_workers;
+  }
+  if (num_reporting_workers == 0) {
+    return workers.size();
+  }
+  // Workers which haven't reported a measured load yet are assumed to be as
+  // loaded as the average reporting worker.
+  total_cpu_utilization *=
+      static_cast<double>(workers.size()) / num_reporting_workers;
+  return std::max<int64>(
+      1, std::ceil(total_cpu_utilization / kTargetCpuUtilization));
+}
+
 Status DataServiceDispatcherImpl::CreatePendingTask(
     std::shared_ptr<const Job> job, const std::string& worker_address)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -776,7 +871,12 @@ Status DataServiceDispatcherImpl::GetWorkers(const GetWorkersRequest* request,
   for (const auto& worker : workers) {
     WorkerInfo* info = response->add_workers();
     info->set_address(worker->address);
+    auto it = worker_loads_.find(worker->address);
+    if (it != worker_loads_.end()) {
+      *info->mutable_load() = it->second;
+    }
   }
+  response->set_recommended_num_workers(RecommendedNumWorkers());
   VLOG(3) << "Returning list of " << response->workers_size()
           << " workers from GetWorkers";
   return Status::OK();
@@ -811,8 +911,34 @@ Status DataServiceDispatcherImpl::Apply(const Update& update)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   if (journal_writer_.has_value()) {
     TF_RETURN_IF_ERROR(journal_writer_.value()->Write(update));
+    ++updates_since_snapshot_;
   }
-  return state_.Apply(update);
+  TF_RETURN_IF_ERROR(state_.Apply(update));
+  MaybeSnapshotJournal();
+  return Status::OK();
+}
+
+void DataServiceDispatcherImpl::MaybeSnapshotJournal()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  int64 updates_per_snapshot = config_.journal_updates_per_snapshot();
+  if (updates_per_snapshot <= 0) {
+    updates_per_snapshot = kDefaultJournalUpdatesPerSnapshot;
+  }
+  if (!journal_writer_.has_value() ||
+      updates_since_snapshot_ < updates_per_snapshot) {
+    return;
+  }
+  std::vector<Update> snapshot = state_.Snapshot();
+  Status s = journal_writer_.value()->Compact(snapshot);
+  if (!s.ok()) {
+    // The journal is still complete, just longer than it needs to be.
+    LOG(WARNING) << "Failed to snapshot the dispatcher journal: " << s;
+    return;
+  }
+  VLOG(1) << "Replaced " << updates_since_snapshot_
+          << " journaled updates with a snapshot of " << snapshot.size()
+          << " updates";
+  updates_since_snapshot_ = 0;
 }
 
 void DataServiceDispatcherImpl::JobGcThread() {
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_DISPATCHER_IMPL_H_
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/data_service.h"
 #include "tensorflow/core/data/service/dataset_store.h"
@@ -183,11 +184,24 @@ class DataServiceDispatcherImpl {
       int64& job_client_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Creates one task for each worker, for the given job. The created tasks are
   // stored in `tasks`. This method only updates dispatcher metadata with the
-  // new tasks, but doesn't assign the tasks to the workers.
+  // new tasks, but doesn't assign the tasks to the workers. For distributed
+  // epoch jobs, tasks for overloaded workers are deferred until the worker
+  // reports a lower load, as long as at least one worker gets a task.
   Status CreateTasksForJob(
       std::shared_ptr<const DispatcherState::Job> job,
       std::vector<std::shared_ptr<const DispatcherState::Task>>& tasks)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Creates the tasks deferred for `worker_address` by `CreateTasksForJob`
+  // once the worker is no longer overloaded.
+  Status CreateDeferredTasks(const std::string& worker_address)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns whether the most recent load reported by the worker is above the
+  // threshold for assigning it new distributed epoch tasks.
+  bool IsOverloaded(const std::string& worker_address)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns the number of workers needed to serve the reported load at the
+  // target CPU utilization.
+  int64 RecommendedNumWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Creates a pending task for a round robin job. All consumers need to agree
   // on which round to add the task in before the pending task can be promoted
@@ -223,6 +237,9 @@ class DataServiceDispatcherImpl {
   // used when recovering state when the dispatcher starts.
   Status ApplyWithoutJournaling(const Update& update)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Replaces the journal with a snapshot of `state_` once enough updates have
+  // been journaled since the previous snapshot.
+  void MaybeSnapshotJournal() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // A thread which periodically checks for jobs to clean up.
   void JobGcThread();
   // Scans for old jobs and marks them as finished.
@@ -257,9 +274,19 @@ class DataServiceDispatcherImpl {
   // Mapping from round robin job id to the round the job is currently on. This
   // is based on the data provided by client heartbeats, and may be stale.
   absl::flat_hash_map<int64, int64> round_robin_rounds_ TF_GUARDED_BY(mu_);
+  // Mapping from worker address to the load reported in the worker's latest
+  // heartbeat. Loads are not journaled, since workers report them regularly.
+  absl::flat_hash_map<std::string, WorkerLoad> worker_loads_
+      TF_GUARDED_BY(mu_);
+  // Mapping from worker address to ids of jobs whose task for the worker was
+  // deferred because the worker was overloaded.
+  absl::flat_hash_map<std::string, absl::flat_hash_set<int64>> deferred_jobs_
+      TF_GUARDED_BY(mu_);
 
   absl::optional<std::unique_ptr<JournalWriter>> journal_writer_
       TF_GUARDED_BY(mu_);
+  // Number of updates in the journal since its latest snapshot.
+  int64 updates_since_snapshot_ TF_GUARDED_BY(mu_) = 0;
   DispatcherState state_ TF_GUARDED_BY(mu_);
   // Condition variable for waking up the job gc thread.
   condition_variable job_gc_thread_cv_;
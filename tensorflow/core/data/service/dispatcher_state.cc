@@ -57,6 +57,12 @@ Status DispatcherState::Apply(const Update& update) {
     case Update::kFinishTask:
       FinishTask(update.finish_task());
       break;
+    case Update::kReserveIds:
+      ReserveIds(update.reserve_ids());
+      break;
+    case Update::kRestoreJobProgress:
+      RestoreJobProgress(update.restore_job_progress());
+      break;
     case Update::UPDATE_TYPE_NOT_SET:
       return errors::Internal("Update type not set.");
   }
@@ -191,6 +197,7 @@ void DispatcherState::CreateTask(const CreateTaskUpdate& create_task) {
   DCHECK_NE(job, nullptr);
   task = std::make_shared<Task>(task_id, job, create_task.worker_address(),
                                 create_task.transfer_address());
+  task->starting_round = create_task.starting_round();
   tasks_by_job_[create_task.job_id()].push_back(task);
   tasks_by_worker_[create_task.worker_address()][task->task_id] = task;
   next_available_task_id_ = std::max(next_available_task_id_, task_id + 1);
@@ -213,6 +220,144 @@ void DispatcherState::FinishTask(const FinishTaskUpdate& finish_task) {
   jobs_[task->job->job_id]->finished = all_finished;
 }
 
+void DispatcherState::ReserveIds(const ReserveIdsUpdate& reserve_ids) {
+  next_available_dataset_id_ =
+      std::max(next_available_dataset_id_, reserve_ids.next_dataset_id());
+  next_available_job_id_ =
+      std::max(next_available_job_id_, reserve_ids.next_job_id());
+  next_available_job_client_id_ =
+      std::max(next_available_job_client_id_, reserve_ids.next_job_client_id());
+  next_available_task_id_ =
+      std::max(next_available_task_id_, reserve_ids.next_task_id());
+}
+
+void DispatcherState::RestoreJobProgress(
+    const RestoreJobProgressUpdate& restore_job_progress) {
+  std::shared_ptr<Job> job = jobs_[restore_job_progress.job_id()];
+  DCHECK(job);
+  if (job->distributed_epoch_state.has_value()) {
+    job->distributed_epoch_state->repetition =
+        restore_job_progress.repetition();
+    job->distributed_epoch_state->split_provider_index =
+        restore_job_progress.split_provider_index();
+  }
+  job->last_client_released_micros =
+      restore_job_progress.last_client_released_micros();
+}
+
+std::vector<Update> DispatcherState::Snapshot() const {
+  std::vector<Update> updates;
+  Update update;
+  ReserveIdsUpdate* reserve_ids = update.mutable_reserve_ids();
+  reserve_ids->set_next_dataset_id(next_available_dataset_id_);
+  reserve_ids->set_next_job_id(next_available_job_id_);
+  reserve_ids->set_next_job_client_id(next_available_job_client_id_);
+  reserve_ids->set_next_task_id(next_available_task_id_);
+  updates.push_back(update);
+
+  for (const auto& it : datasets_by_id_) {
+    Update update;
+    RegisterDatasetUpdate* register_dataset = update.mutable_register_dataset();
+    register_dataset->set_dataset_id(it.second->dataset_id);
+    register_dataset->set_fingerprint(it.second->fingerprint);
+    updates.push_back(update);
+  }
+  for (const auto& it : workers_) {
+    Update update;
+    RegisterWorkerUpdate* register_worker = update.mutable_register_worker();
+    register_worker->set_worker_address(it.second->address);
+    register_worker->set_transfer_address(it.second->transfer_address);
+    updates.push_back(update);
+  }
+
+  std::vector<Update> finish_tasks;
+  for (const auto& it : jobs_) {
+    const Job& job = *it.second;
+    if (job.finished && job.num_clients == 0 &&
+        !job.named_job_key.has_value()) {
+      continue;
+    }
+    Update update;
+    CreateJobUpdate* create_job = update.mutable_create_job();
+    create_job->set_job_id(job.job_id);
+    create_job->set_dataset_id(job.dataset_id);
+    create_job->set_processing_mode(ProcessingModeDef(job.processing_mode));
+    if (job.named_job_key.has_value()) {
+      NamedJobKeyDef* key = create_job->mutable_named_job_key();
+      key->set_name(job.named_job_key->name);
+      key->set_index(job.named_job_key->index);
+    }
+    if (job.num_consumers.has_value()) {
+      create_job->set_num_consumers(job.num_consumers.value());
+    }
+    updates.push_back(update);
+
+    Update progress_update;
+    RestoreJobProgressUpdate* progress =
+        progress_update.mutable_restore_job_progress();
+    progress->set_job_id(job.job_id);
+    if (job.distributed_epoch_state.has_value()) {
+      progress->set_repetition(job.distributed_epoch_state->repetition);
+      progress->set_split_provider_index(
+          job.distributed_epoch_state->split_provider_index);
+    }
+    progress->set_last_client_released_micros(
+        job.last_client_released_micros);
+    updates.push_back(progress_update);
+
+    auto tasks = tasks_by_job_.find(job.job_id);
+    if (tasks != tasks_by_job_.end()) {
+      for (const auto& task : tasks->second) {
+        Update update;
+        CreateTaskUpdate* create_task = update.mutable_create_task();
+        create_task->set_task_id(task->task_id);
+        create_task->set_job_id(job.job_id);
+        create_task->set_worker_address(task->worker_address);
+        create_task->set_transfer_address(task->transfer_address);
+        create_task->set_starting_round(task->starting_round);
+        updates.push_back(update);
+        if (task->finished) {
+          Update finish_task;
+          finish_task.mutable_finish_task()->set_task_id(task->task_id);
+          finish_tasks.push_back(finish_task);
+        }
+      }
+    }
+    // Pending tasks restart their agreement with the job's consumers.
+    std::queue<PendingTask> pending_tasks = job.pending_tasks;
+    for (; !pending_tasks.empty(); pending_tasks.pop()) {
+      const PendingTask& pending_task = pending_tasks.front();
+      Update update;
+      CreatePendingTaskUpdate* create_pending_task =
+          update.mutable_create_pending_task();
+      create_pending_task->set_task_id(pending_task.task->task_id);
+      create_pending_task->set_job_id(job.job_id);
+      create_pending_task->set_worker_address(
+          pending_task.task->worker_address);
+      create_pending_task->set_transfer_address(
+          pending_task.task->transfer_address);
+      create_pending_task->set_starting_round(pending_task.target_round);
+      updates.push_back(update);
+    }
+  }
+  for (const auto& it : jobs_for_client_ids_) {
+    // `JobForJobClientId` leaves null entries for unknown client ids.
+    if (!it.second) {
+      continue;
+    }
+    Update update;
+    AcquireJobClientUpdate* acquire_job_client =
+        update.mutable_acquire_job_client();
+    acquire_job_client->set_job_client_id(it.first);
+    acquire_job_client->set_job_id(it.second->job_id);
+    updates.push_back(update);
+  }
+  // Tasks are finished after all of their job's tasks exist, so that the
+  // job's `finished` bit is recomputed correctly.
+  updates.insert(updates.end(), finish_tasks.begin(), finish_tasks.end());
+  return updates;
+}
+
 int64 DispatcherState::NextAvailableDatasetId() const {
   return next_available_dataset_id_;
 }
@@ -60,6 +60,13 @@ class DispatcherState {
   // Applies the given update to the dispatcher's state.
   Status Apply(const Update& update);
 
+  // Returns a sequence of updates which, applied to an empty state, recreate
+  // this state, except that finished jobs without a name or clients are left
+  // out. The snapshot is proportional to the size of the state rather than to
+  // the number of updates applied so far, so it is used to compact the
+  // journal.
+  std::vector<Update> Snapshot() const;
+
   // A dataset registered with the dispatcher.
   struct Dataset {
     explicit Dataset(int64 dataset_id, int64 fingerprint)
@@ -220,6 +227,9 @@ class DispatcherState {
   void ClientHeartbeat(const ClientHeartbeatUpdate& client_heartbeat);
   void CreateTask(const CreateTaskUpdate& create_task);
   void FinishTask(const FinishTaskUpdate& finish_task);
+  void ReserveIds(const ReserveIdsUpdate& reserve_ids);
+  void RestoreJobProgress(
+      const RestoreJobProgressUpdate& restore_job_progress);
 
   int64 next_available_dataset_id_ = 1000;
   // Registered datasets, keyed by dataset ids.
@@ -473,5 +473,54 @@ TEST(DispatcherState, ReleaseJobClientId) {
   EXPECT_EQ(s.code(), error::NOT_FOUND);
 }
 
+TEST(DispatcherState, Snapshot) {
+  int64 dataset_id = 10;
+  int64 finished_job_id = 3;
+  int64 running_job_id = 4;
+  int64 job_client_id = 6;
+  std::string worker_address = "test_worker_address";
+  DispatcherState state;
+  TF_EXPECT_OK(RegisterDataset(dataset_id, state));
+  TF_EXPECT_OK(RegisterWorker(worker_address, state));
+  TF_EXPECT_OK(CreateAnonymousJob(finished_job_id, dataset_id, state));
+  TF_EXPECT_OK(CreateTask(/*task_id=*/7, finished_job_id, worker_address,
+                          state));
+  TF_EXPECT_OK(FinishTask(/*task_id=*/7, state));
+  TF_EXPECT_OK(CreateAnonymousJob(running_job_id, dataset_id, state));
+  TF_EXPECT_OK(AcquireJobClientId(running_job_id, job_client_id, state));
+  TF_EXPECT_OK(CreateTask(/*task_id=*/8, running_job_id, worker_address,
+                          state));
+  TF_EXPECT_OK(CreateTask(/*task_id=*/9, running_job_id, worker_address,
+                          state));
+  TF_EXPECT_OK(FinishTask(/*task_id=*/8, state));
+
+  DispatcherState restored;
+  for (const auto& update : state.Snapshot()) {
+    TF_EXPECT_OK(restored.Apply(update));
+  }
+  EXPECT_EQ(restored.NextAvailableDatasetId(), state.NextAvailableDatasetId());
+  EXPECT_EQ(restored.NextAvailableJobId(), state.NextAvailableJobId());
+  EXPECT_EQ(restored.NextAvailableJobClientId(),
+            state.NextAvailableJobClientId());
+  EXPECT_EQ(restored.NextAvailableTaskId(), state.NextAvailableTaskId());
+  std::shared_ptr<const Dataset> dataset;
+  TF_EXPECT_OK(restored.DatasetFromId(dataset_id, dataset));
+  EXPECT_THAT(restored.ListWorkers(), SizeIs(1));
+  // The finished job is dropped.
+  std::shared_ptr<const Job> job;
+  EXPECT_TRUE(errors::IsNotFound(restored.JobFromId(finished_job_id, job)));
+  TF_EXPECT_OK(restored.JobForJobClientId(job_client_id, job));
+  EXPECT_EQ(job->job_id, running_job_id);
+  EXPECT_EQ(job->num_clients, 1);
+  EXPECT_FALSE(job->finished);
+  std::vector<std::shared_ptr<const Task>> tasks;
+  TF_EXPECT_OK(restored.TasksForJob(running_job_id, tasks));
+  EXPECT_THAT(tasks, SizeIs(2));
+  tasks.clear();
+  TF_EXPECT_OK(restored.TasksForWorker(worker_address, tasks));
+  ASSERT_THAT(tasks, SizeIs(1));
+  EXPECT_EQ(tasks[0]->task_id, 9);
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -39,12 +39,21 @@ Status WrapError(const std::string& message, const ::grpc::Status& status) {
 
 Status Retry(const std::function<Status()>& f, const std::string& description,
              int64 deadline_micros) {
+  return Retry(f, [] { return true; }, description, deadline_micros);
+}
+
+Status Retry(const std::function<Status()>& f,
+             const std::function<bool()>& should_retry,
+             const std::string& description, int64 deadline_micros) {
   Status s = f();
   for (int num_retries = 0;; ++num_retries) {
     if (!errors::IsUnavailable(s) && !errors::IsAborted(s) &&
         !errors::IsCancelled(s)) {
       return s;
     }
+    if (!should_retry()) {
+      return s;
+    }
     int64 now_micros = EnvTime::NowMicros();
     if (now_micros > deadline_micros) {
       return s;
@@ -62,6 +71,9 @@ Status Retry(const std::function<Status()>& f, const std::string& description,
                 << ". Will retry in " << wait_time_micros / 1000 << "ms.";
     }
     Env::Default()->SleepForMicroseconds(wait_time_micros);
+    if (!should_retry()) {
+      return s;
+    }
     s = f();
   }
   return s;
@@ -36,6 +36,11 @@ Status WrapError(const std::string& message, const ::grpc::Status& status);
 Status Retry(const std::function<Status()>& f, const std::string& description,
              int64 deadline_micros);
 
+// Same as `Retry` above, but only retries while `should_retry` returns true.
+Status Retry(const std::function<Status()>& f,
+             const std::function<bool()>& should_retry,
+             const std::string& description, int64 deadline_micros);
+
 }  // namespace grpc_util
 }  // namespace data
 }  // namespace tensorflow
@@ -34,6 +34,19 @@ TEST(GrpcUtil, WrapOk) {
                                       "message: wrapping message"));
 }
 
+TEST(GrpcUtil, RetryStopsWhenShouldRetryIsFalse) {
+  int num_calls = 0;
+  Status s = Retry(
+      [&num_calls] {
+        ++num_calls;
+        return errors::Unavailable("unavailable");
+      },
+      [&num_calls] { return num_calls < 2; }, "test",
+      /*deadline_micros=*/kint64max);
+  EXPECT_TRUE(errors::IsUnavailable(s));
+  EXPECT_EQ(num_calls, 2);
+}
+
 }  // namespace grpc_util
 }  // namespace data
 }  // namespace tensorflow
@@ -29,14 +29,17 @@ namespace data {
 
 namespace {
 constexpr StringPiece kJournal = "journal";
-
-Status ParseSequenceNumber(const std::string& journal_file,
-                           int64* sequence_number) {
-  if (!RE2::FullMatch(journal_file, ".*_(\\d+)", sequence_number)) {
-    return errors::InvalidArgument("Failed to parse journal file name: ",
-                                   journal_file);
-  }
-  return Status::OK();
+constexpr StringPiece kSnapshot = "snapshot";
+// Suffix for snapshots which are still being written.
+constexpr StringPiece kTempSuffix = ".tmp";
+
+// Parses the name of a journal file or snapshot into its kind ("journal" or
+// "snapshot") and sequence number. Returns false for other files, such as
+// partially written snapshots.
+bool ParseFileName(const std::string& filename, std::string* kind,
+                   int64* sequence_number) {
+  return RE2::FullMatch(filename, "(journal|snapshot)_(\\d+)", kind,
+                        sequence_number);
 }
 }  // namespace
 
@@ -46,6 +49,12 @@ std::string DataServiceJournalFile(const std::string& journal_dir,
                       absl::StrCat(kJournal, "_", sequence_number));
 }
 
+std::string DataServiceJournalSnapshotFile(const std::string& journal_dir,
+                                           int64 sequence_number) {
+  return io::JoinPath(journal_dir,
+                      absl::StrCat(kSnapshot, "_", sequence_number));
+}
+
 FileJournalWriter::FileJournalWriter(Env* env, const std::string& journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
@@ -58,18 +67,68 @@ Status FileJournalWriter::EnsureInitialized() {
   TF_RETURN_IF_ERROR(env_->GetChildren(journal_dir_, &journal_files));
   int64 latest_sequence_number = -1;
   for (const auto& file : journal_files) {
+    std::string kind;
     int64 sequence_number;
-    TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &sequence_number));
+    if (!ParseFileName(file, &kind, &sequence_number)) {
+      continue;
+    }
     latest_sequence_number = std::max(latest_sequence_number, sequence_number);
   }
+  return OpenFile(latest_sequence_number + 1);
+}
+
+Status FileJournalWriter::OpenFile(int64 sequence_number) {
   std::string journal_file =
-      DataServiceJournalFile(journal_dir_, latest_sequence_number + 1);
+      DataServiceJournalFile(journal_dir_, sequence_number);
   TF_RETURN_IF_ERROR(env_->NewAppendableFile(journal_file, &file_));
   writer_ = absl::make_unique<io::RecordWriter>(file_.get());
+  sequence_number_ = sequence_number;
   VLOG(1) << "Created journal writer to write to " << journal_file;
   return Status::OK();
 }
 
+Status FileJournalWriter::Compact(const std::vector<Update>& snapshot) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  // Move on to a new journal file, so that everything written so far is in
+  // files with lower sequence numbers than the snapshot.
+  TF_RETURN_IF_ERROR(writer_->Close());
+  writer_.reset();
+  TF_RETURN_IF_ERROR(file_->Close());
+  int64 sequence_number = sequence_number_ + 1;
+  TF_RETURN_IF_ERROR(OpenFile(sequence_number));
+
+  std::string snapshot_file =
+      DataServiceJournalSnapshotFile(journal_dir_, sequence_number);
+  std::string temp_file = absl::StrCat(snapshot_file, kTempSuffix);
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env_->NewWritableFile(temp_file, &file));
+  io::RecordWriter writer(file.get());
+  for (const auto& update : snapshot) {
+    TF_RETURN_IF_ERROR(writer.WriteRecord(update.SerializeAsString()));
+  }
+  TF_RETURN_IF_ERROR(writer.Close());
+  TF_RETURN_IF_ERROR(file->Sync());
+  TF_RETURN_IF_ERROR(file->Close());
+  // Readers only look at complete snapshots, so the rename makes the
+  // snapshot take effect atomically.
+  TF_RETURN_IF_ERROR(env_->RenameFile(temp_file, snapshot_file));
+
+  std::vector<std::string> files;
+  TF_RETURN_IF_ERROR(env_->GetChildren(journal_dir_, &files));
+  for (const auto& filename : files) {
+    std::string kind;
+    int64 file_sequence_number;
+    if (ParseFileName(filename, &kind, &file_sequence_number) &&
+        file_sequence_number < sequence_number) {
+      TF_RETURN_IF_ERROR(
+          env_->DeleteFile(io::JoinPath(journal_dir_, filename)));
+    }
+  }
+  VLOG(1) << "Compacted journal into " << snapshot.size() << " updates in "
+          << snapshot_file;
+  return Status::OK();
+}
+
 Status FileJournalWriter::Write(const Update& update) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
   std::string s = update.SerializeAsString();
@@ -93,6 +152,24 @@ Status FileJournalReader::EnsureInitialized() {
   if (reader_) {
     return Status::OK();
   }
+  std::vector<std::string> files;
+  TF_RETURN_IF_ERROR(env_->GetChildren(journal_dir_, &files));
+  int64 latest_snapshot = -1;
+  for (const auto& filename : files) {
+    std::string kind;
+    int64 sequence_number;
+    if (ParseFileName(filename, &kind, &sequence_number) &&
+        kind == kSnapshot) {
+      latest_snapshot = std::max(latest_snapshot, sequence_number);
+    }
+  }
+  if (latest_snapshot >= 0) {
+    // Read the snapshot first, then continue with the journal file it is
+    // numbered after.
+    sequence_number_ = latest_snapshot - 1;
+    return UpdateFile(
+        DataServiceJournalSnapshotFile(journal_dir_, latest_snapshot));
+  }
   return UpdateFile(DataServiceJournalFile(journal_dir_, 0));
 }
 
@@ -28,6 +28,11 @@ namespace data {
 std::string DataServiceJournalFile(const std::string& journal_dir,
                                    int64 sequence_number);
 
+// Returns the location of the snapshot which replaces all journal files with
+// sequence numbers below `sequence_number`.
+std::string DataServiceJournalSnapshotFile(const std::string& journal_dir,
+                                           int64 sequence_number);
+
 // Interface for writing to a journal.
 class JournalWriter {
  public:
@@ -36,6 +41,9 @@ class JournalWriter {
   virtual Status Write(const Update& update) = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
+  // Replaces everything written to the journal so far with `snapshot`, a
+  // sequence of updates which produces the same state.
+  virtual Status Compact(const std::vector<Update>& snapshot) = 0;
 };
 
 // FileJournalWriter is not thread-safe, requiring external synchronization when
@@ -45,8 +53,9 @@ class JournalWriter {
 // directory is laid out in the following format:
 //
 // journal_dir/
-//   journal_0
-//   journal_1
+//   snapshot_2
+//   journal_2
+//   journal_3
 //   ...
 //
 // When the writer is created, it lists the directory to find the next available
@@ -54,6 +63,11 @@ class JournalWriter {
 // "journal_0", "journal_1", and "journal_2", the writer will write to
 // "journal_3". The writer will flush updates as they are written, so that they
 // can be stored durably in case of machine failure.
+//
+// `Compact` starts a new journal file, say "journal_4", then atomically writes
+// "snapshot_4" and deletes all journal files and snapshots with lower sequence
+// numbers, so that the journal's size is bounded by the size of the state it
+// describes instead of growing with its history.
 class FileJournalWriter : public JournalWriter {
  public:
   // Creates a journal writer to write to the given journal directory.
@@ -65,10 +79,16 @@ class FileJournalWriter : public JournalWriter {
 
   Status Write(const Update& update) override;
   Status EnsureInitialized() override;
+  Status Compact(const std::vector<Update>& snapshot) override;
 
  private:
+  // Opens the journal file with the given sequence number for writing.
+  Status OpenFile(int64 sequence_number);
+
   Env* env_;
   const std::string journal_dir_;
+  // Sequence number of the journal file being written.
+  int64 sequence_number_ = -1;
   std::unique_ptr<WritableFile> file_;
   std::unique_ptr<io::RecordWriter> writer_;
 };
@@ -85,8 +105,10 @@ class JournalReader {
 // JournalReader is not thread-safe, requiring external synchronization when
 // used by multiple threads.
 //
-// The journal reader reads through all journal files in the configured journal
-// directory, in order of their sequence numbers. See FileJournalWriter above.
+// The journal reader reads the latest snapshot in the configured journal
+// directory, if any, followed by the journal files from the snapshot's
+// sequence number onwards, in order of their sequence numbers. See
+// FileJournalWriter above.
 class FileJournalReader : public JournalReader {
  public:
   explicit FileJournalReader(Env* env, StringPiece journal_dir);
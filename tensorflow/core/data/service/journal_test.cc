@@ -109,6 +109,29 @@ TEST(Journal, AppendExistingJournal) {
   TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
 }
 
+TEST(Journal, Compact) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_EXPECT_OK(writer.Write(MakeCreateJobUpdate()));
+  TF_EXPECT_OK(writer.Write(MakeFinishTaskUpdate()));
+  TF_EXPECT_OK(writer.Compact({MakeRegisterDatasetUpdate()}));
+  TF_EXPECT_OK(writer.Write(MakeFinishTaskUpdate()));
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, {MakeRegisterDatasetUpdate(), MakeFinishTaskUpdate()}));
+
+  // The files replaced by the snapshot are deleted.
+  EXPECT_TRUE(errors::IsNotFound(Env::Default()->FileExists(
+      DataServiceJournalFile(journal_dir, /*sequence_number=*/0))));
+
+  // A new writer continues after the snapshot.
+  FileJournalWriter new_writer(Env::Default(), journal_dir);
+  TF_EXPECT_OK(new_writer.Write(MakeCreateJobUpdate()));
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, {MakeRegisterDatasetUpdate(), MakeFinishTaskUpdate(),
+                    MakeCreateJobUpdate()}));
+}
+
 TEST(Journal, MissingFile) {
   std::string journal_dir;
   EXPECT_TRUE(NewJournalDir(journal_dir));
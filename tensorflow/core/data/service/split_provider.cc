@@ -18,12 +18,17 @@ limitations under the License.
 #include "tensorflow/core/data/service/data_service.h"
 #include "tensorflow/core/data/service/grpc_util.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
 
 namespace tensorflow {
 namespace data {
 
 Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits) {
   mutex_lock l(mu_);
+  if (cancelled_) {
+    return errors::Cancelled("Split provider for job ", job_id_,
+                             " was cancelled");
+  }
   if (!dispatcher_) {
     dispatcher_ =
         absl::make_unique<DataServiceDispatcherClient>(address_, protocol_);
@@ -33,11 +38,13 @@ Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits) {
         return dispatcher_->GetSplit(job_id_, repetition_, *split,
                                      *end_of_splits);
       },
-      "get next split",
+      [this] { return !cancelled_; }, "get next split",
       /*deadline_micros=*/Env::Default()->NowMicros() +
           (timeout_ms_ * EnvTime::kMillisToMicros));
 }
 
+void DataServiceSplitProvider::Cancel() { cancelled_ = true; }
+
 Status DataServiceSplitProvider::Reset() {
   mutex_lock l(mu_);
   repetition_++;
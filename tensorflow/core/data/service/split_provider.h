@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 
+#include <atomic>
 #include <queue>
 
 #include "tensorflow/core/data/service/data_service.h"
@@ -37,6 +38,9 @@ class DataServiceSplitProvider : public SplitProvider {
 
   Status GetNext(Tensor* split, bool* end_of_splits) override;
   Status Reset() override;
+  // Stops retrying failed requests to the dispatcher. Later calls to `GetNext`
+  // fail with a Cancelled error.
+  void Cancel();
   Status Save(std::function<std::string(std::string)> full_name,
               IteratorStateWriter* writer) override;
   Status Restore(std::function<std::string(std::string)> full_name,
@@ -48,6 +52,7 @@ class DataServiceSplitProvider : public SplitProvider {
   const int64 job_id_;
   const int64 timeout_ms_;
 
+  std::atomic<bool> cancelled_{false};
   mutex mu_;
   int64 repetition_ = 0;
   std::unique_ptr<DataServiceDispatcherClient> dispatcher_;
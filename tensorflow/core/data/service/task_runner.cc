@@ -33,7 +33,8 @@ const int64 kTimeoutUs = 60 * 1000 * 1000;  // 1 minute.
 const int64 kWaitBeforeSkipUs = 100 * 1000;  // 100ms.
 
 // Interprets `element` as a size-1 vector containing a CompressedElement, and
-// moves the element into `resp`. Returns an error if `element` is of unexpected
+// moves the element into `resp`. The element's buffer is only copied if it is
+// shared with another tensor. Returns an error if `element` is of unexpected
 // size, type, or shape.
 Status MoveCompressedElement(std::vector<Tensor>&& element,
                              GetElementResponse& resp) {
@@ -63,15 +64,37 @@ Status MoveCompressedElement(std::vector<Tensor>&& element,
         "it produced ",
         variant.TypeName());
   }
-  *resp.mutable_compressed_element() = *compressed;
+  if (element[0].RefCountIsOne()) {
+    resp.mutable_compressed_element()->Swap(compressed);
+  } else {
+    *resp.mutable_compressed_element() = *compressed;
+  }
   return Status::OK();
 }
+
+// Returns the number of bytes held by `element`, counting the serialized size
+// of compressed elements.
+int64 ElementBytes(const std::vector<Tensor>& element) {
+  int64 bytes = 0;
+  for (const Tensor& tensor : element) {
+    const CompressedElement* compressed = nullptr;
+    if (tensor.dtype() == DT_VARIANT &&
+        TensorShapeUtils::IsScalar(tensor.shape())) {
+      compressed = tensor.scalar<Variant>()().get<CompressedElement>();
+    }
+    bytes += compressed ? compressed->ByteSizeLong() : tensor.TotalBytes();
+  }
+  return bytes;
+}
 }  // namespace
 
 StandaloneTaskIterator::StandaloneTaskIterator(
     std::unique_ptr<standalone::Dataset> dataset,
-    std::unique_ptr<standalone::Iterator> iterator)
-    : dataset_(std::move(dataset)), iterator_(std::move(iterator)) {}
+    std::unique_ptr<standalone::Iterator> iterator,
+    std::function<void()> cancel)
+    : dataset_(std::move(dataset)),
+      iterator_(std::move(iterator)),
+      cancel_(std::move(cancel)) {}
 
 Status StandaloneTaskIterator::GetNext(std::vector<Tensor>& element,
                                        bool& end_of_sequence) {
@@ -82,7 +105,15 @@ int64 StandaloneTaskIterator::Cardinality() const {
   return dataset_->Get()->Cardinality();
 }
 
-Status TaskRunner::Create(const TaskDef& task_def,
+void StandaloneTaskIterator::Cancel() {
+  if (cancel_) {
+    cancel_();
+  }
+  dataset_->Cancel();
+}
+
+Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
+                          const TaskDef& task_def,
                           std::unique_ptr<TaskIterator> iterator,
                           std::unique_ptr<TaskRunner>& out) {
   if (task_def.optional_num_consumers_case() == TaskDef::kNumConsumers) {
@@ -98,27 +129,118 @@ Status TaskRunner::Create(const TaskDef& task_def,
     out = absl::make_unique<RoundRobinTaskRunner>(std::move(iterator),
                                                   task_def.num_consumers());
   } else {
-    out =
-        absl::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
+    out = absl::make_unique<FirstComeFirstServedTaskRunner>(
+        std::move(iterator), worker_config.element_prefetch_bytes());
   }
   return Status::OK();
 }
 
 FirstComeFirstServedTaskRunner::FirstComeFirstServedTaskRunner(
-    std::unique_ptr<TaskIterator> iterator)
-    : iterator_(std::move(iterator)) {}
+    std::unique_ptr<TaskIterator> iterator, int64 prefetch_buffer_bytes)
+    : iterator_(std::move(iterator)),
+      prefetch_buffer_bytes_(prefetch_buffer_bytes) {
+  if (prefetch_buffer_bytes_ > 0) {
+    prefetch_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+        {}, "first-come-first-served-prefetch",
+        [this] { RunPrefetchThread(); }));
+  }
+}
+
+FirstComeFirstServedTaskRunner::~FirstComeFirstServedTaskRunner() {
+  if (!prefetch_thread_) {
+    return;
+  }
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    cv_.notify_all();
+  }
+  // Unblocks the prefetch thread if it is waiting for the iterator, then joins
+  // it before the members it uses are destroyed.
+  iterator_->Cancel();
+  prefetch_thread_.reset();
+}
+
+void FirstComeFirstServedTaskRunner::RunPrefetchThread() {
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      while (!cancelled_ && buffered_bytes_ >= prefetch_buffer_bytes_) {
+        cv_.wait(l);
+      }
+      if (cancelled_) {
+        return;
+      }
+    }
+    std::vector<Tensor> element;
+    bool end_of_sequence;
+    Status s = iterator_->GetNext(element, end_of_sequence);
+    mutex_lock l(mu_);
+    if (!s.ok() || end_of_sequence) {
+      status_ = s;
+      end_of_sequence_ = end_of_sequence;
+      cv_.notify_all();
+      return;
+    }
+    const int64 bytes = ElementBytes(element);
+    buffer_.push_back({std::move(element), bytes});
+    buffered_bytes_ += bytes;
+    cv_.notify_all();
+  }
+}
+
+bool FirstComeFirstServedTaskRunner::ElementReady() {
+  return !buffer_.empty() || end_of_sequence_ || !status_.ok();
+}
+
+Status FirstComeFirstServedTaskRunner::PopElement(GetElementResponse& resp) {
+  resp.set_skip_task(false);
+  if (buffer_.empty()) {
+    TF_RETURN_IF_ERROR(status_);
+    resp.set_end_of_sequence(true);
+    return Status::OK();
+  }
+  std::vector<Tensor> element = std::move(buffer_.front().element);
+  buffered_bytes_ -= buffer_.front().bytes;
+  buffer_.pop_front();
+  cv_.notify_all();
+  resp.set_end_of_sequence(false);
+  return MoveCompressedElement(std::move(element), resp);
+}
 
 Status FirstComeFirstServedTaskRunner::GetNext(const GetElementRequest& req,
                                                GetElementResponse& resp) {
-  std::vector<Tensor> element;
-  bool end_of_task;
-  resp.set_skip_task(false);
-  TF_RETURN_IF_ERROR(iterator_->GetNext(element, end_of_task));
-  resp.set_end_of_sequence(end_of_task);
-  if (!end_of_task) {
-    return MoveCompressedElement(std::move(element), resp);
+  if (!prefetch_thread_) {
+    std::vector<Tensor> element;
+    bool end_of_task;
+    resp.set_skip_task(false);
+    TF_RETURN_IF_ERROR(iterator_->GetNext(element, end_of_task));
+    resp.set_end_of_sequence(end_of_task);
+    if (!end_of_task) {
+      return MoveCompressedElement(std::move(element), resp);
+    }
+    return Status::OK();
   }
-  return Status::OK();
+  mutex_lock l(mu_);
+  while (!ElementReady()) {
+    cv_.wait(l);
+  }
+  return PopElement(resp);
+}
+
+Status FirstComeFirstServedTaskRunner::TryGetNext(const GetElementRequest& req,
+                                                  GetElementResponse& resp,
+                                                  bool& ready) {
+  if (!prefetch_thread_) {
+    ready = false;
+    return Status::OK();
+  }
+  mutex_lock l(mu_);
+  ready = ElementReady();
+  if (!ready) {
+    return Status::OK();
+  }
+  return PopElement(resp);
 }
 
 RoundRobinTaskRunner::RoundRobinTaskRunner(
@@ -244,9 +366,15 @@ PrefetchThread::PrefetchThread(std::unique_ptr<TaskIterator> iterator,
 }
 
 PrefetchThread::~PrefetchThread() {
-  mutex_lock l(mu_);
-  cancelled_ = true;
-  cv_.notify_all();
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    cv_.notify_all();
+  }
+  // Unblocks the thread if it is waiting for the iterator, then joins it
+  // before the members it uses are destroyed.
+  iterator_->Cancel();
+  thread_.reset();
 }
 
 void PrefetchThread::Run() {
@@ -317,5 +445,134 @@ Status PrefetchThread::GetStatus() {
   mutex_lock l(mu_);
   return status_;
 }
+
+SlidingWindowCache::SlidingWindowCache(std::unique_ptr<TaskIterator> iterator,
+                                       int64 max_elements)
+    : iterator_(std::move(iterator)), max_elements_(max_elements) {
+  DCHECK_GT(max_elements_, 0);
+}
+
+Status SlidingWindowCache::GetNext(int64 reader_id,
+                                   std::vector<Tensor>& element,
+                                   bool& end_of_sequence) {
+  while (true) {
+    int64 index;
+    {
+      mutex_lock l(mu_);
+      bool ready;
+      TF_RETURN_IF_ERROR(
+          TryGetNextLocked(reader_id, element, end_of_sequence, ready, index));
+      if (ready) {
+        return Status::OK();
+      }
+    }
+    TF_RETURN_IF_ERROR(Produce(index));
+  }
+}
+
+Status SlidingWindowCache::TryGetNext(int64 reader_id,
+                                      std::vector<Tensor>& element,
+                                      bool& end_of_sequence, bool& ready) {
+  mutex_lock l(mu_);
+  int64 index;
+  return TryGetNextLocked(reader_id, element, end_of_sequence, ready, index);
+}
+
+Status SlidingWindowCache::TryGetNextLocked(int64 reader_id,
+                                            std::vector<Tensor>& element,
+                                            bool& end_of_sequence, bool& ready,
+                                            int64& index) {
+  ready = false;
+  TF_RETURN_IF_ERROR(status_);
+  auto it = next_index_.emplace(reader_id, first_index_).first;
+  if (it->second < first_index_) {
+    VLOG(2) << "Reader " << reader_id << " fell behind the cache, skipping "
+            << first_index_ - it->second << " elements";
+    it->second = first_index_;
+  }
+  index = it->second;
+  if (index < first_index_ + static_cast<int64>(elements_.size())) {
+    // Tensors are reference counted, so this doesn't copy buffers.
+    element = elements_[index - first_index_];
+    end_of_sequence = false;
+    ready = true;
+    ++it->second;
+  } else if (end_of_sequence_) {
+    end_of_sequence = true;
+    ready = true;
+  }
+  return Status::OK();
+}
+
+Status SlidingWindowCache::Produce(int64 index) {
+  mutex_lock producer_lock(producer_mu_);
+  {
+    mutex_lock l(mu_);
+    if (index < first_index_ + static_cast<int64>(elements_.size()) ||
+        end_of_sequence_ || !status_.ok()) {
+      // Another reader produced the element while we waited.
+      return Status::OK();
+    }
+  }
+  std::vector<Tensor> element;
+  bool end_of_sequence;
+  Status s = iterator_->GetNext(element, end_of_sequence);
+  mutex_lock l(mu_);
+  if (!s.ok()) {
+    status_ = s;
+    return s;
+  }
+  if (end_of_sequence) {
+    end_of_sequence_ = true;
+    return Status::OK();
+  }
+  elements_.push_back(std::move(element));
+  if (static_cast<int64>(elements_.size()) > max_elements_) {
+    elements_.pop_front();
+    ++first_index_;
+  }
+  return Status::OK();
+}
+
+void SlidingWindowCache::RemoveReader(int64 reader_id) {
+  mutex_lock l(mu_);
+  next_index_.erase(reader_id);
+}
+
+CachingTaskRunner::CachingTaskRunner(std::shared_ptr<SlidingWindowCache> cache,
+                                     int64 task_id)
+    : cache_(std::move(cache)), task_id_(task_id) {}
+
+CachingTaskRunner::~CachingTaskRunner() { cache_->RemoveReader(task_id_); }
+
+Status CachingTaskRunner::GetNext(const GetElementRequest& req,
+                                  GetElementResponse& resp) {
+  std::vector<Tensor> element;
+  bool end_of_task;
+  resp.set_skip_task(false);
+  TF_RETURN_IF_ERROR(cache_->GetNext(task_id_, element, end_of_task));
+  resp.set_end_of_sequence(end_of_task);
+  if (!end_of_task) {
+    return MoveCompressedElement(std::move(element), resp);
+  }
+  return Status::OK();
+}
+
+Status CachingTaskRunner::TryGetNext(const GetElementRequest& req,
+                                     GetElementResponse& resp, bool& ready) {
+  std::vector<Tensor> element;
+  bool end_of_task;
+  resp.set_skip_task(false);
+  TF_RETURN_IF_ERROR(
+      cache_->TryGetNext(task_id_, element, end_of_task, ready));
+  if (!ready) {
+    return Status::OK();
+  }
+  resp.set_end_of_sequence(end_of_task);
+  if (!end_of_task) {
+    return MoveCompressedElement(std::move(element), resp);
+  }
+  return Status::OK();
+}
 }  // namespace data
 }  // namespace tensorflow
@@ -15,10 +15,16 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_TASK_RUNNER_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_TASK_RUNNER_H_
 
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
 
 namespace tensorflow {
 namespace data {
@@ -34,6 +40,9 @@ class TaskIterator {
                          bool& end_of_sequence) = 0;
   // Reports the cardinality of the dataset that created this iterator.
   virtual int64 Cardinality() const = 0;
+  // Cancels the iterator, so that a blocked or later call to `GetNext` returns
+  // promptly, as far as the underlying iterator supports cancellation.
+  virtual void Cancel() {}
 };
 
 // Implementation of TaskIterator wrapping a standalone iterator.
@@ -41,41 +50,157 @@ class StandaloneTaskIterator : public TaskIterator {
  public:
   // `dataset` should be the dataset that created `iterator`.
   // StandaloneTaskIterator takes ownership of the dataset to ensures it
-  // lives as long as `iterator`.
+  // lives as long as `iterator`. If set, `cancel` is called on `Cancel()`, in
+  // addition to cancelling the dataset, e.g. to stop a split provider.
   StandaloneTaskIterator(std::unique_ptr<standalone::Dataset> dataset,
-                         std::unique_ptr<standalone::Iterator> iterator);
+                         std::unique_ptr<standalone::Iterator> iterator,
+                         std::function<void()> cancel = nullptr);
   Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override;
   int64 Cardinality() const override;
+  void Cancel() override;
 
  private:
   std::unique_ptr<standalone::Dataset> dataset_;
   std::unique_ptr<standalone::Iterator> iterator_;
+  const std::function<void()> cancel_;
 };
 
 // Interface for providing elements to task consumers.
 class TaskRunner {
  public:
   // Creates a `TaskRunner` and stores it in `out`.
-  static Status Create(const TaskDef& task_def,
+  static Status Create(const experimental::WorkerConfig& worker_config,
+                       const TaskDef& task_def,
                        std::unique_ptr<TaskIterator> iterator,
                        std::unique_ptr<TaskRunner>& out);
   virtual ~TaskRunner() = default;
   // Gets the next element for the given request.
   virtual Status GetNext(const GetElementRequest& req,
                          GetElementResponse& resp) = 0;
+  // Like `GetNext`, but only fills `resp` if the next element (or the end of
+  // the sequence) is available without waiting, in which case `ready` is set
+  // to `true`. Errors are reported again by later calls. The default
+  // implementation never has an element ready.
+  virtual Status TryGetNext(const GetElementRequest& req,
+                            GetElementResponse& resp, bool& ready) {
+    ready = false;
+    return Status::OK();
+  }
 };
 
 // A task runner which provides elements on a first-come first-served basis.
-// It does not consider which consumer is making the request.
+// It does not consider which consumer is making the request. By default,
+// elements are produced when they are requested. If `prefetch_buffer_bytes` is
+// positive, a background thread produces elements ahead of requests until they
+// take up at least `prefetch_buffer_bytes`, so that requests for several
+// elements can be served without waiting for each one to be produced.
 class FirstComeFirstServedTaskRunner : public TaskRunner {
  public:
   explicit FirstComeFirstServedTaskRunner(
-      std::unique_ptr<TaskIterator> iterator);
+      std::unique_ptr<TaskIterator> iterator, int64 prefetch_buffer_bytes = 0);
+  ~FirstComeFirstServedTaskRunner() override;
+  Status GetNext(const GetElementRequest& req,
+                 GetElementResponse& resp) override;
+  Status TryGetNext(const GetElementRequest& req, GetElementResponse& resp,
+                    bool& ready) override;
+
+ private:
+  struct BufferedElement {
+    std::vector<Tensor> element;
+    int64 bytes;
+  };
+
+  // Fills `buffer_` until the iterator is exhausted or fails, or the runner
+  // is destroyed.
+  void RunPrefetchThread();
+  // Moves the next buffered element into `resp`. Once the buffer is drained,
+  // reports the end of the sequence or the iterator's error.
+  Status PopElement(GetElementResponse& resp) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool ElementReady() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::unique_ptr<TaskIterator> iterator_;
+  const int64 prefetch_buffer_bytes_;
+  mutex mu_;
+  // Notified when elements are added to or removed from `buffer_`, and when
+  // the prefetch thread stops.
+  condition_variable cv_;
+  std::deque<BufferedElement> buffer_ TF_GUARDED_BY(mu_);
+  // The total size of the elements in `buffer_`.
+  int64 buffered_bytes_ TF_GUARDED_BY(mu_) = 0;
+  bool end_of_sequence_ TF_GUARDED_BY(mu_) = false;
+  // The status if the iterator fails.
+  Status status_ TF_GUARDED_BY(mu_);
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  // Only set if `prefetch_buffer_bytes_` is positive.
+  std::unique_ptr<Thread> prefetch_thread_;
+};
+
+// A sliding window over the elements of a single iterator, shared by several
+// readers. Each reader consumes the window's elements in order, and the
+// iterator is only advanced when a reader runs past the newest element, so
+// readers that keep up with each other see the same elements while the
+// iterator produces each element once. When the window is full the oldest
+// element is evicted, and readers that had not yet consumed it skip ahead.
+class SlidingWindowCache {
+ public:
+  SlidingWindowCache(std::unique_ptr<TaskIterator> iterator,
+                     int64 max_elements);
+  // If the iterator is not yet exhausted, stores the next element for
+  // `reader_id` in `element` and sets `end_of_sequence` to `false`. Otherwise,
+  // sets `end_of_sequence` to `true`. New readers start at the oldest element
+  // in the window.
+  Status GetNext(int64 reader_id, std::vector<Tensor>& element,
+                 bool& end_of_sequence) TF_LOCKS_EXCLUDED(mu_, producer_mu_);
+  // Like `GetNext`, but only advances `reader_id` if its next element is
+  // already in the window or the iterator is exhausted, in which case `ready`
+  // is set to `true`.
+  Status TryGetNext(int64 reader_id, std::vector<Tensor>& element,
+                    bool& end_of_sequence, bool& ready) TF_LOCKS_EXCLUDED(mu_);
+  // Forgets the position of `reader_id`.
+  void RemoveReader(int64 reader_id) TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Implements `TryGetNext`, storing the index of the reader's next element in
+  // `index`.
+  Status TryGetNextLocked(int64 reader_id, std::vector<Tensor>& element,
+                          bool& end_of_sequence, bool& ready, int64& index)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Advances the iterator unless the element at `index` has already been
+  // produced.
+  Status Produce(int64 index) TF_LOCKS_EXCLUDED(mu_, producer_mu_);
+
+  const std::unique_ptr<TaskIterator> iterator_;
+  const int64 max_elements_;
+  // Serializes calls to the iterator, so that `mu_` isn't held while an
+  // element is produced.
+  mutex producer_mu_ TF_ACQUIRED_BEFORE(mu_);
+  mutex mu_;
+  // The elements in the window, oldest first.
+  std::deque<std::vector<Tensor>> elements_ TF_GUARDED_BY(mu_);
+  // The index of `elements_.front()` in the iterator's output.
+  int64 first_index_ TF_GUARDED_BY(mu_) = 0;
+  // The index of the next element to return to each reader.
+  absl::flat_hash_map<int64, int64> next_index_ TF_GUARDED_BY(mu_);
+  bool end_of_sequence_ TF_GUARDED_BY(mu_) = false;
+  // The status if the iterator fails.
+  Status status_ TF_GUARDED_BY(mu_);
+};
+
+// A task runner which reads elements from a `SlidingWindowCache` shared with
+// the tasks of other jobs reading the same dataset.
+class CachingTaskRunner : public TaskRunner {
+ public:
+  // `task_id` identifies this runner as a reader of `cache`.
+  CachingTaskRunner(std::shared_ptr<SlidingWindowCache> cache, int64 task_id);
+  ~CachingTaskRunner() override;
   Status GetNext(const GetElementRequest& req,
                  GetElementResponse& resp) override;
+  Status TryGetNext(const GetElementRequest& req, GetElementResponse& resp,
+                    bool& ready) override;
 
  private:
-  std::unique_ptr<TaskIterator> iterator_;
+  const std::shared_ptr<SlidingWindowCache> cache_;
+  const int64 task_id_;
 };
 
 // Thread for prefetching a round worth of elements.
@@ -12,6 +12,8 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/task_runner.h"
 
+#include <atomic>
+
 #include "absl/memory/memory.h"
 #include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/data/dataset.pb.h"
@@ -20,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -95,6 +98,156 @@ TEST(FirstComeFirstServedTaskRunner, GetNext) {
   }
 }
 
+TEST(FirstComeFirstServedTaskRunner, TryGetNext) {
+  std::vector<std::vector<Tensor>> elements;
+  for (int64 i = 0; i < 10; ++i) {
+    std::vector<Tensor> element;
+    element.push_back(Tensor(i));
+    elements.push_back(element);
+  }
+  FirstComeFirstServedTaskRunner runner(
+      absl::make_unique<TestTaskIterator>(elements),
+      /*prefetch_buffer_bytes=*/1 << 20);
+  GetElementRequest request;
+  for (auto& expected_element : elements) {
+    GetElementResponse response;
+    bool ready = false;
+    while (!ready) {
+      TF_ASSERT_OK(runner.TryGetNext(request, response, ready));
+      if (!ready) {
+        Env::Default()->SleepForMicroseconds(1000);
+      }
+    }
+    ASSERT_FALSE(response.end_of_sequence());
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(UncompressElement(response.compressed_element(), &element));
+    ASSERT_EQ(element.size(), 1);
+    test::ExpectEqual(element[0], expected_element[0]);
+  }
+}
+
+// Produces `num_elements` elements, then fails.
+class FailingTaskIterator : public TaskIterator {
+ public:
+  explicit FailingTaskIterator(int64 num_elements)
+      : num_elements_(num_elements) {}
+
+  Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override {
+    if (index_ >= num_elements_) {
+      return errors::DataLoss("Failed to produce element ", index_);
+    }
+    CompressedElement compressed;
+    TF_RETURN_IF_ERROR(CompressElement({Tensor(index_++)}, &compressed));
+    element.emplace_back(DT_VARIANT, TensorShape({}));
+    element[0].scalar<Variant>()() = std::move(compressed);
+    end_of_sequence = false;
+    return Status::OK();
+  }
+
+  int64 Cardinality() const override { return kUnknownCardinality; }
+
+ private:
+  const int64 num_elements_;
+  int64 index_ = 0;
+};
+
+TEST(FirstComeFirstServedTaskRunner, ReturnsElementsBeforeError) {
+  FirstComeFirstServedTaskRunner runner(
+      absl::make_unique<FailingTaskIterator>(/*num_elements=*/2),
+      /*prefetch_buffer_bytes=*/1 << 20);
+  GetElementRequest request;
+  for (int64 i = 0; i < 2; ++i) {
+    GetElementResponse response;
+    TF_ASSERT_OK(runner.GetNext(request, response));
+    ASSERT_FALSE(response.end_of_sequence());
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(UncompressElement(response.compressed_element(), &element));
+    test::ExpectEqual(element[0], Tensor(i));
+  }
+  GetElementResponse response;
+  EXPECT_EQ(runner.GetNext(request, response).code(), error::DATA_LOSS);
+  bool ready = false;
+  EXPECT_EQ(runner.TryGetNext(request, response, ready).code(),
+            error::DATA_LOSS);
+  EXPECT_TRUE(ready);
+}
+
+TEST(FirstComeFirstServedTaskRunner, TryGetNextWithoutPrefetching) {
+  FirstComeFirstServedTaskRunner runner(
+      absl::make_unique<FailingTaskIterator>(/*num_elements=*/2));
+  GetElementRequest request;
+  GetElementResponse response;
+  bool ready = true;
+  TF_ASSERT_OK(runner.TryGetNext(request, response, ready));
+  EXPECT_FALSE(ready);
+  TF_ASSERT_OK(runner.GetNext(request, response));
+  EXPECT_FALSE(response.end_of_sequence());
+}
+
+// Counts the elements it produces.
+class CountingTaskIterator : public TaskIterator {
+ public:
+  Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override {
+    CompressedElement compressed;
+    TF_RETURN_IF_ERROR(CompressElement({Tensor(num_produced_++)}, &compressed));
+    element.emplace_back(DT_VARIANT, TensorShape({}));
+    element[0].scalar<Variant>()() = std::move(compressed);
+    end_of_sequence = false;
+    return Status::OK();
+  }
+
+  int64 Cardinality() const override { return kInfiniteCardinality; }
+
+  int64 num_produced() const { return num_produced_; }
+
+ private:
+  std::atomic<int64> num_produced_{0};
+};
+
+TEST(FirstComeFirstServedTaskRunner, PrefetchingIsBoundedByBytes) {
+  auto iterator = absl::make_unique<CountingTaskIterator>();
+  CountingTaskIterator* iterator_ptr = iterator.get();
+  // Every element is larger than the buffer, so only one is prefetched.
+  FirstComeFirstServedTaskRunner runner(std::move(iterator),
+                                        /*prefetch_buffer_bytes=*/1);
+  GetElementRequest request;
+  GetElementResponse response;
+  bool ready = false;
+  while (!ready) {
+    TF_ASSERT_OK(runner.TryGetNext(request, response, ready));
+  }
+  Env::Default()->SleepForMicroseconds(10 * 1000);
+  EXPECT_LE(iterator_ptr->num_produced(), 2);
+}
+
+// Blocks in `GetNext` until cancelled.
+class BlockingTaskIterator : public TaskIterator {
+ public:
+  Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override {
+    cancelled_.WaitForNotification();
+    return errors::Cancelled("Iterator was cancelled");
+  }
+
+  int64 Cardinality() const override { return kInfiniteCardinality; }
+
+  void Cancel() override {
+    if (!cancelled_.HasBeenNotified()) {
+      cancelled_.Notify();
+    }
+  }
+
+ private:
+  Notification cancelled_;
+};
+
+TEST(FirstComeFirstServedTaskRunner, DestructorCancelsBlockedIterator) {
+  auto runner = absl::make_unique<FirstComeFirstServedTaskRunner>(
+      absl::make_unique<BlockingTaskIterator>(),
+      /*prefetch_buffer_bytes=*/1 << 20);
+  // Returns once the prefetch thread has been unblocked and joined.
+  runner.reset();
+}
+
 class ConsumeParallelTest
     : public ::testing::Test,
       public ::testing::WithParamInterface<std::tuple<int64, int64>> {};
@@ -192,5 +345,39 @@ TEST(RoundRobinTaskRunner, ConsumeParallelPartialRound) {
               expected_consumer_results[consumer]);
   }
 }
+
+TEST(CachingTaskRunner, ReadersShareElements) {
+  std::vector<std::vector<Tensor>> elements;
+  for (int64 i = 0; i < 10; ++i) {
+    std::vector<Tensor> element;
+    element.push_back(Tensor(i));
+    elements.push_back(element);
+  }
+  auto cache = std::make_shared<SlidingWindowCache>(
+      absl::make_unique<TestTaskIterator>(elements), /*max_elements=*/4);
+  CachingTaskRunner runner1(cache, /*task_id=*/1);
+  CachingTaskRunner runner2(cache, /*task_id=*/2);
+  std::vector<int64> results1;
+  std::vector<int64> results2;
+  TF_ASSERT_OK(RunConsumer(0, 0, 3, runner1, results1));
+  TF_ASSERT_OK(RunConsumer(0, 0, 3, runner2, results2));
+  EXPECT_EQ(results1, std::vector<int64>({0, 1, 2}));
+  EXPECT_EQ(results2, std::vector<int64>({0, 1, 2}));
+
+  // Running ahead by more than the window evicts elements that `runner2`
+  // hasn't read yet, so `runner2` skips to the oldest remaining element.
+  results1.clear();
+  results2.clear();
+  TF_ASSERT_OK(RunConsumer(0, 0, 5, runner1, results1));
+  TF_ASSERT_OK(RunConsumer(0, 0, 2, runner2, results2));
+  EXPECT_EQ(results1, std::vector<int64>({3, 4, 5, 6, 7}));
+  EXPECT_EQ(results2, std::vector<int64>({4, 5}));
+
+  // A new reader starts at the oldest element in the window.
+  CachingTaskRunner runner3(cache, /*task_id=*/3);
+  std::vector<int64> results3;
+  TF_ASSERT_OK(RunConsumer(0, 0, 1, runner3, results3));
+  EXPECT_EQ(results3, std::vector<int64>({4}));
+}
 }  // namespace data
 }  // namespace tensorflow
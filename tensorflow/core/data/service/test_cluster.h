@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_TEST_CLUSTER_H_
 
 #include "tensorflow/core/data/service/server_lib.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
 
 namespace tensorflow {
 namespace data {
@@ -26,6 +27,9 @@ class TestCluster {
  public:
   // Creates a new test cluster with a dispatcher and `num_workers` workers.
   explicit TestCluster(int num_workers);
+  // Creates a new test cluster whose workers start from `worker_config`. The
+  // port, protocol, and addresses in `worker_config` are overridden.
+  TestCluster(int num_workers, const experimental::WorkerConfig& worker_config);
 
   // Initializes the test cluster. This must be called before interacting with
   // the cluster. Initialize should be called only once.
@@ -42,6 +46,7 @@ class TestCluster {
  private:
   bool initialized_ = false;
   int num_workers_;
+  const experimental::WorkerConfig worker_config_;
   std::unique_ptr<DispatchGrpcDataServer> dispatcher_;
   std::string dispatcher_address_;
   std::vector<std::unique_ptr<WorkerGrpcDataServer>> workers_;
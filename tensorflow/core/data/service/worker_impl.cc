@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/worker_impl.h"
 
+#include <algorithm>
+
 #include "grpcpp/create_channel.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/c/c_api_internal.h"
@@ -30,10 +32,13 @@ limitations under the License.
 #include "tensorflow/core/data/service/task_runner.h"
 #include "tensorflow/core/data/service/utils.h"
 #include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/snappy.h"
@@ -119,15 +124,36 @@ Status DataServiceWorkerImpl::ProcessTaskInternal(const TaskDef& task_def)
   return Status::OK();
 }
 
+bool DataServiceWorkerImpl::UseCrossJobCache(const TaskDef& task_def) const {
+  return config_.cross_job_cache_size() > 0 &&
+         task_def.processing_mode() == PARALLEL_EPOCHS &&
+         task_def.optional_num_consumers_case() != TaskDef::kNumConsumers;
+}
+
 Status DataServiceWorkerImpl::EnsureTaskInitialized(
-    DataServiceWorkerImpl::Task& task) {
+    DataServiceWorkerImpl::Task& task) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   mutex_lock l(task.mu);
   if (task.initialized) {
     return Status::OK();
   }
+  bool use_cache = UseCrossJobCache(task.task_def);
+  if (use_cache) {
+    std::shared_ptr<SlidingWindowCache> cache =
+        caches_[task.task_def.dataset_id()].lock();
+    if (cache) {
+      VLOG(1) << "Task " << task.task_def.task_id()
+              << " is sharing the element cache for dataset "
+              << task.task_def.dataset_id();
+      task.task_runner = absl::make_unique<CachingTaskRunner>(
+          std::move(cache), task.task_def.task_id());
+      task.initialized = true;
+      return Status::OK();
+    }
+  }
   standalone::Dataset::Params params;
   std::unique_ptr<standalone::Dataset> dataset;
   std::unique_ptr<standalone::Iterator> iterator;
+  std::function<void()> cancel_iterator;
 
   switch (task.task_def.dataset_case()) {
     case TaskDef::kDatasetDef:
@@ -156,6 +182,10 @@ Status DataServiceWorkerImpl::EnsureTaskInitialized(
       auto split_provider = absl::make_unique<DataServiceSplitProvider>(
           config_.dispatcher_address(), config_.protocol(),
           task.task_def.job_id(), config_.dispatcher_timeout_ms());
+      // The split provider is owned by the iterator, which outlives
+      // `cancel_iterator`.
+      DataServiceSplitProvider* split_provider_ptr = split_provider.get();
+      cancel_iterator = [split_provider_ptr] { split_provider_ptr->Cancel(); };
       TF_RETURN_IF_ERROR(
           dataset->MakeIterator(std::move(split_provider), &iterator));
       break;
@@ -168,9 +198,20 @@ Status DataServiceWorkerImpl::EnsureTaskInitialized(
                                      task.task_def.processing_mode());
   }
   auto task_iterator = absl::make_unique<StandaloneTaskIterator>(
-      std::move(dataset), std::move(iterator));
-  TF_RETURN_IF_ERROR(TaskRunner::Create(task.task_def, std::move(task_iterator),
-                                        task.task_runner));
+      std::move(dataset), std::move(iterator), std::move(cancel_iterator));
+  // Jobs starting at different times only see the same elements if the
+  // dataset is infinite, so finite datasets are never shared.
+  if (use_cache && task_iterator->Cardinality() == kInfiniteCardinality) {
+    auto cache = std::make_shared<SlidingWindowCache>(
+        std::move(task_iterator), config_.cross_job_cache_size());
+    caches_[task.task_def.dataset_id()] = cache;
+    task.task_runner = absl::make_unique<CachingTaskRunner>(
+        std::move(cache), task.task_def.task_id());
+  } else {
+    TF_RETURN_IF_ERROR(TaskRunner::Create(config_, task.task_def,
+                                          std::move(task_iterator),
+                                          task.task_runner));
+  }
 
   task.initialized = true;
   VLOG(3) << "Created iterator for task " << task.task_def.task_id();
@@ -180,6 +221,10 @@ Status DataServiceWorkerImpl::EnsureTaskInitialized(
 Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
                                          GetElementResponse* response) {
   VLOG(3) << "Received GetElement request for task " << request->task_id();
+  num_outstanding_requests_.fetch_add(1, std::memory_order_relaxed);
+  auto cleanup = gtl::MakeCleanup([this] {
+    num_outstanding_requests_.fetch_sub(1, std::memory_order_relaxed);
+  });
   Task* task;
   {
     mutex_lock l(mu_);
@@ -218,6 +263,78 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
   return Status::OK();
 }
 
+Status DataServiceWorkerImpl::GetElements(const GetElementsRequest* request,
+                                          GetElementsResponse* response) {
+  VLOG(3) << "Received GetElements request for " << request->max_elements()
+          << " elements of task " << request->task_id();
+  if (request->max_elements() <= 0) {
+    return errors::InvalidArgument("max_elements must be positive, but got ",
+                                   request->max_elements());
+  }
+  {
+    mutex_lock l(mu_);
+    auto it = tasks_.find(request->task_id());
+    if (it != tasks_.end() &&
+        it->second->task_def.optional_num_consumers_case() ==
+            TaskDef::kNumConsumers) {
+      return errors::FailedPrecondition(
+          "GetElements is not supported for round-robin task ",
+          request->task_id());
+    }
+  }
+  // Waits for the first element, which also initializes the task.
+  GetElementRequest element_request;
+  element_request.set_task_id(request->task_id());
+  GetElementResponse element_response;
+  TF_RETURN_IF_ERROR(GetElement(&element_request, &element_response));
+  if (element_response.end_of_sequence()) {
+    response->set_end_of_sequence(true);
+    return Status::OK();
+  }
+  response->add_compressed_elements()->Swap(
+      element_response.mutable_compressed_element());
+
+  // Adds the elements that are already available, without waiting for more
+  // to be produced.
+  Task* task;
+  {
+    mutex_lock l(mu_);
+    auto it = tasks_.find(request->task_id());
+    if (it == tasks_.end() || !it->second->initialized) {
+      return Status::OK();
+    }
+    task = it->second.get();
+  }
+  while (response->compressed_elements_size() < request->max_elements()) {
+    element_response.Clear();
+    bool ready;
+    Status s = task->task_runner->TryGetNext(element_request, element_response,
+                                             ready);
+    if (!s.ok()) {
+      // Return the elements produced so far. Task runners report the error
+      // again on the next request.
+      VLOG(1) << "Returning " << response->compressed_elements_size()
+              << " elements of task " << request->task_id()
+              << " before an error: " << s;
+      break;
+    }
+    if (!ready) {
+      break;
+    }
+    if (element_response.end_of_sequence()) {
+      mutex_lock l(mu_);
+      VLOG(3) << "Reached end_of_sequence for task " << request->task_id();
+      pending_completed_tasks_.insert(request->task_id());
+      task_completion_cv_.notify_one();
+      response->set_end_of_sequence(true);
+      break;
+    }
+    response->add_compressed_elements()->Swap(
+        element_response.mutable_compressed_element());
+  }
+  return Status::OK();
+}
+
 Status DataServiceWorkerImpl::GetWorkerTasks(
     const GetWorkerTasksRequest* request, GetWorkerTasksResponse* response) {
   mutex_lock l(mu_);
@@ -315,11 +432,15 @@ Status DataServiceWorkerImpl::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
       current_tasks.push_back(task.first);
     }
   }
+  WorkerLoad load = GetLoad(current_tasks.size());
   std::vector<TaskDef> new_tasks;
   std::vector<int64> tasks_to_delete;
-  TF_RETURN_IF_ERROR(
-      dispatcher_->WorkerHeartbeat(worker_address_, transfer_address_,
-                                   current_tasks, new_tasks, tasks_to_delete));
+  TF_RETURN_IF_ERROR(dispatcher_->WorkerHeartbeat(
+      worker_address_, transfer_address_, current_tasks, load, new_tasks,
+      tasks_to_delete));
+  // Deleted tasks are destroyed after releasing `mu_`, because destroying a
+  // task runner may wait for its iterator.
+  std::vector<std::unique_ptr<Task>> deleted_tasks;
   mutex_lock l(mu_);
   for (const auto& task : new_tasks) {
     Status s = ProcessTaskInternal(task);
@@ -331,11 +452,37 @@ Status DataServiceWorkerImpl::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
   for (int64 task_id : tasks_to_delete) {
     VLOG(3) << "Deleting task " << task_id
             << " at the request of the dispatcher";
-    tasks_.erase(task_id);
+    auto it = tasks_.find(task_id);
+    if (it != tasks_.end()) {
+      deleted_tasks.push_back(std::move(it->second));
+      tasks_.erase(it);
+    }
     finished_tasks_.insert(task_id);
   }
   return Status::OK();
 }
 
+WorkerLoad DataServiceWorkerImpl::GetLoad(int64 num_tasks)
+    TF_LOCKS_EXCLUDED(mu_) {
+  WorkerLoad load;
+  load.set_num_tasks(num_tasks);
+  load.set_num_outstanding_requests(
+      num_outstanding_requests_.load(std::memory_order_relaxed));
+  std::clock_t cpu_time = std::clock();
+  int64 now_micros = Env::Default()->NowMicros();
+  if (last_load_micros_ > 0 && now_micros > last_load_micros_ &&
+      cpu_time != static_cast<std::clock_t>(-1)) {
+    double cpu_micros =
+        1e6 * (cpu_time - last_load_cpu_time_) / CLOCKS_PER_SEC;
+    double utilization = cpu_micros / (now_micros - last_load_micros_) /
+                         port::MaxParallelism();
+    load.set_cpu_utilization(std::min(1.0, std::max(0.0, utilization)));
+    load.set_cpu_utilization_measured(true);
+  }
+  last_load_cpu_time_ = cpu_time;
+  last_load_micros_ = now_micros;
+  return load;
+}
+
 }  // namespace data
 }  // namespace tensorflow
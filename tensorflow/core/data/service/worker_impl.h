@@ -15,6 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_WORKER_IMPL_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_WORKER_IMPL_H_
 
+#include <atomic>
+#include <ctime>
+#include <memory>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/data/service/common.pb.h"
@@ -53,6 +57,8 @@ class DataServiceWorkerImpl {
   /// Client-facing API.
   Status GetElement(const GetElementRequest* request,
                     GetElementResponse* response);
+  Status GetElements(const GetElementsRequest* request,
+                     GetElementsResponse* response);
   Status GetWorkerTasks(const GetWorkerTasksRequest* request,
                         GetWorkerTasksResponse* response);
 
@@ -66,18 +72,24 @@ class DataServiceWorkerImpl {
     std::unique_ptr<TaskRunner> task_runner;
   };
 
+  // Returns whether `task_def` should read from a cache shared with the tasks
+  // of other jobs reading the same dataset.
+  bool UseCrossJobCache(const TaskDef& task_def) const;
+
   // Sends task status to the dispatcher and checks for dispatcher commands.
   Status SendTaskUpdates() TF_LOCKS_EXCLUDED(mu_);
   // Creates an iterator to process a task.
   Status ProcessTaskInternal(const TaskDef& task)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
-  Status EnsureTaskInitialized(Task& task);
+  Status EnsureTaskInitialized(Task& task) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // A thread for notifying the dispatcher when tasks complete.
   void TaskCompletionThread() TF_LOCKS_EXCLUDED(mu_);
   // A thread for doing periodic heartbeats to the dispatcher.
   void HeartbeatThread() TF_LOCKS_EXCLUDED(mu_);
   // Performs a heartbeat to the dispatcher.
   Status Heartbeat() TF_LOCKS_EXCLUDED(mu_);
+  // Computes the load to report in the next heartbeat.
+  WorkerLoad GetLoad(int64 num_tasks) TF_LOCKS_EXCLUDED(mu_);
 
   const experimental::WorkerConfig config_;
   // The worker's own address.
@@ -90,6 +102,12 @@ class DataServiceWorkerImpl {
   absl::flat_hash_map<int64, std::unique_ptr<Task>> tasks_ TF_GUARDED_BY(mu_);
   // Ids of tasks that have finished.
   absl::flat_hash_set<int64> finished_tasks_ TF_GUARDED_BY(mu_);
+  // Element caches shared between the tasks of different jobs, keyed by
+  // dataset id. The dispatcher assigns one id per dataset fingerprint, so
+  // jobs reading identical datasets share a cache. Each cache lives as long
+  // as a task runner is reading from it.
+  absl::flat_hash_map<int64, std::weak_ptr<SlidingWindowCache>> caches_
+      TF_GUARDED_BY(mu_);
   // Completed tasks which haven't yet been communicated to the dispatcher.
   absl::flat_hash_set<int64> pending_completed_tasks_ TF_GUARDED_BY(mu_);
   bool cancelled_ TF_GUARDED_BY(mu_) = false;
@@ -101,6 +119,12 @@ class DataServiceWorkerImpl {
   // A thread for performing regular heartbeats to the dispatcher.
   std::unique_ptr<Thread> heartbeat_thread_;
   condition_variable heartbeat_cv_ TF_GUARDED_BY(mu_);
+  // Number of GetElement requests currently in progress.
+  std::atomic<int64> num_outstanding_requests_{0};
+  // Process CPU time and wall time at the previous heartbeat, used to compute
+  // CPU utilization. Only accessed from the heartbeat thread.
+  std::clock_t last_load_cpu_time_ = 0;
+  int64 last_load_micros_ = 0;
 
   TF_DISALLOW_COPY_AND_ASSIGN(DataServiceWorkerImpl);
 };
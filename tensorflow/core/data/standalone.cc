@@ -141,6 +141,8 @@ Status Dataset::MakeSplitProvider(std::unique_ptr<SplitProvider>* result) {
 
 const DatasetBase* Dataset::Get() const { return dataset_; }
 
+void Dataset::Cancel() { cancellation_manager_.StartCancel(); }
+
 Dataset::Dataset(DatasetBase* dataset, DeviceMgr* device_mgr,
                  ProcessFunctionLibraryRuntime* pflr,
                  FunctionLibraryDefinition* flib_def, thread::ThreadPool* pool)
@@ -106,6 +106,10 @@ class Dataset {
   Status MakeSplitProvider(std::unique_ptr<SplitProvider>* result);
   // Returns a pointer to the underlying dataset.
   const DatasetBase* Get() const;
+  // Cancels the iterators of this dataset. Pending and later calls to their
+  // `GetNext` fail with a Cancelled error, as far as the dataset's ops observe
+  // cancellation.
+  void Cancel();
 
  private:
   Dataset(DatasetBase* dataset, DeviceMgr* device_mgr,
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/resource.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/batch_util.h"
 
 namespace tensorflow {
 namespace data {
@@ -555,8 +556,10 @@ Status DatasetBaseIterator::GetNext(IteratorContext* ctx,
                              profiler::TraceMeLevel::kInfo);
   DVLOG(3) << prefix() << " GetNext enter";
   auto model = ctx->model();
+  int64 start_nanos = 0;
   if (model && model->collect_resource_usage() && node_) {
     int64 now_nanos = EnvTime::NowNanos();
+    start_nanos = now_nanos;
     auto output = node_->output();
     if (output) {
       output->record_stop(now_nanos);
@@ -570,6 +573,7 @@ Status DatasetBaseIterator::GetNext(IteratorContext* ctx,
   }
   if (model && model->collect_resource_usage() && node_) {
     int64 now_nanos = EnvTime::NowNanos();
+    node_->record_get_next_latency(now_nanos - start_nanos);
     node_->record_stop(now_nanos);
     auto output = node_->output();
     if (output) {
@@ -646,6 +650,123 @@ Status DatasetBaseIterator::SkipInternal(IteratorContext* ctx, int num_to_skip,
   return Status::OK();
 }
 
+namespace {
+
+// Copies the components of `element` into the `index`-th slice of the
+// respective tensors in `*batch`.
+Status CopyElementToBatchSlice(std::vector<Tensor>* element, int64 index,
+                               std::vector<Tensor>* batch) {
+  if (element->size() != batch->size()) {
+    return errors::InvalidArgument(
+        "Cannot copy an element with ", element->size(),
+        " components into a batch with ", batch->size(), " components.");
+  }
+  for (size_t i = 0; i < element->size(); ++i) {
+    const Tensor& component = (*element)[i];
+    const Tensor& batch_component = (*batch)[i];
+    if (component.dtype() != batch_component.dtype()) {
+      return errors::InvalidArgument(
+          "Cannot batch tensors with different types in component ", i,
+          ". The batch has type ", DataTypeString(batch_component.dtype()),
+          " and the element has type ", DataTypeString(component.dtype()),
+          ".");
+    }
+    TensorShape slice_shape = batch_component.shape();
+    if (slice_shape.dims() > 0) {
+      slice_shape.RemoveDim(0);
+    }
+    if (batch_component.dims() == 0 || component.shape() != slice_shape) {
+      return errors::InvalidArgument(
+          "Cannot batch tensors with different shapes in component ", i,
+          ". The batch has elements of shape ", slice_shape.DebugString(),
+          " and the element has shape ", component.shape().DebugString(),
+          ".");
+    }
+    TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+        std::move((*element)[i]), &(*batch)[i], index));
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status IteratorBase::GetNextIntoSlice(IteratorContext* ctx, int64 index,
+                                      std::vector<Tensor>* batch,
+                                      bool* end_of_sequence) {
+  std::vector<Tensor> element;
+  TF_RETURN_IF_ERROR(GetNext(ctx, &element, end_of_sequence));
+  if (*end_of_sequence) {
+    return Status::OK();
+  }
+  return CopyElementToBatchSlice(&element, index, batch);
+}
+
+Status DatasetBaseIterator::GetNextIntoSlice(IteratorContext* ctx,
+                                             int64 index,
+                                             std::vector<Tensor>* batch,
+                                             bool* end_of_sequence) {
+  profiler::TraceMe activity([&] { return BuildTraceMeName(); },
+                             profiler::TraceMeLevel::kInfo);
+  DVLOG(3) << prefix() << " GetNextIntoSlice enter";
+  auto model = ctx->model();
+  int64 start_nanos = 0;
+  if (model && model->collect_resource_usage() && node_) {
+    int64 now_nanos = EnvTime::NowNanos();
+    start_nanos = now_nanos;
+    auto output = node_->output();
+    if (output) {
+      output->record_stop(now_nanos);
+    }
+    node_->record_start(now_nanos);
+  }
+  Status s = GetNextIntoSliceInternal(ctx, index, batch, end_of_sequence);
+  if (TF_PREDICT_TRUE(s.ok() && !*end_of_sequence) && node_) {
+    // Attribute one slice worth of the batch buffers to this element.
+    int64 num_bytes = 0;
+    for (const Tensor& t : *batch) {
+      if (t.dims() > 0 && t.dim_size(0) > 0) {
+        num_bytes += t.AllocatedBytes() / t.dim_size(0);
+      }
+    }
+    node_->record_element();
+    node_->record_element_bytes(num_bytes);
+    node_->record_bytes_produced(num_bytes);
+    if (node_->output()) {
+      node_->output()->record_bytes_consumed(num_bytes);
+    }
+  }
+  if (model && model->collect_resource_usage() && node_) {
+    int64 now_nanos = EnvTime::NowNanos();
+    node_->record_get_next_latency(now_nanos - start_nanos);
+    node_->record_stop(now_nanos);
+    auto output = node_->output();
+    if (output) {
+      output->record_start(now_nanos);
+    }
+  }
+  if (TF_PREDICT_FALSE(errors::IsOutOfRange(s))) {
+    s = errors::Internal("Iterator \"", params_.prefix,
+                         "\" returned `OutOfRange`. This indicates an "
+                         "implementation error as `OutOfRange` errors are not "
+                         "expected to be returned here. Original message: ",
+                         s.error_message());
+    LOG(ERROR) << s;
+  }
+  DVLOG(3) << prefix() << " GetNextIntoSlice exit";
+  return s;
+}
+
+Status DatasetBaseIterator::GetNextIntoSliceInternal(
+    IteratorContext* ctx, int64 index, std::vector<Tensor>* batch,
+    bool* end_of_sequence) {
+  std::vector<Tensor> element;
+  TF_RETURN_IF_ERROR(GetNextInternal(ctx, &element, end_of_sequence));
+  if (*end_of_sequence) {
+    return Status::OK();
+  }
+  return CopyElementToBatchSlice(&element, index, batch);
+}
+
 void DatasetOpKernel::Compute(OpKernelContext* ctx) {
   DatasetBase* dataset = nullptr;
   MakeDataset(ctx, &dataset);
@@ -642,6 +642,25 @@ class IteratorBase {
   virtual Status Skip(IteratorContext* ctx, int num_to_skip,
                       bool* end_of_sequence, int* num_skipped) = 0;
 
+  // Gets the next output from the range that this iterator is traversing and
+  // writes its components into the `index`-th slice (in the 0th dimension) of
+  // the respective tensors in `*batch`.
+  //
+  // The tensors in `*batch` must already be allocated with a leading
+  // dimension greater than `index` and with trailing dimensions matching the
+  // shapes of the element components. If at end of sequence, sets
+  // `*end_of_sequence = true`, returns `Status::OK()` and leaves `*batch`
+  // unchanged.
+  //
+  // The default implementation calls `GetNext()` and copies the result into
+  // place. Iterators that can produce an element directly into the
+  // destination buffer override this to avoid the intermediate copy.
+  //
+  // This method is thread-safe.
+  virtual Status GetNextIntoSlice(IteratorContext* ctx, int64 index,
+                                  std::vector<Tensor>* batch,
+                                  bool* end_of_sequence);
+
   // Returns a vector of DataType values, representing the respective
   // element types of each tuple component in the outputs of this
   // iterator.
@@ -989,6 +1008,10 @@ class DatasetBaseIterator : public IteratorBase {
   Status Skip(IteratorContext* ctx, int num_to_skip, bool* end_of_sequence,
               int* num_skipped) final;
 
+  Status GetNextIntoSlice(IteratorContext* ctx, int64 index,
+                          std::vector<Tensor>* batch,
+                          bool* end_of_sequence) final;
+
   Status Save(SerializationContext* ctx, IteratorStateWriter* writer) final {
     return IteratorBase::Save(ctx, writer);
   }
@@ -1003,6 +1026,13 @@ class DatasetBaseIterator : public IteratorBase {
   virtual Status SkipInternal(IteratorContext* ctx, int num_to_skip,
                               bool* end_of_sequence, int* num_skipped);
 
+  // Internal implementation of GetNextIntoSlice that is wrapped in tracing
+  // logic. The default implementation calls `GetNextInternal()` and copies
+  // the element into the `index`-th slice of `*batch`.
+  virtual Status GetNextIntoSliceInternal(IteratorContext* ctx, int64 index,
+                                          std::vector<Tensor>* batch,
+                                          bool* end_of_sequence);
+
   string full_name(const string& name) const {
     return FullName(params_.prefix, name);
   }
@@ -1057,6 +1087,7 @@ class DatasetBaseIterator : public IteratorBase {
     if (node_) {
       int64 num_bytes = GetAllocatedBytes(*out_tensors);
       node_->record_element();
+      node_->record_element_bytes(num_bytes);
       node_->record_bytes_produced(num_bytes);
       if (node_->output()) {
         node_->output()->record_bytes_consumed(num_bytes);
@@ -1064,6 +1095,14 @@ class DatasetBaseIterator : public IteratorBase {
     }
   }
 
+  // When modeling is enabled, this method records the time a consumer of this
+  // iterator spent blocked waiting for an element to become available.
+  void RecordConsumerWait(IteratorContext* ctx, int64 wait_nanos) {
+    if (collect_resource_usage(ctx)) {
+      node_->record_wait_time(wait_nanos);
+    }
+  }
+
   // When modeling is enabled, this method records the fact that a thread of
   // this iterator has started work.
   void RecordStart(IteratorContext* ctx) {
@@ -96,4 +96,93 @@ INSTANTIATE_TEST_SUITE_P(
         {_tf_string_, tensor_strs,
          static_cast<int64>(sizeof(str) + str.size()) /*bytes*/}}));
 
+// Produces a single, fixed element and relies on the default
+// `GetNextIntoSlice()` implementation to batch it.
+class FixedElementIterator : public data::IteratorBase {
+ public:
+  explicit FixedElementIterator(std::vector<Tensor> element)
+      : element_(std::move(element)) {}
+
+  Status GetNext(data::IteratorContext* ctx, std::vector<Tensor>* out_tensors,
+                 bool* end_of_sequence) override {
+    *out_tensors = element_;
+    *end_of_sequence = false;
+    return Status::OK();
+  }
+
+  Status Skip(data::IteratorContext* ctx, int num_to_skip,
+              bool* end_of_sequence, int* num_skipped) override {
+    return errors::Unimplemented("Skip");
+  }
+
+  const DataTypeVector& output_dtypes() const override { return dtypes_; }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return shapes_;
+  }
+
+  const string& prefix() const override { return prefix_; }
+
+ protected:
+  std::shared_ptr<data::model::Node> CreateNode(
+      data::IteratorContext* ctx,
+      data::model::Node::Args args) const override {
+    return nullptr;
+  }
+
+  Status SaveInternal(data::SerializationContext* ctx,
+                      data::IteratorStateWriter* writer) override {
+    return errors::Unimplemented("SaveInternal");
+  }
+
+  Status RestoreInternal(data::IteratorContext* ctx,
+                         data::IteratorStateReader* reader) override {
+    return errors::Unimplemented("RestoreInternal");
+  }
+
+ private:
+  const std::vector<Tensor> element_;
+  const DataTypeVector dtypes_;
+  const std::vector<PartialTensorShape> shapes_;
+  const string prefix_ = "Iterator::FixedElement";
+};
+
+TEST(DatasetTest, GetNextIntoSlice) {
+  FixedElementIterator iterator(
+      {test::AsTensor<int64>({1, 2, 3, 4, 5, 6}, TensorShape({3, 2}))});
+  std::vector<Tensor> batch = {Tensor(DT_INT64, TensorShape({2, 3, 2}))};
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(iterator.GetNextIntoSlice(/*ctx=*/nullptr, /*index=*/1,
+                                         &batch, &end_of_sequence));
+  test::ExpectTensorEqual<int64>(
+      batch[0].SubSlice(1),
+      test::AsTensor<int64>({1, 2, 3, 4, 5, 6}, TensorShape({3, 2})));
+}
+
+TEST(DatasetTest, GetNextIntoSliceShapeMismatch) {
+  // The element has as many values as a slice of the batch, but a different
+  // shape.
+  FixedElementIterator iterator(
+      {test::AsTensor<int64>({1, 2, 3, 4, 5, 6}, TensorShape({3, 2}))});
+  std::vector<Tensor> batch = {Tensor(DT_INT64, TensorShape({2, 2, 3}))};
+  bool end_of_sequence = false;
+  EXPECT_EQ(iterator
+                .GetNextIntoSlice(/*ctx=*/nullptr, /*index=*/0, &batch,
+                                  &end_of_sequence)
+                .code(),
+            error::INVALID_ARGUMENT);
+}
+
+TEST(DatasetTest, GetNextIntoSliceTypeMismatch) {
+  FixedElementIterator iterator(
+      {test::AsTensor<int32>({1, 2, 3, 4, 5, 6}, TensorShape({3, 2}))});
+  std::vector<Tensor> batch = {Tensor(DT_INT64, TensorShape({2, 3, 2}))};
+  bool end_of_sequence = false;
+  EXPECT_EQ(iterator
+                .GetNextIntoSlice(/*ctx=*/nullptr, /*index=*/0, &batch,
+                                  &end_of_sequence)
+                .code(),
+            error::INVALID_ARGUMENT);
+}
+
 }  // namespace tensorflow
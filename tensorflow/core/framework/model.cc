@@ -15,12 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/framework/model.h"
 
+#include <cstdlib>
+#include <limits>
 #include <memory>
 
 #include "absl/time/clock.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/numbers.h"
+#include "tensorflow/core/platform/stringprintf.h"
 
 namespace tensorflow {
 namespace data {
@@ -40,6 +44,19 @@ inline bool IsAutotuneNode(const std::shared_ptr<Node> node) {
   return node->autotune();
 }
 
+// Returns the stats dump period configured through the
+// `TF_DATA_STATS_DUMP_PERIOD_MS` environment variable, or 0 if it is not set.
+int64 StatsDumpPeriodMsFromEnv() {
+  const char* period_str = std::getenv("TF_DATA_STATS_DUMP_PERIOD_MS");
+  int64 period_ms = 0;
+  if (period_str != nullptr && !strings::safe_strto64(period_str, &period_ms)) {
+    LOG(WARNING) << "Ignoring invalid TF_DATA_STATS_DUMP_PERIOD_MS value: "
+                 << period_str;
+    return 0;
+  }
+  return period_ms;
+}
+
 // Wrapper for the square function to reduce verbosity.
 inline double Square(double x) { return x * x; }
 
@@ -1132,6 +1149,20 @@ string Node::DebugString() const {
   return debug_strings[long_name()];
 }
 
+string Node::StatsSummary() const {
+  constexpr double kNanosToMicros = 1e-3;
+  return strings::Printf(
+      "%s: elements=%lld get_next_us[p50=%.1f p90=%.1f p99=%.1f] "
+      "wait_us[p50=%.1f p99=%.1f] element_bytes[avg=%.0f p99=%.0f]",
+      long_name().c_str(), static_cast<long long>(num_elements_.load()),
+      get_next_latency_.Median() * kNanosToMicros,
+      get_next_latency_.Percentile(90) * kNanosToMicros,
+      get_next_latency_.Percentile(99) * kNanosToMicros,
+      wait_time_.Median() * kNanosToMicros,
+      wait_time_.Percentile(99) * kNanosToMicros, element_bytes_.Average(),
+      element_bytes_.Percentile(99));
+}
+
 void Node::FlushMetrics() {
   if (!record_metrics_) {
     return;
@@ -1594,6 +1625,11 @@ Status Node::FromProto(ModelProto::Node node_proto,
   return Status::OK();
 }
 
+Model::Model()
+    : collect_resource_usage_(false),
+      optimization_period_ms_(kOptimizationPeriodMinMs),
+      stats_dump_period_ms_(StatsDumpPeriodMsFromEnv()) {}
+
 void Model::AddNode(Node::Factory factory, const string& name,
                     std::shared_ptr<Node> parent,
                     std::shared_ptr<Node>* out_node) {
@@ -1636,6 +1672,24 @@ void Model::FlushMetrics() {
   }
 }
 
+string Model::StatsSummary() {
+  std::deque<std::shared_ptr<Node>> queue;
+  {
+    tf_shared_lock l(mu_);
+    if (output_) queue.push_back(output_);
+  }
+  string result;
+  while (!queue.empty()) {
+    auto node = queue.front();
+    queue.pop_front();
+    strings::StrAppend(&result, node->StatsSummary(), "\n");
+    for (auto input : node->inputs()) {
+      queue.push_back(input);
+    }
+  }
+  return result;
+}
+
 void Model::Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget,
                      int64 ram_budget, double model_input_time) {
   switch (algorithm) {
@@ -1713,6 +1767,7 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm, int64 cpu_budget,
 
   int64 last_optimization_ms = 0;
   int64 current_time_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
+  int64 last_stats_dump_ms = current_time_ms;
   while (true) {
     {
       mutex_lock l(mu_);
@@ -1744,6 +1799,17 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm, int64 cpu_budget,
     current_time_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
     last_optimization_ms = current_time_ms;
     FlushMetrics();
+
+    int64 stats_dump_period_ms;
+    {
+      tf_shared_lock l(mu_);
+      stats_dump_period_ms = stats_dump_period_ms_;
+    }
+    if (stats_dump_period_ms > 0 &&
+        current_time_ms - last_stats_dump_ms >= stats_dump_period_ms) {
+      LOG(INFO) << "tf.data iterator stats:\n" << StatsSummary();
+      last_stats_dump_ms = current_time_ms;
+    }
   }
 }
 
@@ -1809,6 +1875,10 @@ void Model::OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget,
   for (auto& pair : parameters) {
     pair.second->value = std::round(pair.second->value);
   }
+  bool ram_budget_limited =
+      ShrinkToRamBudget(ram_budget, model_input_time, snapshot, &parameters);
+  RecordOptimizationPlan(ram_budget, model_input_time, snapshot,
+                         ram_budget_limited);
   UpdateStateValues(&parameters);
 }
 
@@ -1836,6 +1906,7 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget,
   for (auto& pair : parameters) {
     pair.second->value = pair.second->min;
   }
+  bool ram_budget_limited = false;
   while (true) {
     const double output_time =
         OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
@@ -1857,6 +1928,11 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget,
         continue;
       }
       pair.second->value++;
+      if (TotalMaximumBufferedBytes(snapshot) > ram_budget) {
+        ram_budget_limited = true;
+        pair.second->value--;
+        continue;
+      }
       double new_output_time =
           OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
       double delta = output_time - new_output_time;
@@ -1876,9 +1952,70 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget,
     }
     best_parameter->value++;
   }
+  RecordOptimizationPlan(ram_budget, model_input_time, snapshot,
+                         ram_budget_limited);
   UpdateStateValues(&parameters);
 }
 
+bool Model::ShrinkToRamBudget(
+    int64 ram_budget, double model_input_time, std::shared_ptr<Node> snapshot,
+    absl::flat_hash_map<string, std::shared_ptr<Parameter>>* parameters) {
+  bool shrunk = false;
+  double buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+  while (buffered_bytes > ram_budget) {
+    const double output_time =
+        OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+    double best_cost = std::numeric_limits<double>::max();
+    double best_buffered_bytes = buffered_bytes;
+    Parameter* best_parameter = nullptr;
+    for (auto& pair : *parameters) {
+      if (pair.second->value - 1 < pair.second->min) {
+        continue;
+      }
+      pair.second->value--;
+      const double new_buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+      const double freed_bytes = buffered_bytes - new_buffered_bytes;
+      if (freed_bytes > 0) {
+        const double cost =
+            (OutputTime(snapshot, model_input_time, /*gradients=*/nullptr) -
+             output_time) /
+            freed_bytes;
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_buffered_bytes = new_buffered_bytes;
+          best_parameter = pair.second.get();
+        }
+      }
+      pair.second->value++;
+    }
+    if (!best_parameter) {
+      VLOG(2) << "The projected buffer memory of " << buffered_bytes
+              << " bytes exceeds the RAM budget of " << ram_budget
+              << " bytes even with all parameters at their minimum values.";
+      break;
+    }
+    best_parameter->value--;
+    buffered_bytes = best_buffered_bytes;
+    shrunk = true;
+  }
+  return shrunk;
+}
+
+void Model::RecordOptimizationPlan(int64 ram_budget, double model_input_time,
+                                   std::shared_ptr<Node> snapshot,
+                                   bool ram_budget_limited) {
+  ModelProto::OptimizationPlan plan;
+  plan.set_ram_budget(ram_budget);
+  plan.set_buffered_bytes(TotalBufferedBytes(snapshot));
+  plan.set_maximum_buffered_bytes(TotalMaximumBufferedBytes(snapshot));
+  plan.set_output_time(
+      OutputTime(snapshot, model_input_time, /*gradients=*/nullptr));
+  plan.set_ram_budget_limited(ram_budget_limited);
+  VLOG(2) << "Optimization plan: " << plan.ShortDebugString();
+  mutex_lock l(mu_);
+  optimization_plan_ = std::move(plan);
+}
+
 double Model::OutputTime(std::shared_ptr<Node> node, double model_input_time,
                          absl::flat_hash_map<string, double>* gradients) {
   // To store the input time for each node.
@@ -1913,6 +2050,7 @@ Status Model::ToProto(ModelProto* model_proto) {
   TF_RETURN_IF_ERROR(output_->ToProto(output_proto));
   model_proto->set_id_counter(id_counter_);
   model_proto->set_collect_resource_usage(collect_resource_usage_);
+  *model_proto->mutable_optimization_plan() = optimization_plan_;
   return Status::OK();
 }
 
@@ -1926,6 +2064,7 @@ Status Model::FromProto(ModelProto model_proto, std::unique_ptr<Model>* model) {
   restored_model->id_counter_ = model_proto.id_counter();
   restored_model->collect_resource_usage_.store(
       model_proto.collect_resource_usage());
+  restored_model->optimization_plan_ = model_proto.optimization_plan();
   *model = std::move(restored_model);
   return Status::OK();
 }
@@ -282,6 +282,22 @@ class Node {
     num_elements_++;
   }
 
+  // Records the size of a single element produced by the node.
+  void record_element_bytes(int64 num_bytes) TF_LOCKS_EXCLUDED(mu_) {
+    element_bytes_.Add(num_bytes);
+  }
+
+  // Records the wall-clock duration of a single `GetNext()` call.
+  void record_get_next_latency(int64 time_nanos) TF_LOCKS_EXCLUDED(mu_) {
+    get_next_latency_.Add(time_nanos);
+  }
+
+  // Records the time a consumer spent blocked waiting for the node to make an
+  // element available.
+  void record_wait_time(int64 time_nanos) TF_LOCKS_EXCLUDED(mu_) {
+    wait_time_.Add(time_nanos);
+  }
+
   // Records that a node thread has started executing.
   void record_start(int64 time_nanos) TF_LOCKS_EXCLUDED(mu_) {
     DCHECK_EQ(work_start_, 0);
@@ -344,6 +360,11 @@ class Node {
   // Returns a human-readable representation of this node.
   string DebugString() const TF_LOCKS_EXCLUDED(mu_);
 
+  // Returns a one-line summary of the `GetNext()` latency, element size and
+  // consumer wait time distributions recorded by this node (but not its
+  // inputs).
+  string StatsSummary() const TF_LOCKS_EXCLUDED(mu_);
+
   // Flushes the metrics recorded by this node.
   void FlushMetrics() TF_LOCKS_EXCLUDED(mu_);
 
@@ -576,6 +597,11 @@ class Node {
   std::atomic<int64> processing_time_;
   std::atomic<bool> record_metrics_;
   Metrics metrics_;
+  // Distributions of `GetNext()` latency (in nanoseconds), element size (in
+  // bytes) and consumer wait time (in nanoseconds).
+  histogram::ThreadSafeHistogram get_next_latency_;
+  histogram::ThreadSafeHistogram element_bytes_;
+  histogram::ThreadSafeHistogram wait_time_;
   absl::flat_hash_map<string, std::shared_ptr<Parameter>> parameters_
       TF_GUARDED_BY(mu_);
 
@@ -642,9 +668,7 @@ std::shared_ptr<Node> MakeUnknownNode(Node::Args args);
 class Model {
  public:
   // Creates a new model.
-  Model()
-      : collect_resource_usage_(false),
-        optimization_period_ms_(kOptimizationPeriodMinMs) {}
+  Model();
 
   // Indicates whether to collect resource usage.
   bool collect_resource_usage() const { return collect_resource_usage_; }
@@ -679,6 +703,18 @@ class Model {
   // Produces a proto for this model.
   Status ToProto(ModelProto* model_proto);
 
+  // Returns a compact summary of the per-iterator histograms, with one line
+  // per node in breadth-first order starting from the output node.
+  string StatsSummary() TF_LOCKS_EXCLUDED(mu_);
+
+  // Sets the minimum period between two logged `StatsSummary()` dumps in
+  // `OptimizeLoop`. A non-positive value disables the dumps. The initial value
+  // is read from the `TF_DATA_STATS_DUMP_PERIOD_MS` environment variable.
+  void set_stats_dump_period_ms(int64 period_ms) TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    stats_dump_period_ms_ = period_ms;
+  }
+
   // Restores a model from the proto.
   static Status FromProto(ModelProto model_proto,
                           std::unique_ptr<Model>* model);
@@ -698,10 +734,11 @@ class Model {
 
   // This optimization algorithm starts by setting all tunable parallelism
   // parameters to the minimum value. It then repeatedly identifies the
-  // parameter whose increase in parallelism decreases the output time the most.
-  // This process is repeated until all parameters reach their maximum values or
-  // the projected output time is less than or equal to the processing time
-  // needed to produce an element divided by CPU budget.
+  // parameter whose increase in parallelism decreases the output time the most,
+  // skipping increases that would take the projected buffer memory over the RAM
+  // budget. This process is repeated until all parameters reach their maximum
+  // values or the projected output time is less than or equal to the
+  // processing time needed to produce an element divided by CPU budget.
   void OptimizeHillClimb(int64 cpu_budget, int64 ram_budget,
                          double model_input_time);
 
@@ -711,7 +748,8 @@ class Model {
   // projecting resulting values on the feasible intervals. Improvement step is
   // repeated until either the output time improvement is smaller than threshold
   // value or the output time is less than the processing time needed to produce
-  // an element divided by CPU budget.
+  // an element divided by CPU budget. If the final step overshoots the RAM
+  // budget, parameters are lowered again with `ShrinkToRamBudget`.
   void OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget,
                                double model_input_time);
 
@@ -733,6 +771,20 @@ class Model {
           buffer_size_parameters,
       std::shared_ptr<Node> snapshot, bool* cpu_budget_reached);
 
+  // Lowers the tunable parameters of the given snapshot until the projected
+  // memory use of its buffers fits in `ram_budget`. Each step lowers the
+  // parameter that frees buffered bytes at the smallest cost in output time
+  // per byte. Returns whether any parameter was lowered.
+  bool ShrinkToRamBudget(
+      int64 ram_budget, double model_input_time, std::shared_ptr<Node> snapshot,
+      absl::flat_hash_map<string, std::shared_ptr<Parameter>>* parameters);
+
+  // Records the outcome of an optimization of the given snapshot, which is
+  // reported through `ToProto`.
+  void RecordOptimizationPlan(int64 ram_budget, double model_input_time,
+                              std::shared_ptr<Node> snapshot,
+                              bool ram_budget_limited) TF_LOCKS_EXCLUDED(mu_);
+
   // Collects the processing time for the given node.
   double TotalProcessingTime(std::shared_ptr<Node> node);
 
@@ -766,6 +818,12 @@ class Model {
   // Determines the time the optimization loop should wait between
   // running optimizations.
   int64 optimization_period_ms_ TF_GUARDED_BY(mu_);
+
+  // Minimum time between two logged stats summaries; disabled if not positive.
+  int64 stats_dump_period_ms_ TF_GUARDED_BY(mu_);
+
+  // The outcome of the most recent optimization.
+  ModelProto::OptimizationPlan optimization_plan_ TF_GUARDED_BY(mu_);
 };
 
 }  // namespace model
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -1136,6 +1137,92 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
                          ::testing::Values(0, 1));
 
+class OptimizeRamBudgetTest
+    : public ::testing::TestWithParam<model::AutotuneAlgorithm> {};
+
+TEST_P(OptimizeRamBudgetTest, Model) {
+  const model::AutotuneAlgorithm algorithm = GetParam();
+
+  std::shared_ptr<mutex> mutex1 = std::make_shared<mutex>();
+  std::shared_ptr<condition_variable> cv1 =
+      std::make_shared<condition_variable>();
+  std::shared_ptr<Node> node1 = model::MakeAsyncKnownRatioNode(
+      {1, "1", nullptr}, 1,
+      {model::MakeParameter("parallelism",
+                            std::make_shared<SharedState>(
+                                /*value=*/model::kAutotune, mutex1, cv1),
+                            /*min=*/1, /*max=*/5)});
+  node1->record_buffer_event(100, 1);
+  node1->record_element();
+
+  std::shared_ptr<mutex> mutex2 = std::make_shared<mutex>();
+  std::shared_ptr<condition_variable> cv2 =
+      std::make_shared<condition_variable>();
+  std::shared_ptr<Node> node2 = model::MakeAsyncInterleaveManyNode(
+      {2, "2", node1},
+      {model::MakeParameter("parallelism",
+                            std::make_shared<SharedState>(
+                                /*value=*/model::kAutotune, mutex2, cv2),
+                            /*min=*/1, /*max=*/7)});
+  node2->record_buffer_event(100, 1);
+  node2->record_element();
+
+  model::Model model;
+  model.AddNode([&node1](model::Node::Args args) { return node1; }, "1",
+                nullptr, &node1);
+  model.AddNode([&node2](model::Node::Args args) { return node2; }, "2", node1,
+                &node2);
+
+  // Each unit of parallelism buffers an element of 50 bytes on average, so
+  // the budget leaves room for four units in total.
+  const int64 ram_budget = 200;
+  model.Optimize(algorithm, 40, ram_budget, 0);
+  EXPECT_LE(node1->parameter_value("parallelism") +
+                node2->parameter_value("parallelism"),
+            4);
+
+  ModelProto model_proto;
+  TF_ASSERT_OK(model.ToProto(&model_proto));
+  const ModelProto::OptimizationPlan& plan = model_proto.optimization_plan();
+  EXPECT_EQ(plan.ram_budget(), ram_budget);
+  EXPECT_GT(plan.maximum_buffered_bytes(), 0);
+  EXPECT_LE(plan.maximum_buffered_bytes(), ram_budget);
+  if (algorithm == model::AutotuneAlgorithm::HILL_CLIMB) {
+    EXPECT_EQ(plan.maximum_buffered_bytes(), ram_budget);
+    EXPECT_TRUE(plan.ram_budget_limited());
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Test, OptimizeRamBudgetTest,
+                         ::testing::Values(0, 1));
+
+TEST(StatsSummaryTest, Model) {
+  std::shared_ptr<Node> node1 = model::MakeKnownRatioNode({1, "1", nullptr}, 2);
+  std::shared_ptr<Node> node2 = model::MakeSourceNode({2, "2", node1});
+  model::Model model;
+  model.AddNode([&node1](model::Node::Args args) { return node1; }, "1",
+                nullptr, &node1);
+  model.AddNode([&node2](model::Node::Args args) { return node2; }, "2", node1,
+                &node2);
+  for (int i = 0; i < 10; ++i) {
+    node1->record_element();
+    node1->record_element_bytes(1024);
+    node1->record_get_next_latency(2000);
+    node1->record_wait_time(1000);
+  }
+
+  const string node1_summary = node1->StatsSummary();
+  EXPECT_TRUE(str_util::StartsWith(node1_summary, "1(id:1): elements=10 "));
+  EXPECT_TRUE(str_util::StrContains(node1_summary, "get_next_us[p50="));
+  EXPECT_TRUE(str_util::StrContains(node1_summary, "avg=1024 "));
+
+  std::vector<string> lines =
+      str_util::Split(model.StatsSummary(), '\n', str_util::SkipEmpty());
+  ASSERT_EQ(lines.size(), 2);
+  EXPECT_EQ(lines[0], node1_summary);
+  EXPECT_TRUE(str_util::StartsWith(lines[1], "2(id:2): elements=0 "));
+}
+
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
   EXPECT_FALSE(source->is_recording());
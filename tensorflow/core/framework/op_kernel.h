@@ -692,6 +692,11 @@ class OpKernelContext {
     // TensorSliceReaderCache support.
     checkpoint::TensorSliceReaderCacheWrapper* slice_reader_cache = nullptr;
 
+    // If not null, the allocator used instead of the device's allocator for
+    // allocations with default attributes during this step (see
+    // RunOptions.Experimental.use_step_arena_allocator).
+    Allocator* step_allocator = nullptr;
+
     // Support for forwarding reservations (used by ScopedAllocator).
     static constexpr int kNeverForward = -2;
     static constexpr int kNoReservation = -1;
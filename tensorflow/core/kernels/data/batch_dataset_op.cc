@@ -68,6 +68,12 @@ class BatchDatasetOp::Dataset : public DatasetBase {
              {"parallel_copy", parallel_copy ? "true" : "false"}}) {
     input_->Ref();
 
+    // When every batch has statically known shape, the iterator allocates the
+    // output tensors up front and has the input write each element directly
+    // into its slice.
+    preallocate_batch_ =
+        drop_remainder_ || input_->Cardinality() == kInfiniteCardinality;
+
     // NOTE(mrry): Currently we implement "batch up to" semantics. If
     // we could tell statically that the input dataset is infinite,
     // then we could always report `batch_size` as the 0th dimension.
@@ -77,6 +83,7 @@ class BatchDatasetOp::Dataset : public DatasetBase {
       if (drop_remainder_ || input_->Cardinality() == kInfiniteCardinality) {
         output_shapes_.emplace_back(
             PartialTensorShape({batch_size_}).Concatenate(input_shape));
+        preallocate_batch_ &= input_shape.IsFullyDefined();
       } else {
         output_shapes_.emplace_back(
             PartialTensorShape({-1}).Concatenate(input_shape));
@@ -157,6 +164,9 @@ class BatchDatasetOp::Dataset : public DatasetBase {
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
+      if (dataset()->preallocate_batch_) {
+        return GetNextIntoPreallocatedBatch(ctx, out_tensors, end_of_sequence);
+      }
       // Each row of `batch_elements` is a tuple of tensors from the
       // input iterator.
       std::vector<std::vector<Tensor>> batch_elements;
@@ -192,13 +202,8 @@ class BatchDatasetOp::Dataset : public DatasetBase {
       }
 
       // Copy the retrieved batch elements into one output tensor per tuple
-      // component.
-      //
-      // NOTE(mrry): If the input or output sizes are statically known, we
-      // could potentially read the input values in-place into their
-      // respective slice locations. This would require a different GetNext()
-      // overload that supports zero-copy, and might make sense in an
-      // optimization pass.
+      // component. When the output shapes are statically known,
+      // `GetNextIntoPreallocatedBatch()` is used instead.
       TF_RETURN_IF_ERROR(CopyBatch(/*parallel_copy=*/dataset()->parallel_copy_,
                                    ctx, out_tensors, &batch_elements));
 
@@ -239,6 +244,52 @@ class BatchDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
+    // Allocates one output tensor per tuple component and has the input
+    // iterator write each element in-place into its slice, avoiding the
+    // intermediate per-element tensors and the copy in `CopyBatch()`.
+    Status GetNextIntoPreallocatedBatch(IteratorContext* ctx,
+                                        std::vector<Tensor>* out_tensors,
+                                        bool* end_of_sequence) {
+      std::vector<Tensor> batch;
+      batch.reserve(dataset()->output_shapes_.size());
+      for (size_t i = 0; i < dataset()->output_shapes_.size(); ++i) {
+        TensorShape shape;
+        dataset()->output_shapes_[i].AsTensorShape(&shape);
+        batch.emplace_back(ctx->allocator({}),
+                           dataset()->output_dtypes()[i], shape);
+        if (!batch.back().IsInitialized()) {
+          return errors::ResourceExhausted(
+              "Failed to allocate memory for the batch of component ", i);
+        }
+      }
+      int64 num_elements = 0;
+      {
+        mutex_lock l(mu_);
+        if (!input_impl_) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        *end_of_sequence = false;
+        for (; num_elements < dataset()->batch_size_; ++num_elements) {
+          TF_RETURN_IF_ERROR(input_impl_->GetNextIntoSlice(
+              ctx, num_elements, &batch, end_of_sequence));
+          if (*end_of_sequence) {
+            input_impl_.reset();
+            break;
+          }
+        }
+      }
+      // Partial batches are only possible when `drop_remainder` is set, in
+      // which case they are dropped.
+      if (num_elements < dataset()->batch_size_) {
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+      *out_tensors = std::move(batch);
+      *end_of_sequence = false;
+      return Status::OK();
+    }
+
     mutex mu_;
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
   };
@@ -250,6 +301,9 @@ class BatchDatasetOp::Dataset : public DatasetBase {
   const DatasetBase* const input_;
   const int op_version_;
   std::vector<PartialTensorShape> output_shapes_;
+  // Whether the iterator writes input elements directly into preallocated
+  // output tensors. Set when all output shapes are fully defined.
+  bool preallocate_batch_;
   const TraceMeMetadata traceme_metadata_;
 };
 
@@ -283,6 +283,37 @@ IteratorSaveAndRestoreTestCases() {
 ITERATOR_SAVE_AND_RESTORE_TEST_P(BatchDatasetOpTest, BatchDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+// Batches a `TensorSliceDataset` with statically known shapes, so that the
+// elements are written directly into the preallocated output batches.
+BatchDatasetParams PreallocatedBatchDatasetParams() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64>(TensorShape{5, 2},
+                                          {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}),
+                      CreateTensor<tstring>(TensorShape{5},
+                                            {"a", "b", "c", "d", "e"})},
+      /*node_name=*/"tensor_slice");
+  return BatchDatasetParams(std::move(tensor_slice_dataset_params),
+                            /*batch_size=*/2,
+                            /*drop_remainder=*/true,
+                            /*parallel_copy=*/false,
+                            /*output_dtypes=*/{DT_INT64, DT_STRING},
+                            /*output_shapes=*/
+                            {PartialTensorShape({2, 2}),
+                             PartialTensorShape({2})},
+                            /*node_name=*/kNodeName);
+}
+
+TEST_F(BatchDatasetOpTest, PreallocatedBatch) {
+  auto dataset_params = PreallocatedBatchDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorGetNext(
+      {CreateTensor<int64>(TensorShape({2, 2}), {0, 1, 2, 3}),
+       CreateTensor<tstring>(TensorShape({2}), {"a", "b"}),
+       CreateTensor<int64>(TensorShape({2, 2}), {4, 5, 6, 7}),
+       CreateTensor<tstring>(TensorShape({2}), {"c", "d"})},
+      /*compare_order=*/true));
+}
+
 TEST_F(BatchDatasetOpTest, InvalidBatchSize) {
   auto batch_dataset_params = InvalidBatchSizeBatchDatasetParams();
   EXPECT_EQ(Initialize(batch_dataset_params).code(),
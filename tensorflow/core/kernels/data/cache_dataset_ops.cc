@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/dataset_utils.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
@@ -35,6 +36,8 @@ namespace data {
 /* static */ constexpr const char* const CacheDatasetOp::kDatasetType;
 /* static */ constexpr const char* const CacheDatasetOp::kInputDataset;
 /* static */ constexpr const char* const CacheDatasetOp::kFileName;
+/* static */ constexpr const char* const CacheDatasetOp::kMemoryBudget;
+/* static */ constexpr const char* const CacheDatasetOp::kUseMmap;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputTypes;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputShapes;
 
@@ -50,6 +53,8 @@ constexpr char kCurIndex[] = "cur_index";
 constexpr char kShardId[] = "shard_id";
 constexpr char kCreatedAt[] = "Created at";
 constexpr char kMemoryDatasetPrefix[] = "Memory";
+constexpr char kHybridDatasetPrefix[] = "Hybrid";
+constexpr char kSpillKeyStrFormat[] = "%010zu_%05zu";
 constexpr char kMemoryCache[] = "MemoryCache";
 constexpr char kCacheClaimed[] = "cache_claimed";
 constexpr char kCacheSize[] = "cache_size";
@@ -66,15 +71,114 @@ constexpr char kIncompleteCacheErrorMessage[] =
     "an input pipeline similar to `dataset.cache().take(k).repeat()`. You "
     "should use `dataset.take(k).cache().repeat()` instead.";
 
+// Deletes all files of the tensor bundle with the given prefix, including
+// temporary files of an unfinished `BundleWriter`, logging failures.
+void DeleteBundleFiles(Env* env, const string& prefix) {
+  std::vector<string> files;
+  Status s = env->GetMatchingPaths(strings::StrCat(prefix, ".*"), &files);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to get matching files on " << prefix
+                 << ".* : " << s.ToString();
+  }
+  for (const string& path : files) {
+    s = env->DeleteFile(path);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete " << path << " : " << s.ToString();
+    }
+  }
+}
+
+// A thread-safe data structure for the contents of a hybrid cache.
+//
+// The first `hot_size()` elements of the cached dataset are held in memory and
+// the following `num_spilled()` elements are stored in the tensor bundle with
+// prefix `spill_prefix()`. Each writer spills to its own bundle (see
+// `NewSpillPrefix()`) and only the first writer to complete the cache gets to
+// publish its bundle; the bundle is deleted when the cache is destroyed. Spill
+// prefixes include a random id of the cache, so that caches of different
+// datasets, or of different processes, using the same filename do not collide.
+class HybridCache {
+ public:
+  HybridCache(Env* env, string filename)
+      : env_(env), filename_(std::move(filename)), id_(random::New64()) {}
+
+  ~HybridCache() {
+    mutex_lock l(mu_);
+    if (completed_ && num_spilled_ > 0) {
+      DeleteBundleFiles(env_, spill_prefix_);
+    }
+  }
+
+  // Returns a prefix for a new spill bundle.
+  string NewSpillPrefix() {
+    mutex_lock l(mu_);
+    return strings::StrCat(filename_, "_", strings::Hex(id_), "_",
+                           num_writers_++);
+  }
+
+  // Marks the cache as completed. Returns false if the cache had already been
+  // completed by another writer, in which case the arguments are discarded.
+  bool Complete(std::vector<std::vector<Tensor>>&& hot,
+                const string& spill_prefix, size_t num_spilled) {
+    mutex_lock l(mu_);
+    if (completed_) {
+      return false;
+    }
+    hot_ = std::move(hot);
+    spill_prefix_ = spill_prefix;
+    num_spilled_ = num_spilled;
+    completed_ = true;
+    return true;
+  }
+
+  bool IsCompleted() {
+    tf_shared_lock l(mu_);
+    return completed_;
+  }
+
+  const std::vector<Tensor>& hot_at(size_t index) {
+    tf_shared_lock l(mu_);
+    DCHECK(index < hot_.size());
+    return hot_[index];
+  }
+
+  size_t hot_size() {
+    tf_shared_lock l(mu_);
+    return hot_.size();
+  }
+
+  size_t num_spilled() {
+    tf_shared_lock l(mu_);
+    return num_spilled_;
+  }
+
+  string spill_prefix() {
+    tf_shared_lock l(mu_);
+    return spill_prefix_;
+  }
+
+ private:
+  Env* const env_;
+  const string filename_;
+  const uint64 id_;
+  mutex mu_;
+  bool completed_ TF_GUARDED_BY(mu_) = false;
+  int64 num_writers_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<std::vector<Tensor>> hot_ TF_GUARDED_BY(mu_);
+  string spill_prefix_ TF_GUARDED_BY(mu_);
+  size_t num_spilled_ TF_GUARDED_BY(mu_) = 0;
+};
+
 }  // namespace
 
 class CacheDatasetOp::FileDatasetBase : public DatasetBase {
  public:
   FileDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
-                  string filename, Env* env)
+                  string filename, Env* env, bool use_mmap)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         filename_(std::move(filename)),
+        use_mmap_(use_mmap),
         env_(env),
         num_tensors_(input->output_dtypes().size()),
         tensor_index_padding_size_(StringPaddingSize(num_tensors_)),
@@ -124,6 +228,9 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
  protected:
   const DatasetBase* const input_;
   const tstring filename_;
+  // Whether the cache files are memory-mapped when read back, in which case
+  // they are also written with tensor data aligned for aliasing.
+  const bool use_mmap_;
 
  private:
   static size_t StringPaddingSize(size_t num_tensors) {
@@ -135,6 +242,20 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
                            tensor_index);
   }
 
+  BundleWriter::Options WriterOptions() const {
+    BundleWriter::Options options;
+    if (use_mmap_) {
+      options.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    }
+    return options;
+  }
+
+  BundleReader::Options ReaderOptions() const {
+    BundleReader::Options options;
+    options.use_mmap = use_mmap_;
+    return options;
+  }
+
   class FileIterator : public DatasetIterator<FileDatasetBase> {
    public:
     explicit FileIterator(const Params& params)
@@ -375,7 +496,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         }
         filename_ = strings::StrCat(dataset()->filename_, "_", shard_id_);
         lockfile_ = strings::StrCat(filename_, kLockFileSuffix);
-        writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_);
+        writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_,
+                                                  dataset()->WriterOptions());
         return Status::OK();
       }
 
@@ -437,7 +559,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         // conditions are not met since BundleWriter's constructor creates
         // new temp files which can delete the temp files created by a
         // BundleWriter in another Session.
-        writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_);
+        writer_ = absl::make_unique<BundleWriter>(dataset()->env_, filename_,
+                                                  dataset()->WriterOptions());
         lockfile_created_ = true;
         return Status::OK();
       }
@@ -491,7 +614,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       explicit FileReaderIterator(const Params& params)
           : DatasetIterator<FileDatasetBase>(params),
             cur_index_(0),
-            reader_(dataset()->env_, dataset()->filename_),
+            reader_(dataset()->env_, dataset()->filename_,
+                    dataset()->ReaderOptions()),
             iterator_restored_(false) {}
 
       Status GetNextInternal(IteratorContext* ctx,
@@ -626,7 +750,10 @@ class CacheDatasetOp::FileDataset : public CacheDatasetOp::FileDatasetBase {
     TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph));
     Node* filename = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename));
-    TF_RETURN_IF_ERROR(b->AddDataset(this, {input_graph, filename}, output));
+    AttrValue use_mmap;
+    b->BuildAttrValue(use_mmap_, &use_mmap);
+    TF_RETURN_IF_ERROR(b->AddDataset(this, {input_graph, filename},
+                                     {{kUseMmap, use_mmap}}, output));
     return Status::OK();
   }
 };
@@ -634,9 +761,453 @@ class CacheDatasetOp::FileDataset : public CacheDatasetOp::FileDatasetBase {
 class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
  public:
   explicit FileDatasetV2(OpKernelContext* ctx, const DatasetBase* input,
-                         string filename, Env* env,
+                         string filename, Env* env, bool use_mmap,
                          const Tensor& resource_handle)
-      : FileDatasetBase(ctx, input, filename, env),
+      : FileDatasetBase(ctx, input, filename, env, use_mmap),
+        resource_handle_(resource_handle) {}
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
+    Node* filename_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename_node));
+    Node* resource_handle_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddTensor(resource_handle_, &resource_handle_node));
+    AttrValue use_mmap;
+    b->BuildAttrValue(use_mmap_, &use_mmap);
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {input_node, filename_node, resource_handle_node},
+                      {{kUseMmap, use_mmap}}, output));
+    return Status::OK();
+  }
+
+ private:
+  const Tensor resource_handle_;
+};
+
+// A dataset that caches the first `memory_budget` bytes of its input in
+// memory and spills the remaining elements to a tensor bundle with prefix
+// `<filename>_<random id>_<writer>`.
+//
+// Unlike `FileDatasetBase`, the spilled elements are not meant to outlive the
+// dataset: the spill files are private to this dataset, are never reused
+// across runs, and are deleted when the dataset is destroyed. Like
+// `MemoryDatasetBase`, the cache is populated by the first iterator that fully
+// reads the input and is shared by all subsequent iterators of the dataset.
+class CacheDatasetOp::HybridDatasetBase : public DatasetBase {
+ public:
+  HybridDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
+                    string filename, Env* env, int64 memory_budget)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        filename_(std::move(filename)),
+        env_(env),
+        memory_budget_(memory_budget),
+        num_tensors_(input->output_dtypes().size()),
+        cache_(std::make_shared<HybridCache>(env, filename_)) {
+    input_->Ref();
+  }
+
+  ~HybridDatasetBase() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    name_utils::IteratorPrefixParams params;
+    params.dataset_prefix = kHybridDatasetPrefix;
+    return absl::make_unique<HybridIterator>(HybridIterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix, params)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.dataset_prefix = kHybridDatasetPrefix;
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64 Cardinality() const override { return input_->Cardinality(); }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return Status::OK();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  const DatasetBase* const input_;
+  const tstring filename_;
+  Env* const env_;
+  const int64 memory_budget_;
+
+ private:
+  static string SpillKey(size_t item_index, size_t tensor_index) {
+    return strings::Printf(kSpillKeyStrFormat, item_index, tensor_index);
+  }
+
+  class HybridIterator : public DatasetIterator<HybridDatasetBase> {
+   public:
+    explicit HybridIterator(const Params& params)
+        : DatasetIterator<HybridDatasetBase>(params),
+          cache_(params.dataset->cache_) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      return InitializeIterator(ctx, cache_->IsCompleted());
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      return iterator_->GetNext(ctx, out_tensors, end_of_sequence);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      if (read_from_cache_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCacheCompleted), ""));
+      }
+      return SaveInput(ctx, writer, iterator_);
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      iterator_.reset();
+      const bool read_from_cache = reader->Contains(full_name(kCacheCompleted));
+      if (!read_from_cache || cache_->IsCompleted()) {
+        TF_RETURN_IF_ERROR(InitializeIterator(ctx, read_from_cache));
+        return RestoreInput(ctx, reader, iterator_);
+      }
+      // The checkpoint was taken while reading from a cache that does not
+      // exist in this process (the spill files do not outlive the dataset).
+      // Rebuild the cache by fast-forwarding a writer to the saved position.
+      TF_RETURN_IF_ERROR(InitializeIterator(ctx, /*read_from_cache=*/false));
+      int64 index;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(
+          FullName(strings::StrCat(prefix(), kImpl), kIndex), &index));
+      std::vector<Tensor> unused;
+      bool end_of_sequence = false;
+      for (int64 i = 0; i < index && !end_of_sequence; ++i) {
+        unused.clear();
+        TF_RETURN_IF_ERROR(iterator_->GetNext(ctx, &unused, &end_of_sequence));
+      }
+      return Status::OK();
+    }
+
+   private:
+    // Passes through the elements of the input, keeping them in memory until
+    // the memory budget is exhausted and spilling every subsequent element to
+    // a tensor bundle.
+    class HybridWriterIterator : public DatasetIterator<HybridDatasetBase> {
+     public:
+      explicit HybridWriterIterator(const Params& params,
+                                    std::shared_ptr<HybridCache> cache)
+          : DatasetIterator<HybridDatasetBase>(params),
+            cache_(std::move(cache)),
+            spill_prefix_(cache_->NewSpillPrefix()) {}
+
+      ~HybridWriterIterator() override {
+        mutex_lock l(mu_);
+        if (!published_) {
+          if (!hot_.empty() || num_spilled_ > 0) {
+            LOG(WARNING) << kIncompleteCacheErrorMessage;
+          }
+          if (spill_writer_) {
+            DeleteBundleFiles(dataset()->env_, spill_prefix_);
+          }
+        }
+      }
+
+      Status Initialize(IteratorContext* ctx) override {
+        return dataset()->input_->MakeIterator(ctx, this, prefix(),
+                                               &input_impl_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
+        if (*end_of_sequence) {
+          if (!passthrough_ && !cache_->IsCompleted()) {
+            TF_RETURN_IF_ERROR(Finish());
+          }
+          return Status::OK();
+        }
+        if (passthrough_) {
+          return Status::OK();
+        }
+        if (out_tensors->size() != dataset()->num_tensors_) {
+          return errors::Internal(
+              "Upstream iterator returned invalid number of tensors. "
+              "Expected ",
+              dataset()->num_tensors_, " got: ", out_tensors->size());
+        }
+        const int64 element_bytes = GetAllocatedBytes(*out_tensors);
+        if (!spill_writer_ &&
+            hot_bytes_ + element_bytes <= dataset()->memory_budget_) {
+          RecordBufferEnqueue(ctx, *out_tensors);
+          hot_.emplace_back(*out_tensors);
+          hot_bytes_ += element_bytes;
+          return Status::OK();
+        }
+        // Once the first element has been spilled, all subsequent elements
+        // are spilled too so that the cache can be read back in order.
+        TF_RETURN_IF_ERROR(EnsureSpillWriterExists());
+        for (size_t i = 0; i < out_tensors->size(); ++i) {
+          TF_RETURN_IF_ERROR(
+              spill_writer_->Add(SpillKey(num_spilled_, i), (*out_tensors)[i]));
+        }
+        num_spilled_++;
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        return SaveInput(ctx, writer, input_impl_);
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        // The partially written cache is not part of the checkpoint, so the
+        // rest of this epoch is passed through without being cached. The
+        // cache is populated by the next iterator that reads the entire
+        // input.
+        passthrough_ = true;
+        return RestoreInput(ctx, reader, input_impl_);
+      }
+
+     private:
+      Status EnsureSpillWriterExists() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spill_writer_) {
+          return Status::OK();
+        }
+        if (dataset()->env_->FileExists(MetaFilename(spill_prefix_)).ok()) {
+          return errors::AlreadyExists("Existing cache files found: \n",
+                                       MetaFilename(spill_prefix_), "\n",
+                                       "To continue delete the above file.");
+        }
+        spill_writer_ =
+            absl::make_unique<BundleWriter>(dataset()->env_, spill_prefix_);
+        return spill_writer_->status();
+      }
+
+      Status Finish() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spill_writer_) {
+          TF_RETURN_IF_ERROR(spill_writer_->Finish());
+        }
+        VLOG(2) << "Finalizing the hybrid cache with " << hot_.size()
+                << " elements (" << hot_bytes_ << " bytes) in memory and "
+                << num_spilled_ << " elements spilled to " << spill_prefix_;
+        published_ = cache_->Complete(std::move(hot_), spill_prefix_,
+                                      num_spilled_);
+        if (!published_ && spill_writer_) {
+          DeleteBundleFiles(dataset()->env_, spill_prefix_);
+        }
+        hot_.clear();
+        num_spilled_ = 0;
+        spill_writer_.reset();
+        return Status::OK();
+      }
+
+      mutex mu_;
+      std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+      const std::shared_ptr<HybridCache> cache_;
+      const string spill_prefix_;
+      std::vector<std::vector<Tensor>> hot_ TF_GUARDED_BY(mu_);
+      int64 hot_bytes_ TF_GUARDED_BY(mu_) = 0;
+      std::unique_ptr<BundleWriter> spill_writer_ TF_GUARDED_BY(mu_);
+      size_t num_spilled_ TF_GUARDED_BY(mu_) = 0;
+      // Whether elements should be passed through without being cached.
+      bool passthrough_ TF_GUARDED_BY(mu_) = false;
+      // Whether this iterator's elements were published to `cache_`.
+      bool published_ TF_GUARDED_BY(mu_) = false;
+    };  // HybridWriterIterator
+
+    // Produces the in-memory elements of a completed cache followed by the
+    // elements read back from its spill bundle.
+    class HybridReaderIterator : public DatasetIterator<HybridDatasetBase> {
+     public:
+      explicit HybridReaderIterator(const Params& params,
+                                    std::shared_ptr<HybridCache> cache)
+          : DatasetIterator<HybridDatasetBase>(params),
+            cache_(std::move(cache)) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        // As in `MemoryReaderIterator`, the in-memory part of the cache is
+        // attributed to the iterator for the purpose of performance modeling.
+        for (size_t i = 0; i < cache_->hot_size(); ++i) {
+          RecordBufferEnqueue(ctx, cache_->hot_at(i));
+        }
+        return Status::OK();
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        const size_t hot_size = cache_->hot_size();
+        if (index_ < hot_size) {
+          const std::vector<Tensor>& cache_tensors = cache_->hot_at(index_);
+          out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
+                              cache_tensors.end());
+          index_++;
+          *end_of_sequence = false;
+          return Status::OK();
+        }
+        if (index_ >= hot_size + cache_->num_spilled()) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        const size_t spill_index = index_ - hot_size;
+        if (!reader_) {
+          reader_ = absl::make_unique<BundleReader>(dataset()->env_,
+                                                    cache_->spill_prefix());
+          TF_RETURN_IF_ERROR(reader_->status());
+          reader_->Seek(SpillKey(spill_index, 0));
+        }
+        out_tensors->clear();
+        out_tensors->resize(dataset()->num_tensors_);
+        for (size_t i = 0; i < dataset()->num_tensors_; ++i) {
+          if (!reader_->Valid()) {
+            return errors::DataLoss("Hybrid cache spill file ",
+                                    cache_->spill_prefix(),
+                                    " ended unexpectedly at element ",
+                                    spill_index);
+          }
+          DCHECK_EQ(reader_->key(), SpillKey(spill_index, i));
+          TF_RETURN_IF_ERROR(reader_->ReadCurrent(&(*out_tensors)[i]));
+          reader_->Next();
+        }
+        TF_RETURN_IF_ERROR(reader_->status());
+        index_++;
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kIndex), index_));
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        {
+          int64 temp;
+          TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kIndex), &temp));
+          index_ = static_cast<size_t>(temp);
+        }
+        // The spill reader is repositioned on the next call to `GetNext`.
+        reader_.reset();
+        return Status::OK();
+      }
+
+     private:
+      mutex mu_;
+      const std::shared_ptr<HybridCache> cache_;
+      size_t index_ TF_GUARDED_BY(mu_) = 0;
+      std::unique_ptr<BundleReader> reader_ TF_GUARDED_BY(mu_);
+    };  // HybridReaderIterator
+
+    Status InitializeIterator(IteratorContext* ctx, bool read_from_cache)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      read_from_cache_ = read_from_cache;
+      if (read_from_cache) {
+        iterator_ = absl::make_unique<HybridReaderIterator>(
+            HybridReaderIterator::Params{dataset(),
+                                         strings::StrCat(prefix(), kImpl)},
+            cache_);
+      } else {
+        iterator_ = absl::make_unique<HybridWriterIterator>(
+            HybridWriterIterator::Params{dataset(),
+                                         strings::StrCat(prefix(), kImpl)},
+            cache_);
+      }
+      TF_RETURN_IF_ERROR(iterator_->InitializeBase(ctx, this));
+      return iterator_->Initialize(ctx);
+    }
+
+    mutex mu_;
+    const std::shared_ptr<HybridCache> cache_;
+    // Whether `iterator_` is a `HybridReaderIterator`.
+    bool read_from_cache_ TF_GUARDED_BY(mu_) = false;
+    std::unique_ptr<IteratorBase> iterator_ TF_GUARDED_BY(mu_);
+  };  // HybridIterator
+
+  const size_t num_tensors_;
+  const std::shared_ptr<HybridCache> cache_;
+};  // HybridDatasetBase
+
+class CacheDatasetOp::HybridDataset : public CacheDatasetOp::HybridDatasetBase {
+ public:
+  using HybridDatasetBase::HybridDatasetBase;
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
+    Node* filename_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename_node));
+    AttrValue memory_budget;
+    b->BuildAttrValue(memory_budget_, &memory_budget);
+    TF_RETURN_IF_ERROR(b->AddDataset(this, {input_node, filename_node},
+                                     {{kMemoryBudget, memory_budget}},
+                                     output));
+    return Status::OK();
+  }
+};
+
+class CacheDatasetOp::HybridDatasetV2
+    : public CacheDatasetOp::HybridDatasetBase {
+ public:
+  HybridDatasetV2(OpKernelContext* ctx, const DatasetBase* input,
+                  string filename, Env* env, int64 memory_budget,
+                  const Tensor& resource_handle)
+      : HybridDatasetBase(ctx, input, std::move(filename), env, memory_budget),
         resource_handle_(resource_handle) {}
 
  protected:
@@ -649,8 +1220,11 @@ class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename_node));
     Node* resource_handle_node = nullptr;
     TF_RETURN_IF_ERROR(b->AddTensor(resource_handle_, &resource_handle_node));
+    AttrValue memory_budget;
+    b->BuildAttrValue(memory_budget_, &memory_budget);
     TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {input_node, filename_node, resource_handle_node}, output));
+        this, {input_node, filename_node, resource_handle_node},
+        {{kMemoryBudget, memory_budget}}, output));
     return Status::OK();
   }
 
@@ -1018,7 +1592,18 @@ class CacheDatasetOp::MemoryDatasetV2
 
 CacheDatasetOp::CacheDatasetOp(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {
+  if (ctx->HasAttr(kMemoryBudget)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kMemoryBudget, &memory_budget_));
+    OP_REQUIRES(ctx, memory_budget_ >= 0,
+                errors::InvalidArgument("`", kMemoryBudget,
+                                        "` must be non-negative but got ",
+                                        memory_budget_));
+  }
+  if (ctx->HasAttr(kUseMmap)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kUseMmap, &use_mmap_));
+  }
+}
 
 void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
@@ -1065,12 +1650,20 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       // Ownership of manager is transferred onto `MemoryDataset`.
       *output = new MemoryDataset(ctx, input, manager, std::move(handle));
     }
+  } else if (memory_budget_ > 0) {
+    if (op_version_ == 2) {
+      *output = new HybridDatasetV2(ctx, input, filename, ctx->env(),
+                                    memory_budget_, ctx->input(2));
+    } else {
+      *output = new HybridDataset(ctx, input, filename, ctx->env(),
+                                  memory_budget_);
+    }
   } else {
     if (op_version_ == 2) {
-      *output =
-          new FileDatasetV2(ctx, input, filename, ctx->env(), ctx->input(2));
+      *output = new FileDatasetV2(ctx, input, filename, ctx->env(), use_mmap_,
+                                  ctx->input(2));
     } else {
-      *output = new FileDataset(ctx, input, filename, ctx->env());
+      *output = new FileDataset(ctx, input, filename, ctx->env(), use_mmap_);
     }
   }
 }
@@ -23,11 +23,14 @@ namespace data {
 class CacheDatasetOp : public UnaryDatasetOpKernel {
  public:
   class FileDatasetBase;
+  class HybridDatasetBase;
   class MemoryDatasetBase;
 
   static constexpr const char* const kDatasetType = "Cache";
   static constexpr const char* const kInputDataset = "input_dataset";
   static constexpr const char* const kFileName = "filename";
+  static constexpr const char* const kMemoryBudget = "memory_budget_bytes";
+  static constexpr const char* const kUseMmap = "use_mmap";
   static constexpr const char* const kOutputTypes = "output_types";
   static constexpr const char* const kOutputShapes = "output_shapes";
 
@@ -40,10 +43,17 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
  private:
   class FileDataset;
   class FileDatasetV2;
+  class HybridDataset;
+  class HybridDatasetV2;
   class MemoryDataset;
   class MemoryDatasetV2;
 
   const int op_version_;
+  // If positive and a filename is given, up to this many bytes of the input
+  // are cached in memory and the remaining elements are spilled to the file.
+  int64 memory_budget_ = 0;
+  // Whether file caches are read back through memory-mapped, zero-copy reads.
+  bool use_mmap_ = false;
 };
 
 }  // namespace data
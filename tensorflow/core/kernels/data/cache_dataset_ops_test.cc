@@ -29,10 +29,13 @@ class CacheDatasetParams : public DatasetParams {
   CacheDatasetParams(T input_dataset_params, string filename,
                      DataTypeVector output_dtypes,
                      std::vector<PartialTensorShape> output_shapes,
-                     string node_name)
+                     string node_name, int64 memory_budget = 0,
+                     bool use_mmap = false)
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
-        filename_(filename) {
+        filename_(filename),
+        memory_budget_(memory_budget),
+        use_mmap_(use_mmap) {
     input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
     iterator_prefix_ =
         name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
@@ -52,7 +55,9 @@ class CacheDatasetParams : public DatasetParams {
 
   Status GetAttributes(AttributeVector* attr_vector) const override {
     *attr_vector = {{CacheDatasetOp::kOutputTypes, output_dtypes_},
-                    {CacheDatasetOp::kOutputShapes, output_shapes_}};
+                    {CacheDatasetOp::kOutputShapes, output_shapes_},
+                    {CacheDatasetOp::kMemoryBudget, memory_budget_},
+                    {CacheDatasetOp::kUseMmap, use_mmap_}};
     return Status::OK();
   }
 
@@ -62,6 +67,8 @@ class CacheDatasetParams : public DatasetParams {
 
  private:
   string filename_;
+  int64 memory_budget_;
+  bool use_mmap_;
 };
 
 class CacheDatasetOpTest : public DatasetOpsTestBase {
@@ -145,6 +152,50 @@ CacheDatasetParams CacheDatasetParams4() {
                             kNodeName);
 }
 
+// Test case 5: cache data in memory up to a budget of one element and spill
+// the rest to file.
+CacheDatasetParams CacheDatasetParams5() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64>(TensorShape{3, 3, 1},
+                                          {0, 1, 2, 3, 4, 5, 6, 7, 8})},
+      /*node_name=*/"tensor_slice");
+  return CacheDatasetParams(
+      std::move(tensor_slice_dataset_params),
+      /*filename=*/io::JoinPath(testing::TmpDir(), "hybrid_cache_data"),
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({3, 1})}, kNodeName,
+      /*memory_budget=*/3 * sizeof(int64));
+}
+
+// Test case 6: cache data with a memory budget that fits the entire dataset.
+CacheDatasetParams CacheDatasetParams6() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64>(TensorShape{3, 3, 1},
+                                          {0, 1, 2, 3, 4, 5, 6, 7, 8})},
+      /*node_name=*/"tensor_slice");
+  return CacheDatasetParams(
+      std::move(tensor_slice_dataset_params),
+      /*filename=*/io::JoinPath(testing::TmpDir(), "hybrid_cache_data"),
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({3, 1})}, kNodeName,
+      /*memory_budget=*/1 << 20);
+}
+
+// Test case 7: cache data in file and read it back through memory-mapping.
+CacheDatasetParams CacheDatasetParams7() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64>(TensorShape{3, 3, 1},
+                                          {0, 1, 2, 3, 4, 5, 6, 7, 8}),
+                      CreateTensor<tstring>(TensorShape{3}, {"a", "b", "c"})},
+      /*node_name=*/"tensor_slice");
+  return CacheDatasetParams(
+      std::move(tensor_slice_dataset_params),
+      /*filename=*/io::JoinPath(testing::TmpDir(), "mmap_cache_data"),
+      /*output_dtypes=*/{DT_INT64, DT_STRING},
+      /*output_shapes=*/{PartialTensorShape({3, 1}), PartialTensorShape({})},
+      kNodeName, /*memory_budget=*/0, /*use_mmap=*/true);
+}
+
 std::vector<GetNextTestCase<CacheDatasetParams>> GetNextTestCases() {
   return {{/*dataset_params=*/CacheDatasetParams1(),
            /*expected_outputs=*/
@@ -157,7 +208,23 @@ std::vector<GetNextTestCase<CacheDatasetParams>> GetNextTestCases() {
            CreateTensors<int64>(TensorShape({3, 1}),
                                 {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}})},
           {/*dataset_params=*/CacheDatasetParams4(),
-           /*expected_outputs=*/{}}};
+           /*expected_outputs=*/{}},
+          {/*dataset_params=*/CacheDatasetParams5(),
+           /*expected_outputs=*/
+           CreateTensors<int64>(TensorShape({3, 1}),
+                                {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}})},
+          {/*dataset_params=*/CacheDatasetParams6(),
+           /*expected_outputs=*/
+           CreateTensors<int64>(TensorShape({3, 1}),
+                                {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}})},
+          {/*dataset_params=*/CacheDatasetParams7(),
+           /*expected_outputs=*/
+           {CreateTensor<int64>(TensorShape({3, 1}), {0, 1, 2}),
+            CreateTensor<tstring>(TensorShape({}), {"a"}),
+            CreateTensor<int64>(TensorShape({3, 1}), {3, 4, 5}),
+            CreateTensor<tstring>(TensorShape({}), {"b"}),
+            CreateTensor<int64>(TensorShape({3, 1}), {6, 7, 8}),
+            CreateTensor<tstring>(TensorShape({}), {"c"})}}};
 }
 
 class ParameterizedGetNextTest : public CacheDatasetOpTest,
@@ -199,6 +266,70 @@ TEST_P(ParameterizedGetNextTest, GetNext) {
 INSTANTIATE_TEST_SUITE_P(CacheDatasetOpTest, ParameterizedGetNextTest,
                          ::testing::ValuesIn(GetNextTestCases()));
 
+TEST_F(CacheDatasetOpTest, HybridCacheSpillsOverflowToFile) {
+  auto dataset_params = CacheDatasetParams5();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  while (!end_of_sequence) {
+    TF_EXPECT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                    &end_of_sequence));
+  }
+  std::vector<string> spill_files;
+  TF_ASSERT_OK(device_->env()->GetMatchingPaths(
+      strings::StrCat(cache_filename_, "_*"), &spill_files));
+  EXPECT_FALSE(spill_files.empty());
+}
+
+TEST_F(CacheDatasetOpTest, HybridCachesWithSameFilenameDoNotCollide) {
+  auto dataset_params = CacheDatasetParams5();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::unique_ptr<TestDataset> other_dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &other_dataset));
+  std::unique_ptr<TestIterator> other_iterator;
+  TF_ASSERT_OK(MakeIterator(dataset_params, *other_dataset, &other_iterator));
+
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  while (!end_of_sequence) {
+    TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                    &end_of_sequence));
+  }
+  std::vector<string> spill_files;
+  TF_ASSERT_OK(device_->env()->GetMatchingPaths(
+      strings::StrCat(cache_filename_, "_*"), &spill_files));
+  const size_t num_spill_files = spill_files.size();
+  EXPECT_GT(num_spill_files, 0);
+
+  end_of_sequence = false;
+  while (!end_of_sequence) {
+    TF_ASSERT_OK(other_iterator->GetNext(&out_tensors, &end_of_sequence));
+  }
+  TF_ASSERT_OK(device_->env()->GetMatchingPaths(
+      strings::StrCat(cache_filename_, "_*"), &spill_files));
+  EXPECT_EQ(spill_files.size(), 2 * num_spill_files);
+
+  // The spill files of a dataset are deleted with the dataset.
+  other_iterator.reset();
+  other_dataset.reset();
+  TF_ASSERT_OK(device_->env()->GetMatchingPaths(
+      strings::StrCat(cache_filename_, "_*"), &spill_files));
+  EXPECT_EQ(spill_files.size(), num_spill_files);
+}
+
+TEST_F(CacheDatasetOpTest, InvalidMemoryBudget) {
+  auto dataset_params = CacheDatasetParams(
+      TensorSliceDatasetParams(
+          /*components=*/{CreateTensor<int64>(TensorShape{1}, {0})},
+          /*node_name=*/"tensor_slice"),
+      /*filename=*/io::JoinPath(testing::TmpDir(), "hybrid_cache_data"),
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})}, kNodeName,
+      /*memory_budget=*/-1);
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
 TEST_F(CacheDatasetOpTest, DatasetNodeName) {
   auto dataset_params = CacheDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
@@ -298,7 +429,12 @@ IteratorSaveAndRestoreTestCases() {
                                 {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}})},
           {/*dataset_params=*/CacheDatasetParams4(),
            /*breakpoints=*/{0, 2, 4, 11},
-           /*expected_outputs=*/{}}};
+           /*expected_outputs=*/{}},
+          {/*dataset_params=*/CacheDatasetParams5(),
+           /*breakpoints=*/{0, 2, 4, 11},
+           /*expected_outputs=*/
+           CreateTensors<int64>(TensorShape({3, 1}),
+                                {{0, 1, 2}, {3, 4, 5}, {6, 7, 8}})}};
 }
 
 class ParameterizedIteratorSaveAndRestoreTest
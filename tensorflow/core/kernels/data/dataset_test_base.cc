@@ -98,6 +98,8 @@ string ToString(CompressionType compression_type) {
       return "RAW";
     case CompressionType::UNCOMPRESSED:
       return "";
+    case CompressionType::BLOCK_SNAPPY:
+      return "BLOCK_SNAPPY";
   }
 }
 
@@ -111,6 +113,7 @@ io::ZlibCompressionOptions GetZlibCompressionOptions(
     case CompressionType::RAW:
       return io::ZlibCompressionOptions::RAW();
     case CompressionType::UNCOMPRESSED:
+    case CompressionType::BLOCK_SNAPPY:
       LOG(WARNING) << "ZlibCompressionOptions does not have an option for "
                    << ToString(compression_type);
       return io::ZlibCompressionOptions::DEFAULT();
@@ -160,6 +163,9 @@ Status WriteDataToTFRecordFile(const string& filename,
   auto options = io::RecordWriterOptions::CreateRecordWriterOptions(
       ToString(params.compression_type));
   options.zlib_options.input_buffer_size = params.input_buffer_size;
+  if (params.block_size > 0) {
+    options.block_size = params.block_size;
+  }
   io::RecordWriter record_writer(file_writer.get(), options);
   for (const auto& record : records) {
     TF_RETURN_IF_ERROR(record_writer.WriteRecord(record));
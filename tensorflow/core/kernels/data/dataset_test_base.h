@@ -85,24 +85,34 @@ std::vector<Tensor> CreateTensors(
   return result;
 }
 
-enum class CompressionType { ZLIB = 0, GZIP = 1, RAW = 2, UNCOMPRESSED = 3 };
+enum class CompressionType {
+  ZLIB = 0,
+  GZIP = 1,
+  RAW = 2,
+  UNCOMPRESSED = 3,
+  BLOCK_SNAPPY = 4
+};
 
 // Returns a string representation for the given compression type.
 string ToString(CompressionType compression_type);
 
 // Gets the specified zlib compression options according to the compression
-// type. Note that `CompressionType::UNCOMPRESSED` is not supported because
+// type. Note that `CompressionType::UNCOMPRESSED` and
+// `CompressionType::BLOCK_SNAPPY` are not supported because
 // `ZlibCompressionOptions` does not have an option.
 io::ZlibCompressionOptions GetZlibCompressionOptions(
     CompressionType compression_type);
 
 // Used to specify parameters when writing data into files with compression.
 // `input_buffer_size` and `output_buffer_size` specify the input and output
-// buffer size when ZLIB and GZIP compression is used.
+// buffer size when ZLIB and GZIP compression is used. `block_size`, if
+// positive, specifies the block size of TFRecord files when BLOCK_SNAPPY
+// compression is used.
 struct CompressionParams {
   CompressionType compression_type = CompressionType::UNCOMPRESSED;
   int32 input_buffer_size = 0;
   int32 output_buffer_size = 0;
+  int64 block_size = 0;
 };
 
 // Writes the input data into the file without compression.
@@ -23,9 +23,14 @@ namespace experimental {
 
 class CompressElementOp : public OpKernel {
  public:
+  static constexpr const char* const kColumnar = "columnar";
+
   explicit CompressElementOp(OpKernelConstruction* ctx);
 
   void Compute(OpKernelContext* ctx) override;
+
+ private:
+  bool columnar_ = false;
 };
 
 class UncompressElementOp : public OpKernel {
@@ -71,6 +71,8 @@ namespace data {
 namespace {
 // Default interval between task list refreshes.
 const int64 kDefaultTaskRefreshIntervalMs = 1000;  // 1 second.
+// Maximum number of elements to fetch from a worker in one round trip.
+const int64 kMaxElementsPerRequest = 16;
 
 constexpr char kDataServiceDatasetV1[] = "DataServiceDataset";
 constexpr char kDataServiceDatasetV2[] = "DataServiceDatasetV2";
@@ -621,6 +623,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       std::shared_ptr<Task> task_to_process;
       while (true) {
         Result* result;
+        int64 max_elements = 1;
         {
           mutex_lock l(mu_);
           if (task_to_process) {
@@ -646,6 +649,8 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
             // Reserve a spot in the results_ queue.
             results_.emplace();
             result = &results_.back();
+          } else {
+            max_elements = ReserveElementsPerRequest();
           }
           DCHECK(task_to_process != nullptr);
           task_to_process->in_use = true;
@@ -655,14 +660,16 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
         Status s;
         if (StrictRoundRobin()) {
           s = GetElementTraced(task_to_process.get(), deadline_micros,
-                               /*enqueue_result=*/false, *result);
+                               /*enqueue_result=*/false, max_elements,
+                               *result);
         } else {
           Result r;
           s = GetElementTraced(task_to_process.get(), deadline_micros,
-                               /*enqueue_result=*/true, r);
+                               /*enqueue_result=*/true, max_elements, r);
         }
         if (!s.ok()) {
           mutex_lock l(mu_);
+          outstanding_requests_ -= max_elements - 1;
           VLOG(1) << "Failed to get element from worker "
                   << task_to_process->info.worker_address() << ": " << s;
           task_to_process->in_use = false;
@@ -690,6 +697,58 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       return task.worker->GetElement(req, resp);
     }
 
+    Status TryGetElements(const Task& task, int64 max_elements,
+                          GetElementsResponse& resp) {
+      GetElementsRequest req;
+      req.set_task_id(task.info.task_id());
+      req.set_max_elements(max_elements);
+      resp.Clear();
+      return task.worker->GetElements(req, resp);
+    }
+
+    // Returns how many elements the calling thread's request may fetch
+    // without exceeding max_outstanding_requests. The request itself is
+    // already counted in `outstanding_requests_`; its additional elements are
+    // reserved there too, so that concurrent requests don't claim the same
+    // space. The reservation is released when the response is processed.
+    int64 ReserveElementsPerRequest() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      int64 space = max_outstanding_requests_ -
+                    static_cast<int64>(results_.size()) - outstanding_requests_;
+      int64 additional_elements =
+          std::max<int64>(0, std::min(kMaxElementsPerRequest - 1, space));
+      outstanding_requests_ += additional_elements;
+      return additional_elements + 1;
+    }
+
+    void ProcessGetElementsResponse(GetElementsResponse& resp,
+                                    int64 max_elements, Task& task) {
+      std::vector<std::vector<Tensor>> elements;
+      elements.reserve(resp.compressed_elements_size());
+      for (auto& compressed : *resp.mutable_compressed_elements()) {
+        // Swap rather than copy the element's data into the tensor.
+        CompressedElement element;
+        element.Swap(&compressed);
+        Tensor tensor(DT_VARIANT, TensorShape{});
+        tensor.scalar<Variant>()() = std::move(element);
+        elements.push_back({std::move(tensor)});
+      }
+      mutex_lock l(mu_);
+      // The request's first element stays counted until the worker thread
+      // picks its next task.
+      outstanding_requests_ -= max_elements - 1;
+      for (auto& element : elements) {
+        Result result;
+        result.ready = true;
+        result.element = std::move(element);
+        results_.push(std::move(result));
+      }
+      if (resp.end_of_sequence()) {
+        task.end_of_sequence = true;
+        finished_tasks_++;
+      }
+      get_next_cv_.notify_all();
+    }
+
     void ProcessGetElementResponse(bool enqueue_result,
                                    GetElementResponse& resp, Result& result,
                                    Task& task) {
@@ -720,8 +779,11 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       get_next_cv_.notify_all();
     }
 
+    // Fetches up to `max_elements` elements of `task`. Fetching more than one
+    // requires `enqueue_result`.
     Status GetElementTraced(Task* task, int64 deadline_micros,
-                            bool enqueue_result, Result& result)
+                            bool enqueue_result, int64 max_elements,
+                            Result& result)
         TF_LOCKS_EXCLUDED(mu_) {
       VLOG(3) << "Getting an element for task id " << task->info.task_id();
       tensorflow::profiler::TraceMe activity(
@@ -730,9 +792,15 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
         return profiler::TraceMeEncode(
             {{"address", task->info.worker_address()}});
       });
+      // Without round-robin, results are enqueued as they arrive, so several
+      // elements can be fetched per round trip.
+      DCHECK(enqueue_result || max_elements == 1);
+      const bool batched = enqueue_result;
       GetElementResponse resp;
+      GetElementsResponse batch_resp;
       for (int num_retries = 0;; ++num_retries) {
-        Status s = TryGetElement(*task, resp);
+        Status s = batched ? TryGetElements(*task, max_elements, batch_resp)
+                           : TryGetElement(*task, resp);
         if (s.ok()) break;
         // Retry all errors that could indicate preemption.
         if (!errors::IsUnavailable(s) && !errors::IsCancelled(s) &&
@@ -758,7 +826,11 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
                 << " microseconds";
         Env::Default()->SleepForMicroseconds(backoff_until - now_micros);
       }
-      ProcessGetElementResponse(enqueue_result, resp, result, *task);
+      if (batched) {
+        ProcessGetElementsResponse(batch_resp, max_elements, *task);
+      } else {
+        ProcessGetElementResponse(enqueue_result, resp, result, *task);
+      }
       return Status::OK();
     }
 
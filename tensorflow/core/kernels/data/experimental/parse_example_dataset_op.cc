@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
 #include <deque>
 
 #include "tensorflow/core/common_runtime/device.h"
@@ -74,6 +75,13 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
       OP_REQUIRES_OK(
           ctx, DeterminismPolicy::FromString(deterministic, &deterministic_));
     }
+    if (ctx->HasAttr("batch_size")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("batch_size", &batch_size_));
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("drop_remainder", &drop_remainder_));
+      OP_REQUIRES(ctx, batch_size_ >= 0,
+                  errors::InvalidArgument(
+                      "batch_size must be non-negative but is ", batch_size_));
+    }
 
     has_ragged_keys_ = ctx->HasAttr("ragged_keys");
     if (has_ragged_keys_) {
@@ -198,12 +206,40 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
       it->second = i++;
     }
 
+    if (batch_size_ > 0) {
+      // The examples of `batch_size` input elements are parsed together, so
+      // dense outputs have a statically known batch dimension only if every
+      // batch is full and the input elements have a known size.
+      int64 batch_dim = -1;
+      const PartialTensorShape& input_shape = input->output_shapes()[0];
+      if (drop_remainder_ && input_shape.IsFullyDefined()) {
+        batch_dim = batch_size_ * input_shape.num_elements();
+      }
+      for (int d = 0; d < dense_keys_.size(); ++d) {
+        const int output_index = key_to_output_index[dense_keys_[d]];
+        const PartialTensorShape& output_shape = output_shapes_[output_index];
+        OP_REQUIRES(
+            ctx,
+            output_shape.dims() <= 0 || output_shape.dim_size(0) == -1 ||
+                output_shape.dim_size(0) == batch_dim,
+            errors::InvalidArgument(
+                "output_shapes[", output_index, "] == ",
+                output_shape.DebugString(),
+                " is not compatible with batch_size == ", batch_size_,
+                ", drop_remainder == ", drop_remainder_,
+                " and input elements of shape ", input_shape.DebugString(),
+                ", whose batch dimension is ",
+                batch_dim == -1 ? "unknown" : std::to_string(batch_dim), "."));
+      }
+    }
+
     *output = new Dataset(
         ctx, input, dense_defaults, sparse_keys_, dense_keys_,
         std::move(key_to_output_index), std::move(config), num_parallel_calls,
         sparse_types_, dense_types_, dense_shapes_, output_types_,
         output_shapes_, deterministic_, has_ragged_keys_, ragged_keys_,
-        ragged_value_types_, ragged_split_types_, op_version_);
+        ragged_value_types_, ragged_split_types_, batch_size_, drop_remainder_,
+        op_version_);
   }
 
  private:
@@ -222,7 +258,8 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
             const DeterminismPolicy& deterministic, bool has_ragged_keys,
             std::vector<string> ragged_keys,
             const DataTypeVector& ragged_value_types,
-            const DataTypeVector& ragged_split_types, int op_version)
+            const DataTypeVector& ragged_split_types, int64 batch_size,
+            bool drop_remainder, int op_version)
         : DatasetBase(DatasetContext(ctx)),
           input_(input),
           dense_defaults_(std::move(dense_defaults)),
@@ -241,6 +278,8 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
           output_shapes_(output_shapes),
           deterministic_(deterministic),
           has_ragged_keys_(has_ragged_keys),
+          batch_size_(batch_size),
+          drop_remainder_(drop_remainder),
           op_version_(op_version) {
       input_->Ref();
     }
@@ -269,7 +308,15 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
       return name_utils::DatasetDebugString(kDatasetType, params);
     }
 
-    int64 Cardinality() const override { return input_->Cardinality(); }
+    int64 Cardinality() const override {
+      int64 n = input_->Cardinality();
+      if (batch_size_ == 0 || n == kInfiniteCardinality ||
+          n == kUnknownCardinality) {
+        return n;
+      }
+      return n / batch_size_ +
+             (n % batch_size_ == 0 || drop_remainder_ ? 0 : 1);
+    }
 
     Status InputDatasets(
         std::vector<const DatasetBase*>* inputs) const override {
@@ -332,6 +379,14 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
         AttrValue deterministic_attr;
         b->BuildAttrValue(deterministic_.String(), &deterministic_attr);
         attrs.emplace_back("deterministic", deterministic_attr);
+
+        AttrValue batch_size_attr;
+        b->BuildAttrValue(batch_size_, &batch_size_attr);
+        attrs.emplace_back("batch_size", batch_size_attr);
+
+        AttrValue drop_remainder_attr;
+        b->BuildAttrValue(drop_remainder_, &drop_remainder_attr);
+        attrs.emplace_back("drop_remainder", drop_remainder_attr);
       }
 
       if (has_ragged_keys_) {
@@ -420,7 +475,7 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
           IteratorContext* ctx, model::Node::Args args) const override {
         return model::MakeAsyncKnownRatioNode(
             std::move(args),
-            /*ratio=*/1,
+            /*ratio=*/std::max<int64>(dataset()->batch_size_, 1),
             {model::MakeParameter("parallelism", num_parallel_calls_, /*min=*/1,
                                   /*max=*/ctx->runner_threadpool_size())});
       }
@@ -579,10 +634,18 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
           return profiler::TraceMeEncode("ParseExampleProduce",
                                          {{"element_id", result->id}});
         });
-        // Get the next input element.
+        // Get the next input element. In batch mode, the serialized examples
+        // of `batch_size` input elements are gathered so that a single
+        // `FastParseExample` call parses the whole minibatch directly into
+        // batched output tensors.
         std::vector<Tensor> input_element;
-        result->status = input_impl_->GetNext(ctx.get(), &input_element,
-                                              &result->end_of_input);
+        if (dataset()->batch_size_ > 0) {
+          result->status = GetNextBatch(ctx.get(), &input_element,
+                                        &result->end_of_input);
+        } else {
+          result->status = input_impl_->GetNext(ctx.get(), &input_element,
+                                                &result->end_of_input);
+        }
         if (result->end_of_input || !result->status.ok()) {
           CallCompleted(ctx, result);
           return;
@@ -615,6 +678,30 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
         RecordStart(ctx.get());
       }
 
+      // Gathers the next `batch_size` input elements into `batch`. A partial
+      // final batch is returned unless `drop_remainder` is set.
+      Status GetNextBatch(IteratorContext* ctx, std::vector<Tensor>* batch,
+                          bool* end_of_input) {
+        for (int64 i = 0; i < dataset()->batch_size_; ++i) {
+          std::vector<Tensor> element;
+          bool end_of_sequence = false;
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, &element, &end_of_sequence));
+          if (end_of_sequence) {
+            *end_of_input = batch->empty() || dataset()->drop_remainder_;
+            if (*end_of_input) {
+              batch->clear();
+            }
+            return Status::OK();
+          }
+          for (Tensor& t : element) {
+            batch->push_back(std::move(t));
+          }
+        }
+        *end_of_input = false;
+        return Status::OK();
+      }
+
       Status CheckOutputTensor(const Tensor& tensor, size_t value_index,
                                size_t output_index) const {
         if (tensor.dtype() != dataset()->output_dtypes()[output_index]) {
@@ -922,6 +1009,10 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
     const std::vector<PartialTensorShape> output_shapes_;
     const DeterminismPolicy deterministic_;
     const bool has_ragged_keys_;
+    // If positive, the number of serialized examples parsed together into
+    // each output element.
+    const int64 batch_size_;
+    const bool drop_remainder_;
     const int op_version_;
   };
 
@@ -940,6 +1031,8 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
   std::vector<bool> variable_length_;
   std::vector<std::size_t> elements_per_stride_;
   bool has_ragged_keys_;
+  int64 batch_size_ = 0;
+  bool drop_remainder_ = false;
   const int op_version_;
 };
 
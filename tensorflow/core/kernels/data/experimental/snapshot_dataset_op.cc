@@ -83,6 +83,11 @@ namespace experimental {
     SnapshotDatasetV2Op::kReaderFuncTarguments;
 /* static */ constexpr const char* const
     SnapshotDatasetV2Op::kShardFuncTarguments;
+/* static */ constexpr const char* const SnapshotDatasetV2Op::kNumParallelReads;
+/* static */ constexpr const char* const
+    SnapshotDatasetV2Op::kReadaheadElements;
+/* static */ constexpr const char* const
+    SnapshotDatasetV2Op::kDeterministicReads;
 /* static */ constexpr const int SnapshotDatasetV2Op::kFileFormatVersion;
 
 // ==== Snapshot Implementation ====
@@ -121,7 +126,9 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
           const std::string& path, const std::string& compression,
           const std::string& reader_prefix, const std::string& writer_prefix,
           std::unique_ptr<CapturedFunction> reader_func,
-          std::unique_ptr<CapturedFunction> shard_func);
+          std::unique_ptr<CapturedFunction> shard_func,
+          int64 num_parallel_reads, int64 readahead_elements,
+          bool deterministic_reads);
 
   ~Dataset() override;
 
@@ -156,6 +163,10 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
   std::unique_ptr<CapturedFunction> reader_func_;
   std::unique_ptr<CapturedFunction> shard_func_;
 
+  const int64 num_parallel_reads_;
+  const int64 readahead_elements_;
+  const bool deterministic_reads_;
+
   class Iterator;
 };
 
@@ -217,13 +228,24 @@ class SnapshotDatasetV2Op::Dataset::Iterator::Reader
                          IteratorStateReader* reader) override;
 
  private:
+  Status InitializeParallelReader(IteratorContext* ctx,
+                                  const std::string& run_dir,
+                                  const std::vector<std::string>& shard_dirs,
+                                  int64 version)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const int64 start_index_;
 
   mutex mu_;
 
   std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
 
-  DatasetBase* input_ TF_GUARDED_BY(mu_);
+  DatasetBase* input_ TF_GUARDED_BY(mu_) = nullptr;
+
+  // Only set when `num_parallel_reads_` is positive, in which case
+  // `input_impl_` is unused.
+  std::unique_ptr<snapshot_util::ParallelReader> parallel_reader_
+      TF_GUARDED_BY(mu_);
 
   std::unique_ptr<InstantiatedCapturedFunction> instantiated_reader_func_
       TF_GUARDED_BY(mu_);
@@ -310,7 +332,8 @@ SnapshotDatasetV2Op::Dataset::Dataset(
     const std::string& path, const std::string& compression,
     const std::string& reader_prefix, const std::string& writer_prefix,
     std::unique_ptr<CapturedFunction> reader_func,
-    std::unique_ptr<CapturedFunction> shard_func)
+    std::unique_ptr<CapturedFunction> shard_func, int64 num_parallel_reads,
+    int64 readahead_elements, bool deterministic_reads)
     : DatasetBase(DatasetContext(ctx)),
       input_(input),
       hash_(hash),
@@ -319,7 +342,10 @@ SnapshotDatasetV2Op::Dataset::Dataset(
       reader_prefix_(reader_prefix),
       writer_prefix_(writer_prefix),
       reader_func_(std::move(reader_func)),
-      shard_func_(std::move(shard_func)) {
+      shard_func_(std::move(shard_func)),
+      num_parallel_reads_(num_parallel_reads),
+      readahead_elements_(readahead_elements),
+      deterministic_reads_(deterministic_reads) {
   input_->Ref();
 }
 
@@ -405,6 +431,15 @@ Status SnapshotDatasetV2Op::Dataset::AsGraphDefInternal(
   b->BuildAttrValue(shard_func_other_args_types,
                     &shard_func_arguments_types_attr);
 
+  AttrValue num_parallel_reads_attr;
+  b->BuildAttrValue(num_parallel_reads_, &num_parallel_reads_attr);
+
+  AttrValue readahead_elements_attr;
+  b->BuildAttrValue(readahead_elements_, &readahead_elements_attr);
+
+  AttrValue deterministic_reads_attr;
+  b->BuildAttrValue(deterministic_reads_, &deterministic_reads_attr);
+
   return b->AddDataset(
       this,
       /*inputs=*/
@@ -421,7 +456,10 @@ Status SnapshotDatasetV2Op::Dataset::AsGraphDefInternal(
        {kReaderFunc, reader_func_attr},
        {kShardFunc, shard_func_attr},
        {kReaderFuncTarguments, reader_func_arguments_types_attr},
-       {kShardFuncTarguments, shard_func_arguments_types_attr}},
+       {kShardFuncTarguments, shard_func_arguments_types_attr},
+       {kNumParallelReads, num_parallel_reads_attr},
+       {kReadaheadElements, readahead_elements_attr},
+       {kDeterministicReads, deterministic_reads_attr}},
       output);
 }
 
@@ -548,15 +586,16 @@ SnapshotDatasetV2Op::Dataset::Iterator::Reader::Reader(const Params& params,
                                                        int64 start_index)
     : DatasetIterator<Dataset>(params), start_index_(start_index) {}
 
-SnapshotDatasetV2Op::Dataset::Iterator::Reader::~Reader() { input_->Unref(); }
+SnapshotDatasetV2Op::Dataset::Iterator::Reader::~Reader() {
+  if (input_ != nullptr) {
+    input_->Unref();
+  }
+}
 
 Status SnapshotDatasetV2Op::Dataset::Iterator::Reader::Initialize(
     IteratorContext* ctx) {
   mutex_lock l(mu_);
 
-  TF_RETURN_IF_ERROR(
-      dataset()->reader_func_->Instantiate(ctx, &instantiated_reader_func_));
-
   auto hash_dir = snapshot_util::HashDirectory(
       io::JoinPath(dataset()->reader_prefix_, dataset()->path_),
       dataset()->hash_);
@@ -575,6 +614,14 @@ Status SnapshotDatasetV2Op::Dataset::Iterator::Reader::Initialize(
       &snapshot_shard_dirs));
   std::sort(snapshot_shard_dirs.begin(), snapshot_shard_dirs.end());
 
+  if (dataset()->num_parallel_reads_ > 0) {
+    return InitializeParallelReader(ctx, run_dir, snapshot_shard_dirs,
+                                    metadata.version());
+  }
+
+  TF_RETURN_IF_ERROR(
+      dataset()->reader_func_->Instantiate(ctx, &instantiated_reader_func_));
+
   DatasetBase* dataset_of_snapshot_files;
   TF_RETURN_IF_ERROR(snapshot_util::Reader::MakeNestedDataset(
       ctx->env(), snapshot_shard_dirs, dataset()->compression_,
@@ -605,10 +652,36 @@ Status SnapshotDatasetV2Op::Dataset::Iterator::Reader::Initialize(
   return input_->MakeIterator(ctx, this, prefix(), &input_impl_);
 }
 
+Status
+SnapshotDatasetV2Op::Dataset::Iterator::Reader::InitializeParallelReader(
+    IteratorContext* ctx, const std::string& run_dir,
+    const std::vector<std::string>& shard_dirs, int64 version) {
+  VLOG(1) << "Reading " << shard_dirs.size() << " snapshot shards from "
+          << run_dir << " with " << dataset()->num_parallel_reads_
+          << " parallel reads.";
+  parallel_reader_ = absl::make_unique<snapshot_util::ParallelReader>(
+      ctx->env(), shard_dirs, dataset()->compression_, version,
+      dataset()->output_dtypes(), dataset()->num_parallel_reads_,
+      dataset()->readahead_elements_, dataset()->deterministic_reads_);
+  // The position is only known as a number of produced elements, so we skip
+  // ahead by re-reading them. This restores the exact position when reads are
+  // deterministic.
+  bool end_of_sequence = false;
+  for (int64 i = 0; i < start_index_ && !end_of_sequence; ++i) {
+    std::vector<Tensor> unused;
+    TF_RETURN_IF_ERROR(
+        parallel_reader_->ReadTensors(&unused, &end_of_sequence));
+  }
+  return Status::OK();
+}
+
 Status SnapshotDatasetV2Op::Dataset::Iterator::Reader::GetNextInternal(
     IteratorContext* ctx, std::vector<Tensor>* out_tensors,
     bool* end_of_sequence) {
   mutex_lock l(mu_);
+  if (parallel_reader_) {
+    return parallel_reader_->ReadTensors(out_tensors, end_of_sequence);
+  }
   return input_impl_->GetNext(ctx, out_tensors, end_of_sequence);
 }
 
@@ -852,6 +925,25 @@ SnapshotDatasetV2Op::SnapshotDatasetV2Op(OpKernelConstruction* ctx)
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kHash, &hash));
   hash_ = static_cast<uint64>(hash);
 
+  if (ctx->HasAttr(kNumParallelReads)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kNumParallelReads, &num_parallel_reads_));
+    OP_REQUIRES(ctx, num_parallel_reads_ >= 0,
+                errors::InvalidArgument(
+                    "num_parallel_reads must be non-negative, but got ",
+                    num_parallel_reads_));
+  }
+  if (ctx->HasAttr(kReadaheadElements)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kReadaheadElements, &readahead_elements_));
+    OP_REQUIRES(ctx, readahead_elements_ > 0,
+                errors::InvalidArgument(
+                    "readahead_elements must be positive, but got ",
+                    readahead_elements_));
+  }
+  if (ctx->HasAttr(kDeterministicReads)) {
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr(kDeterministicReads, &deterministic_reads_));
+  }
+
   OP_REQUIRES_OK(ctx, FunctionMetadata::Create(ctx, kReaderFunc, reader_params,
                                                &reader_func_metadata_));
   OP_REQUIRES_OK(ctx, FunctionMetadata::Create(ctx, kShardFunc, shard_params,
@@ -895,7 +987,8 @@ void SnapshotDatasetV2Op::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
 
   *output = new SnapshotDatasetV2Op::Dataset(
       ctx, input, hash, path, compression, reader_prefix_, writer_prefix_,
-      std::move(reader_func), std::move(shard_func));
+      std::move(reader_func), std::move(shard_func), num_parallel_reads_,
+      readahead_elements_, deterministic_reads_);
 }
 
 namespace {
@@ -996,9 +1089,10 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
         ctx,
         compression_ == io::compression::kNone ||
             compression_ == io::compression::kGzip ||
-            compression_ == io::compression::kSnappy,
-        errors::InvalidArgument("compression must be either '', 'GZIP' or "
-                                "'SNAPPY'."));
+            compression_ == io::compression::kSnappy ||
+            compression_ == snapshot_util::kColumnarCompression,
+        errors::InvalidArgument("compression must be either '', 'GZIP', "
+                                "'SNAPPY' or 'COLUMNAR'."));
 
     OP_REQUIRES(
         ctx, pending_snapshot_expiry_seconds_ >= 1,
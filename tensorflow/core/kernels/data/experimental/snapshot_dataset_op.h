@@ -58,6 +58,10 @@ class SnapshotDatasetV2Op : public UnaryDatasetOpKernel {
   static constexpr const char* const kReaderFuncTarguments =
       "Treader_func_args";
   static constexpr const char* const kShardFuncTarguments = "Tshard_func_args";
+  static constexpr const char* const kNumParallelReads = "num_parallel_reads";
+  static constexpr const char* const kReadaheadElements = "readahead_elements";
+  static constexpr const char* const kDeterministicReads =
+      "deterministic_reads";
   // Note: If a new constant is declared here, it *must* be defined in
   // snapshot_dataset_op.cc, otherwise it will not compile in debug mode.
 
@@ -82,6 +86,12 @@ class SnapshotDatasetV2Op : public UnaryDatasetOpKernel {
   bool hash_valid_;
   uint64 hash_;
 
+  // If positive, snapshots are read with a `snapshot_util::ParallelReader`
+  // instead of `reader_func`.
+  int64 num_parallel_reads_ = 0;
+  int64 readahead_elements_ = 16;
+  bool deterministic_reads_ = true;
+
   std::shared_ptr<FunctionMetadata> reader_func_metadata_;
   std::shared_ptr<FunctionMetadata> shard_func_metadata_;
 };
@@ -19,6 +19,8 @@ limitations under the License.
 
 #include "absl/memory/memory.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/dataset.pb.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
@@ -199,6 +201,12 @@ Status CustomWriter::Initialize(tensorflow::Env* env) {
 }
 
 Status CustomWriter::WriteTensors(const std::vector<Tensor>& tensors) {
+  if (compression_type_ == kColumnarCompression) {
+    CompressedElement compressed;
+    TF_RETURN_IF_ERROR(
+        CompressElement(tensors, ElementCodec::kColumnar, &compressed));
+    return WriteRecord(compressed.SerializeAsString());
+  }
   if (compression_type_ != io::compression::kSnappy) {
     experimental::SnapshotRecord record;
     for (const auto& tensor : tensors) {
@@ -702,6 +710,15 @@ Status CustomReader::ReadTensors(std::vector<Tensor>* read_tensors) {
   profiler::TraceMe activity(
       [&]() { return absl::StrCat(kClassName, kSeparator, "ReadTensors"); },
       profiler::TraceMeLevel::kInfo);
+  if (compression_type_ == kColumnarCompression) {
+    tstring record;
+    TF_RETURN_IF_ERROR(ReadRecord(&record));
+    CompressedElement compressed;
+    if (!compressed.ParseFromArray(record.data(), record.size())) {
+      return errors::DataLoss("Could not parse CompressedElement");
+    }
+    return UncompressElement(compressed, read_tensors);
+  }
   if (version_ == 0 || compression_type_ != io::compression::kSnappy) {
     return ReadTensorsV0(read_tensors);
   }
@@ -997,6 +1014,154 @@ Status AsyncWriter::WriterThread(Env* env, const std::string& shard_directory,
   return Status::OK();
 }
 
+ParallelReader::ParallelReader(Env* env,
+                               const std::vector<std::string>& shard_dirs,
+                               const std::string& compression, int64 version,
+                               const DataTypeVector& dtypes,
+                               int64 num_parallel_reads,
+                               int64 readahead_elements, bool deterministic)
+    : readahead_elements_(std::max<int64>(readahead_elements, 1)),
+      deterministic_(deterministic) {
+  const int64 num_streams = std::min<int64>(
+      std::max<int64>(num_parallel_reads, 1), shard_dirs.size());
+  std::vector<std::vector<std::string>> stream_shard_dirs(num_streams);
+  for (int64 i = 0; i < shard_dirs.size(); ++i) {
+    stream_shard_dirs[i % num_streams].push_back(shard_dirs[i]);
+  }
+  {
+    mutex_lock l(mu_);
+    streams_.resize(num_streams);
+    for (int64 i = 0; i < num_streams; ++i) {
+      active_streams_.push_back(i);
+    }
+  }
+  threads_.reserve(num_streams);
+  for (int64 i = 0; i < num_streams; ++i) {
+    threads_.push_back(absl::WrapUnique(env->StartThread(
+        ThreadOptions(), absl::StrCat("snapshot_reader_thread_", i),
+        [this, env, i, dirs = std::move(stream_shard_dirs[i]), compression,
+         version, dtypes] {
+          ReaderThread(env, i, dirs, compression, version, dtypes);
+        })));
+  }
+}
+
+ParallelReader::~ParallelReader() {
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    space_available_.notify_all();
+  }
+  threads_.clear();
+}
+
+Status ParallelReader::ReadTensors(std::vector<Tensor>* read_tensors,
+                                   bool* end_of_sequence) {
+  mutex_lock l(mu_);
+  while (true) {
+    if (active_streams_.empty()) {
+      *end_of_sequence = true;
+      return Status::OK();
+    }
+    if (deterministic_) {
+      // Wait for the next stream in round-robin order.
+      Stream& stream = streams_[active_streams_[next_active_stream_]];
+      while (stream.buffer.empty() && !stream.done) {
+        element_available_.wait(l);
+      }
+    } else {
+      // Wait for any stream, starting the search at the next stream in
+      // round-robin order so that fast streams cannot starve the others.
+      bool found = false;
+      while (!found) {
+        for (size_t i = 0; i < active_streams_.size(); ++i) {
+          size_t index = (next_active_stream_ + i) % active_streams_.size();
+          const Stream& stream = streams_[active_streams_[index]];
+          if (!stream.buffer.empty() || stream.done) {
+            next_active_stream_ = index;
+            found = true;
+            break;
+          }
+        }
+        if (!found) {
+          element_available_.wait(l);
+        }
+      }
+    }
+    Stream& stream = streams_[active_streams_[next_active_stream_]];
+    if (!stream.buffer.empty()) {
+      *read_tensors = std::move(stream.buffer.front());
+      stream.buffer.pop_front();
+      next_active_stream_ = (next_active_stream_ + 1) % active_streams_.size();
+      *end_of_sequence = false;
+      space_available_.notify_all();
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(stream.status);
+    // The stream is exhausted; drop it from the rotation.
+    active_streams_.erase(active_streams_.begin() + next_active_stream_);
+    if (next_active_stream_ == active_streams_.size()) {
+      next_active_stream_ = 0;
+    }
+  }
+}
+
+void ParallelReader::ReaderThread(Env* env, int64 stream_index,
+                                  const std::vector<std::string>& shard_dirs,
+                                  const std::string& compression,
+                                  int64 version, const DataTypeVector& dtypes) {
+  Status s;
+  for (const auto& shard_dir : shard_dirs) {
+    s = ReadShard(env, stream_index, shard_dir, compression, version, dtypes);
+    if (!s.ok()) {
+      break;
+    }
+  }
+  mutex_lock l(mu_);
+  // Cancellation is not an error the consumer can observe.
+  if (!errors::IsCancelled(s)) {
+    streams_[stream_index].status = s;
+  }
+  streams_[stream_index].done = true;
+  element_available_.notify_all();
+}
+
+Status ParallelReader::ReadShard(Env* env, int64 stream_index,
+                                 const std::string& shard_dir,
+                                 const std::string& compression, int64 version,
+                                 const DataTypeVector& dtypes) {
+  for (uint64 checkpoint_id = 0;; ++checkpoint_id) {
+    const std::string filename =
+        GetCheckpointFileName(shard_dir, checkpoint_id);
+    Status s = env->FileExists(filename);
+    if (errors::IsNotFound(s)) {
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(s);
+    std::unique_ptr<Reader> reader;
+    TF_RETURN_IF_ERROR(
+        Reader::Create(env, filename, compression, version, dtypes, &reader));
+    while (true) {
+      std::vector<Tensor> tensors;
+      s = reader->ReadTensors(&tensors);
+      if (errors::IsOutOfRange(s)) {
+        break;
+      }
+      TF_RETURN_IF_ERROR(s);
+      mutex_lock l(mu_);
+      Stream& stream = streams_[stream_index];
+      while (stream.buffer.size() >= readahead_elements_ && !cancelled_) {
+        space_available_.wait(l);
+      }
+      if (cancelled_) {
+        return errors::Cancelled("Snapshot reader was cancelled.");
+      }
+      stream.buffer.push_back(std::move(tensors));
+      element_available_.notify_all();
+    }
+  }
+}
+
 }  // namespace snapshot_util
 }  // namespace data
 }  // namespace tensorflow
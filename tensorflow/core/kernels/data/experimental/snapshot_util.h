@@ -51,6 +51,10 @@ constexpr char kModeRead[] = "read";
 constexpr char kModePassthrough[] = "passthrough";
 constexpr char kShardDirectorySuffix[] = ".shard";
 
+// Compression type under which `CustomWriter` encodes each element with the
+// columnar `CompressElement` codec instead of a single snappy block.
+constexpr char kColumnarCompression[] = "COLUMNAR";
+
 enum Mode { READER = 0, WRITER = 1, PASSTHROUGH = 2 };
 
 // Returns the name of the "hash" directory for the given base path and hash ID.
@@ -351,6 +355,78 @@ class AsyncWriter {
   std::unique_ptr<Thread> thread_;
 };
 
+// ParallelReader reads the elements stored in a set of snapshot shard
+// directories, decoding up to `num_parallel_reads` shards concurrently on
+// background threads.
+//
+// Shard `i` is assigned to stream `i % num_parallel_reads`, and each stream
+// reads its shards one after another. Every stream buffers at most
+// `readahead_elements` decoded elements ahead of the consumer.
+//
+// If `deterministic` is true, elements are produced round-robin across the
+// streams that have not been exhausted yet, so the output order does not
+// depend on thread scheduling. Otherwise, the next element is taken from any
+// stream that has one available, which avoids blocking on a slow shard.
+//
+// The expected use of this API is:
+//
+// ParallelReader reader(env, shard_dirs, ...);
+// bool end_of_sequence = false;
+// while (!end_of_sequence) {
+//   std::vector<Tensor> tensors;
+//   TF_RETURN_IF_ERROR(reader.ReadTensors(&tensors, &end_of_sequence));
+//   ...
+// }
+class ParallelReader {
+ public:
+  ParallelReader(Env* env, const std::vector<std::string>& shard_dirs,
+                 const std::string& compression, int64 version,
+                 const DataTypeVector& dtypes, int64 num_parallel_reads,
+                 int64 readahead_elements, bool deterministic);
+
+  // Stops the background threads and blocks until they have exited.
+  ~ParallelReader();
+
+  // Reads the next element. Sets `end_of_sequence` to true once all shards
+  // have been read.
+  Status ReadTensors(std::vector<Tensor>* read_tensors, bool* end_of_sequence)
+      TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Stream {
+    std::deque<std::vector<Tensor>> buffer;
+    Status status;
+    // Set once the stream has read all of its shards, or failed.
+    bool done = false;
+  };
+
+  // Reads the shards of stream `stream_index` until they are exhausted or the
+  // reader is cancelled.
+  void ReaderThread(Env* env, int64 stream_index,
+                    const std::vector<std::string>& shard_dirs,
+                    const std::string& compression, int64 version,
+                    const DataTypeVector& dtypes) TF_LOCKS_EXCLUDED(mu_);
+  Status ReadShard(Env* env, int64 stream_index, const std::string& shard_dir,
+                   const std::string& compression, int64 version,
+                   const DataTypeVector& dtypes) TF_LOCKS_EXCLUDED(mu_);
+
+  const int64 readahead_elements_;
+  const bool deterministic_;
+
+  mutex mu_;
+  condition_variable element_available_;
+  condition_variable space_available_;
+  std::vector<Stream> streams_ TF_GUARDED_BY(mu_);
+  // Indices of the streams that may still produce elements, in round-robin
+  // order, and the position in it of the next stream to read from.
+  std::vector<int64> active_streams_ TF_GUARDED_BY(mu_);
+  size_t next_active_stream_ TF_GUARDED_BY(mu_) = 0;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+
+  // This has to be last. See `AsyncWriter::thread_`.
+  std::vector<std::unique_ptr<Thread>> threads_;
+};
+
 }  // namespace snapshot_util
 }  // namespace data
 }  // namespace tensorflow
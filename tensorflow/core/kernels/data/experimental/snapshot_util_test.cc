@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
@@ -85,12 +86,101 @@ TEST(SnapshotUtilTest, CombinationRoundTripTest) {
   SnapshotRoundTrip(io::compression::kNone, 1);
   SnapshotRoundTrip(io::compression::kGzip, 1);
   SnapshotRoundTrip(io::compression::kSnappy, 1);
+  SnapshotRoundTrip(kColumnarCompression, 1);
 
   SnapshotRoundTrip(io::compression::kNone, 2);
   SnapshotRoundTrip(io::compression::kGzip, 2);
   SnapshotRoundTrip(io::compression::kSnappy, 2);
 }
 
+// Writes `num_shards` shards under `run_dir`, where shard `i` contains the
+// scalars `100 * i + j` for `j` in `[0, i]`, split across two checkpoint files.
+void WriteShards(const std::string& run_dir, int num_shards,
+                 const std::string& compression_type,
+                 std::vector<std::string>* shard_dirs) {
+  for (int i = 0; i < num_shards; ++i) {
+    std::string shard_dir = ShardDirectory(run_dir, i);
+    TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(shard_dir));
+    for (int checkpoint_id = 0; checkpoint_id < 2; ++checkpoint_id) {
+      std::unique_ptr<Writer> writer;
+      TF_ASSERT_OK(Writer::Create(
+          Env::Default(), GetCheckpointFileName(shard_dir, checkpoint_id),
+          compression_type, /*version=*/2, {DT_INT64}, &writer));
+      for (int j = checkpoint_id * (i + 1) / 2;
+           j < (checkpoint_id + 1) * (i + 1) / 2; ++j) {
+        Tensor t(DT_INT64, TensorShape({}));
+        t.scalar<int64>()() = 100 * i + j;
+        TF_ASSERT_OK(writer->WriteTensors({t}));
+      }
+      TF_ASSERT_OK(writer->Close());
+    }
+    shard_dirs->push_back(shard_dir);
+  }
+}
+
+std::vector<int64> ReadAll(ParallelReader* reader) {
+  std::vector<int64> values;
+  bool end_of_sequence = false;
+  while (true) {
+    std::vector<Tensor> tensors;
+    TF_EXPECT_OK(reader->ReadTensors(&tensors, &end_of_sequence));
+    if (end_of_sequence) {
+      break;
+    }
+    EXPECT_EQ(tensors.size(), 1);
+    values.push_back(tensors[0].scalar<int64>()());
+  }
+  return values;
+}
+
+TEST(SnapshotUtilTest, ParallelReaderDeterministic) {
+  std::string run_dir =
+      io::JoinPath(testing::TmpDir(), "parallel_reader_deterministic");
+  std::vector<std::string> shard_dirs;
+  WriteShards(run_dir, /*num_shards=*/5, io::compression::kSnappy,
+              &shard_dirs);
+
+  ParallelReader reader(Env::Default(), shard_dirs, io::compression::kSnappy,
+                        /*version=*/2, {DT_INT64}, /*num_parallel_reads=*/2,
+                        /*readahead_elements=*/1, /*deterministic=*/true);
+  // Stream 0 reads shards 0, 2 and 4; stream 1 reads shards 1 and 3.
+  std::vector<int64> expected = {0,   100, 200, 101, 201, 300, 202, 301,
+                                 400, 302, 401, 303, 402, 403, 404};
+  EXPECT_EQ(ReadAll(&reader), expected);
+}
+
+TEST(SnapshotUtilTest, ParallelReaderNonDeterministic) {
+  std::string run_dir =
+      io::JoinPath(testing::TmpDir(), "parallel_reader_nondeterministic");
+  std::vector<std::string> shard_dirs;
+  WriteShards(run_dir, /*num_shards=*/5, io::compression::kGzip, &shard_dirs);
+
+  ParallelReader reader(Env::Default(), shard_dirs, io::compression::kGzip,
+                        /*version=*/2, {DT_INT64}, /*num_parallel_reads=*/8,
+                        /*readahead_elements=*/2, /*deterministic=*/false);
+  std::vector<int64> values = ReadAll(&reader);
+  std::sort(values.begin(), values.end());
+  std::vector<int64> expected = {0,   100, 101, 200, 201, 202, 300, 301,
+                                 302, 303, 400, 401, 402, 403, 404};
+  EXPECT_EQ(values, expected);
+}
+
+TEST(SnapshotUtilTest, ParallelReaderCancelledWithPendingElements) {
+  std::string run_dir =
+      io::JoinPath(testing::TmpDir(), "parallel_reader_cancelled");
+  std::vector<std::string> shard_dirs;
+  WriteShards(run_dir, /*num_shards=*/5, io::compression::kNone, &shard_dirs);
+
+  // Destroying the reader must not block on the full readahead buffers.
+  ParallelReader reader(Env::Default(), shard_dirs, io::compression::kNone,
+                        /*version=*/2, {DT_INT64}, /*num_parallel_reads=*/2,
+                        /*readahead_elements=*/1, /*deterministic=*/true);
+  std::vector<Tensor> tensors;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(reader.ReadTensors(&tensors, &end_of_sequence));
+  EXPECT_FALSE(end_of_sequence);
+}
+
 void SnapshotReaderBenchmarkLoop(int iters, std::string compression_type,
                                  int version) {
   tensorflow::testing::StopTiming();
@@ -78,6 +78,8 @@ namespace data {
 /* static */ constexpr const char* const
     ParallelInterleaveDatasetOp::kDeterministic;
 /* static */ constexpr const char* const ParallelInterleaveDatasetOp::kSloppy;
+/* static */ constexpr const char* const
+    ParallelInterleaveDatasetOp::kWorkStealing;
 
 namespace {
 
@@ -162,7 +164,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           std::unique_ptr<CapturedFunction> captured_func, int64 cycle_length,
           int64 block_length, int64 buffer_output_elements,
           int64 prefetch_input_elements, int64 num_parallel_calls,
-          DeterminismPolicy deterministic, const DataTypeVector& output_types,
+          DeterminismPolicy deterministic, bool work_stealing,
+          const DataTypeVector& output_types,
           const std::vector<PartialTensorShape>& output_shapes, int op_version)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
@@ -175,6 +178,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             prefetch_input_elements, cycle_length)),
         num_parallel_calls_(num_parallel_calls),
         deterministic_(deterministic),
+        work_stealing_(work_stealing),
         output_types_(output_types),
         output_shapes_(output_shapes),
         op_version_(op_version),
@@ -186,7 +190,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
              {"cycle_length",
               strings::Printf("%lld", static_cast<long long>(cycle_length))},
              {"deterministic",
-              deterministic.IsNondeterministic() ? "false" : "true"}}) {
+              deterministic.IsNondeterministic() ? "false" : "true"},
+             {"work_stealing", work_stealing ? "true" : "false"}}) {
     input_->Ref();
   }
 
@@ -299,6 +304,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       b->BuildAttrValue(deterministic_.String(), &deterministic_attr);
       attrs.emplace_back(kDeterministic, deterministic_attr);
     }
+    if (op_version_ >= 4) {
+      AttrValue work_stealing_attr;
+      b->BuildAttrValue(work_stealing_, &work_stealing_attr);
+      attrs.emplace_back(kWorkStealing, work_stealing_attr);
+    }
 
     TF_RETURN_IF_ERROR(b->AddDataset(this, inputs, list_inputs, attrs, output));
     return Status::OK();
@@ -840,6 +850,12 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             if (element) {
               break;
             }
+            if (dataset()->work_stealing_ && !wait_for_checkpoint_) {
+              element = StealFutureElement();
+              if (element) {
+                break;
+              }
+            }
             DecrementCurrentActiveWorkers();
             WaitWorkerThread(&current_workers_cond_var_, &l);
             IncrementCurrentActiveWorkers();
@@ -863,6 +879,13 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
               element->active = false;
               break;
             }
+            // With work stealing, hand the element back to the queue when
+            // other cycle elements are starved for a worker.
+            if (ShouldYield(element)) {
+              element->active = false;
+              elements_to_process_.push_back(element->cycle_index);
+              break;
+            }
           }
         }
       }
@@ -962,7 +985,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         mutex_lock l(*mu_);
         element->results.push_back(std::move(result));
         NotifyElementUpdate(element);
-        if (element->results.size() == dataset()->buffer_output_elements_) {
+        if (element->results.size() == dataset()->buffer_output_elements_ ||
+            ShouldYield(element)) {
           break;
         }
       }
@@ -1052,6 +1076,35 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    // Returns a new future element for an idle current worker to process, or
+    // null if there is nothing to steal. Idle current workers may prefetch up
+    // to `cycle_length` future elements beyond what the future workers keep,
+    // so that an element stuck behind a slow input does not leave them idle.
+    std::shared_ptr<Element> StealFutureElement()
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (future_elements_.size() >=
+          dataset()->prefetch_input_elements_ + dataset()->cycle_length_) {
+        return nullptr;
+      }
+      std::shared_ptr<Element> element = MakeElement();
+      if (!element) {
+        return nullptr;
+      }
+      VLOG(3) << "Current worker stole future element " << element->id;
+      future_elements_.push_back(element);
+      return element;
+    }
+
+    // Returns whether a worker processing the given cycle element should stop
+    // and let the element be picked up again later, because other cycle
+    // elements are waiting for processing while every current worker is busy.
+    bool ShouldYield(const std::shared_ptr<Element>& element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return dataset()->work_stealing_ && element->cycle_index != -1 &&
+             !elements_to_process_.empty() &&
+             num_current_active_workers_ >= num_current_workers_;
+    }
+
     bool NeedsProcessing(const std::shared_ptr<Element>& element)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (!element) {
@@ -1561,6 +1614,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
   const int64 prefetch_input_elements_;
   const int64 num_parallel_calls_;
   const DeterminismPolicy deterministic_;
+  // Whether idle current workers steal work from the rest of the pipeline
+  // instead of waiting for a cycle element to need processing.
+  const bool work_stealing_;
   const DataTypeVector output_types_;
   const std::vector<PartialTensorShape> output_shapes_;
   const int op_version_;
@@ -1591,6 +1647,9 @@ ParallelInterleaveDatasetOp::ParallelInterleaveDatasetOp(
     OP_REQUIRES_OK(
         ctx, DeterminismPolicy::FromString(deterministic, &deterministic_));
   }
+  if (ctx->HasAttr(kWorkStealing)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kWorkStealing, &work_stealing_));
+  }
 }
 
 void ParallelInterleaveDatasetOp::MakeDataset(OpKernelContext* ctx,
@@ -1664,7 +1723,8 @@ void ParallelInterleaveDatasetOp::MakeDataset(OpKernelContext* ctx,
   *output = new Dataset(
       ctx, input, std::move(captured_func), cycle_length, block_length,
       buffer_output_elements, prefetch_input_elements, num_parallel_calls,
-      deterministic_, output_types_, output_shapes_, op_version_);
+      deterministic_, work_stealing_, output_types_, output_shapes_,
+      op_version_);
 }
 
 namespace {
@@ -31,7 +31,8 @@ class ParallelInterleaveDatasetParams : public DatasetParams {
       std::vector<FunctionDef> func_lib, DataTypeVector type_arguments,
       const DataTypeVector& output_dtypes,
       const std::vector<PartialTensorShape>& output_shapes,
-      const std::string& deterministic, const std::string& node_name)
+      const std::string& deterministic, const std::string& node_name,
+      bool work_stealing = false)
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
         other_arguments_(std::move(other_arguments)),
@@ -43,7 +44,8 @@ class ParallelInterleaveDatasetParams : public DatasetParams {
         func_(std::move(func)),
         func_lib_(std::move(func_lib)),
         type_arguments_(std::move(type_arguments)),
-        deterministic_(deterministic) {
+        deterministic_(deterministic),
+        work_stealing_(work_stealing) {
     input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
     op_version_ = kOpVersion;
     name_utils::IteratorPrefixParams params;
@@ -88,6 +90,7 @@ class ParallelInterleaveDatasetParams : public DatasetParams {
     *attr_vector = {
         {ParallelInterleaveDatasetOp::kFunc, func_},
         {ParallelInterleaveDatasetOp::kDeterministic, deterministic_},
+        {ParallelInterleaveDatasetOp::kWorkStealing, work_stealing_},
         {ParallelInterleaveDatasetOp::kTarguments, type_arguments_},
         {ParallelInterleaveDatasetOp::kOutputShapes, output_shapes_},
         {ParallelInterleaveDatasetOp::kOutputTypes, output_dtypes_}};
@@ -111,6 +114,7 @@ class ParallelInterleaveDatasetParams : public DatasetParams {
   std::vector<FunctionDef> func_lib_;
   DataTypeVector type_arguments_;
   std::string deterministic_;
+  bool work_stealing_;
 };
 
 class ParallelInterleaveDatasetOpTest : public DatasetOpsTestBase {};
@@ -374,6 +378,35 @@ ParallelInterleaveDatasetParams ParallelInterleaveDatasetParams10() {
       /*node_name=*/kNodeName);
 }
 
+// Work stealing with fewer workers than cycle elements and no dedicated
+// prefetching of future cycle elements.
+ParallelInterleaveDatasetParams WorkStealingParams(
+    const std::string& deterministic) {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64>(TensorShape{3, 3, 1},
+                                          {0, 1, 2, 3, 4, 5, 6, 7, 8})},
+      /*node_name=*/"tensor_slice");
+  return ParallelInterleaveDatasetParams(
+      tensor_slice_dataset_params,
+      /*other_arguments=*/{},
+      /*cycle_length=*/2,
+      /*block_length=*/1,
+      /*buffer_output_elements=*/1,
+      /*prefetch_input_elements=*/0,
+      /*num_parallel_calls=*/1,
+      /*func=*/
+      MakeTensorSliceDatasetFunc(
+          DataTypeVector({DT_INT64}),
+          std::vector<PartialTensorShape>({PartialTensorShape({1})})),
+      /*func_lib=*/{test::function::MakeTensorSliceDataset()},
+      /*type_arguments=*/{},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({1})},
+      /*deterministic=*/deterministic,
+      /*node_name=*/kNodeName,
+      /*work_stealing=*/true);
+}
+
 ParallelInterleaveDatasetParams LongCycleDeterministicParams() {
   auto tensor_slice_dataset_params = TensorSliceDatasetParams(
       /*components=*/{CreateTensor<tstring>(
@@ -598,7 +631,19 @@ GetNextTestCases() {
            CreateTensors<tstring>(
                TensorShape{1},
                {{"a"}, {"d"}, {"g"}, {"b"}, {"e"}, {"h"}, {"c"}, {"f"}, {"i"}}),
-           /*compare_order=*/true}};
+           /*compare_order=*/true},
+          {/*dataset_params=*/
+           WorkStealingParams(DeterminismPolicy::kDeterministic),
+           /*expected_outputs=*/
+           CreateTensors<int64>(TensorShape{1},
+                                {{0}, {3}, {1}, {4}, {2}, {5}, {6}, {7}, {8}}),
+           /*compare_order=*/true},
+          {/*dataset_params=*/
+           WorkStealingParams(DeterminismPolicy::kNondeterministic),
+           /*expected_outputs=*/
+           CreateTensors<int64>(TensorShape{1},
+                                {{0}, {3}, {1}, {4}, {2}, {5}, {6}, {7}, {8}}),
+           /*compare_order=*/false}};
 }
 
 ITERATOR_GET_NEXT_TEST_P(ParallelInterleaveDatasetOpTest,
@@ -753,7 +798,14 @@ IteratorSaveAndRestoreTestCases() {
            CreateTensors<tstring>(
                TensorShape{1},
                {{"a"}, {"b"}, {"c"}, {"d"}, {"e"}, {"f"}, {"g"}, {"h"}, {"i"}}),
-           /*compare_order=*/false}};
+           /*compare_order=*/false},
+          {/*dataset_params=*/
+           WorkStealingParams(DeterminismPolicy::kDeterministic),
+           /*breakpoints=*/{0, 4, 11},
+           /*expected_outputs=*/
+           CreateTensors<int64>(TensorShape{1},
+                                {{0}, {3}, {1}, {4}, {2}, {5}, {6}, {7}, {8}}),
+           /*compare_order=*/true}};
 }
 
 ITERATOR_SAVE_AND_RESTORE_TEST_P(ParallelInterleaveDatasetOpTest,
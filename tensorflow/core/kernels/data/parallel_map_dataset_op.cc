@@ -240,6 +240,7 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
       std::shared_ptr<InvocationResult> result;
+      int64 wait_start_nanos = EnvTime::NowNanos();
       {
         mutex_lock l(*mu_);
         EnsureThreadsStarted(ctx);
@@ -255,6 +256,7 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       RecordStop(ctx);
       result->notification.WaitForNotification();
       RecordStart(ctx);
+      RecordConsumerWait(ctx, EnvTime::NowNanos() - wait_start_nanos);
       profiler::TraceMe traceme([&] {
         return profiler::TraceMeEncode("ParallelMapConsume",
                                        {{"element_id", result->uid}});
@@ -168,6 +168,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
                            bool* end_of_sequence) override {
       const auto& stats_aggregator = ctx->stats_aggregator();
       {
+        int64 wait_start_nanos = EnvTime::NowNanos();
         mutex_lock l(*mu_);
         TF_RETURN_IF_ERROR(EnsurePrefetchThreadStarted(ctx));
         // Wait until the next element in the buffer has been
@@ -189,6 +190,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
             RecordStart(ctx);
           }
         }
+        RecordConsumerWait(ctx, EnvTime::NowNanos() - wait_start_nanos);
 
         if (cancelled_) {
           return errors::Cancelled("Iterator was cancelled");
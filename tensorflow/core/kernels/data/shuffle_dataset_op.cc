@@ -18,6 +18,7 @@ limitations under the License.
 #include <tuple>
 #include <vector>
 
+#include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
@@ -26,10 +27,15 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/kernels/data/random_seed_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/stringprintf.h"
 
 namespace tensorflow {
@@ -48,6 +54,8 @@ namespace data {
     ShuffleDatasetOpBase::kReshuffleEachIteration;
 
 /* static */ constexpr const char* const ShuffleDatasetOp::kDatasetType;
+/* static */ constexpr const char* const ShuffleDatasetOp::kSpillDirectory;
+/* static */ constexpr const char* const ShuffleDatasetOp::kInMemoryBufferSize;
 
 /* static */ constexpr const char* const
     ShuffleAndRepeatDatasetOp::kDatasetType;
@@ -69,6 +77,11 @@ constexpr char kSize[] = "size";
 constexpr char kSeedGenerator[] = "SeedGenerator";
 constexpr char kTFData[] = "tf_data";
 constexpr char kEpochNumRandomSamples[] = "epoch_num_random_samples";
+constexpr char kOutputEpoch[] = "output_epoch";
+constexpr char kFillBuffer[] = "fill_buffer";
+constexpr char kNumRuns[] = "num_runs";
+constexpr char kRun[] = "run";
+constexpr char kRunFilePrefix[] = "shuffle_run";
 constexpr char kShuffleDatasetV1[] = "ShuffleDataset";
 constexpr char kShuffleDatasetV2[] = "ShuffleDatasetV2";
 constexpr char kShuffleDatasetV3[] = "ShuffleDatasetV3";
@@ -83,12 +96,16 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
  public:
   ShuffleDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
                      int64 buffer_size,
-                     std::shared_ptr<SeedGenerator> seed_generator, int64 count)
+                     std::shared_ptr<SeedGenerator> seed_generator, int64 count,
+                     const string& spill_directory = "",
+                     int64 in_memory_buffer_size = 0)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
         seed_generator_(std::move(seed_generator)),
         count_(count),
+        spill_directory_(spill_directory),
+        in_memory_buffer_size_(in_memory_buffer_size),
         traceme_metadata_(
             {{"buffer_size",
               strings::Printf("%lld", static_cast<long long>(buffer_size))}}) {
@@ -135,6 +152,13 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const string& prefix) const override {
+    if (!spill_directory_.empty() && in_memory_buffer_size_ > 0 &&
+        in_memory_buffer_size_ < buffer_size_) {
+      return absl::make_unique<ExternalIterator>(
+          ExternalIterator::Params{
+              this, name_utils::IteratorPrefix(op_type(), prefix)},
+          seed_generator_.get());
+    }
     return absl::make_unique<Iterator>(
         Iterator::Params{this, name_utils::IteratorPrefix(op_type(), prefix)},
         seed_generator_.get());
@@ -424,6 +448,403 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
     bool data_produced_ TF_GUARDED_BY(mu_) = false;
   };
 
+  // Shuffling iterator whose memory footprint is bounded by
+  // `in_memory_buffer_size_` elements instead of `buffer_size_`.
+  //
+  // Input elements are collected in an in-memory fill buffer. Whenever the fill
+  // buffer reaches `in_memory_buffer_size_` elements, or an epoch of the input
+  // ends, its contents are shuffled and spilled to a "run" file in
+  // `spill_directory_`. Runs are consumed sequentially, so producing an element
+  // only requires choosing a run (or the fill buffer) with probability
+  // proportional to the number of elements it holds. This samples uniformly
+  // from all buffered elements of the oldest buffered epoch, which matches the
+  // shuffle quality of `Iterator` with the same `buffer_size_`.
+  class ExternalIterator : public DatasetIterator<ShuffleDatasetBase> {
+   public:
+    explicit ExternalIterator(const Params& params,
+                              SeedGenerator* seed_generator)
+        : DatasetIterator<ShuffleDatasetBase>(params),
+          seed_generator_(seed_generator),
+          parent_generator_(seed_generator->seed(), seed_generator->seed2()),
+          generator_(&parent_generator_) {}
+
+    ~ExternalIterator() override {
+      mutex_lock l(mu_);
+      DeleteRuns();
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      env_ = ctx->env();
+      TF_RETURN_IF_ERROR(
+          env_->RecursivelyCreateDir(this->dataset()->spill_directory_));
+      run_file_prefix_ =
+          io::JoinPath(this->dataset()->spill_directory_,
+                       strings::StrCat(kRunFilePrefix, "_", random::New64()));
+      seed_generator_->GenerateSeeds(&seed_, &seed2_);
+      ResetRngs();
+      return Status::OK();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (!input_impl_ && epoch_ == 0) {
+        TF_RETURN_IF_ERROR(this->dataset()->input_->MakeIterator(
+            ctx, this, this->prefix(), &input_impl_));
+      }
+      while (input_impl_ && num_elements_ < this->dataset()->buffer_size_) {
+        std::vector<Tensor> input_element;
+        bool end_of_input_sequence = false;
+        while (this->dataset()->count_ == -1 ||
+               epoch_ < this->dataset()->count_) {
+          TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &input_element,
+                                                  &end_of_input_sequence));
+          if (!end_of_input_sequence) {
+            data_produced_ = true;
+            break;
+          }
+          if (ctx->split_provider() == nullptr && !data_produced_ &&
+              this->dataset()->count_ == -1) {
+            // If we encounter the end of sequence without producing data, we
+            // terminate the iteration immediately. (Otherwise, this iterator
+            // would loop infinitely and never produce a value.)
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          // A run only ever holds elements of a single epoch.
+          TF_RETURN_IF_ERROR(SpillFillBuffer(ctx));
+          epoch_++;
+          if (ctx->split_provider()) {
+            TF_RETURN_IF_ERROR(ctx->split_provider()->Reset());
+          }
+          TF_RETURN_IF_ERROR(this->dataset()->input_->MakeIterator(
+              ctx, this, this->prefix(), &input_impl_));
+        }
+        if (!end_of_input_sequence) {
+          this->RecordBufferEnqueue(ctx, input_element);
+          fill_.push_back(std::move(input_element));
+          num_elements_++;
+          if (fill_.size() >= this->dataset()->in_memory_buffer_size_) {
+            TF_RETURN_IF_ERROR(SpillFillBuffer(ctx));
+          }
+        } else {
+          input_impl_.reset();
+        }
+        if (epoch_ - OldestEpoch() >= kMaxEpochsInBuffer) {
+          // See `Iterator::GetNextInternal()`.
+          break;
+        }
+      }
+
+      if (num_elements_ == 0) {
+        DCHECK(input_impl_ == nullptr);
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+      *end_of_sequence = false;
+      const int64 oldest_epoch = OldestEpoch();
+      while (output_epoch_ < oldest_epoch) {
+        // Reinitialize the RNG state for the next epoch.
+        output_epoch_++;
+        num_random_samples_ = 0;
+        seed_generator_->GenerateSeeds(&seed_, &seed2_);
+        ResetRngs();
+      }
+      // Choose an element to produce uniformly at random from the elements of
+      // the oldest buffered epoch. These live in a prefix of `runs_` and, if
+      // the input is still in that epoch, in `fill_`.
+      const int64 num_fill_candidates =
+          epoch_ == oldest_epoch ? fill_.size() : 0;
+      int64 num_candidates = num_fill_candidates;
+      for (const auto& run : runs_) {
+        if (run->epoch != oldest_epoch) {
+          break;
+        }
+        num_candidates += run->num_remaining;
+      }
+      DCHECK_GT(num_candidates, 0);
+      int64 offset = Random() % num_candidates;
+      if (offset < num_fill_candidates) {
+        *out_tensors = std::move(fill_[offset]);
+        this->RecordBufferDequeue(ctx, *out_tensors);
+        std::swap(fill_[offset], fill_.back());
+        fill_.pop_back();
+      } else {
+        offset -= num_fill_candidates;
+        auto it = runs_.begin();
+        while (offset >= (*it)->num_remaining) {
+          offset -= (*it)->num_remaining;
+          ++it;
+        }
+        Run* run = it->get();
+        TF_RETURN_IF_ERROR(ReadElement(run->filename, run->reader.get(),
+                                       &run->offset, out_tensors));
+        if (--run->num_remaining == 0) {
+          DeleteRun(run);
+          runs_.erase(it);
+        }
+      }
+      num_elements_--;
+      return Status::OK();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    void ResetRngs() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      // Reset the generators based on the current iterator seeds.
+      parent_generator_ = random::PhiloxRandom(seed_, seed2_);
+      generator_ =
+          random::SingleSampleAdapter<random::PhiloxRandom>(&parent_generator_);
+      generator_.Skip(num_random_samples_);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      // Save state needed to restore the random number generators.
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kEpochNumRandomSamples),
+                              seed_generator_->num_random_samples()));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(this->full_name(kNumRandomSamples),
+                                             num_random_samples_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(this->full_name(kSeed), seed_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(this->full_name(kSeed2), seed2_));
+
+      if (!input_impl_) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(this->full_name(kEndOfInputSequence), ""));
+      } else {
+        TF_RETURN_IF_ERROR(this->SaveInput(ctx, writer, input_impl_));
+      }
+
+      TF_RETURN_IF_ERROR(writer->WriteScalar(this->full_name(kEpoch), epoch_));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(this->full_name(kOutputEpoch), output_epoch_));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(this->full_name(kNumElements), num_elements_));
+      TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(
+          writer, this->full_name(kFillBuffer), fill_));
+      // The unconsumed part of each run is checkpointed in its current order,
+      // one run at a time to keep the memory footprint bounded.
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(this->full_name(kNumRuns), runs_.size()));
+      for (size_t i = 0; i < runs_.size(); ++i) {
+        const Run& run = *runs_[i];
+        const string run_prefix =
+            this->full_name(strings::StrCat(kRun, "_", i));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(run_prefix, kEpoch, run.epoch));
+        io::RecordReader reader(run.file.get());
+        uint64 offset = run.offset;
+        std::vector<std::vector<Tensor>> elements(run.num_remaining);
+        for (auto& element : elements) {
+          TF_RETURN_IF_ERROR(
+              ReadElement(run.filename, &reader, &offset, &element));
+        }
+        TF_RETURN_IF_ERROR(
+            WriteElementsToCheckpoint(writer, run_prefix, elements));
+      }
+      if (data_produced_) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(this->full_name(kDataProduced), ""));
+      }
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      // Restore the random number generators.
+      int64 num_random_samples;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kEpochNumRandomSamples),
+                                            &num_random_samples));
+      seed_generator_->set_num_random_samples(num_random_samples);
+      seed_generator_->Reset();
+      TF_RETURN_IF_ERROR(reader->ReadScalar(this->full_name(kNumRandomSamples),
+                                            &num_random_samples_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(this->full_name(kSeed), &seed_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(this->full_name(kSeed2), &seed2_));
+      ResetRngs();
+
+      if (!reader->Contains(this->full_name(kEndOfInputSequence))) {
+        TF_RETURN_IF_ERROR(this->dataset()->input_->MakeIterator(
+            ctx, this, this->prefix(), &input_impl_));
+        TF_RETURN_IF_ERROR(this->RestoreInput(ctx, reader, input_impl_));
+      } else {
+        input_impl_.reset();
+      }
+
+      TF_RETURN_IF_ERROR(reader->ReadScalar(this->full_name(kEpoch), &epoch_));
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(this->full_name(kOutputEpoch), &output_epoch_));
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(this->full_name(kNumElements), &num_elements_));
+      fill_.clear();
+      TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+          reader, this->full_name(kFillBuffer), &fill_));
+      DeleteRuns();
+      int64 num_runs;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(this->full_name(kNumRuns), &num_runs));
+      for (int64 i = 0; i < num_runs; ++i) {
+        const string run_prefix =
+            this->full_name(strings::StrCat(kRun, "_", i));
+        int64 epoch;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(run_prefix, kEpoch, &epoch));
+        std::vector<std::vector<Tensor>> elements;
+        TF_RETURN_IF_ERROR(
+            ReadElementsFromCheckpoint(reader, run_prefix, &elements));
+        TF_RETURN_IF_ERROR(WriteRun(epoch, elements));
+      }
+      data_produced_ = reader->Contains(this->full_name(kDataProduced));
+      return Status::OK();
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      return this->dataset()->traceme_metadata_;
+    }
+
+   private:
+    // A shuffled sequence of elements of a single epoch stored in a file.
+    // Elements are consumed in file order; `offset` points at the next one.
+    struct Run {
+      string filename;
+      int64 epoch = 0;
+      int64 num_remaining = 0;
+      uint64 offset = 0;
+      std::unique_ptr<RandomAccessFile> file;
+      std::unique_ptr<io::RecordReader> reader;
+    };
+
+    random::SingleSampleAdapter<random::PhiloxRandom>::ResultType Random()
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      num_random_samples_++;
+      auto out = generator_();
+      return out;
+    }
+
+    // Returns the earliest epoch that still has elements in the buffer.
+    int64 OldestEpoch() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return runs_.empty() ? epoch_ : runs_.front()->epoch;
+    }
+
+    // Shuffles the elements of `fill_` and moves them to a new run.
+    Status SpillFillBuffer(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (fill_.empty()) {
+        return Status::OK();
+      }
+      for (int64 i = fill_.size() - 1; i > 0; --i) {
+        std::swap(fill_[i], fill_[Random() % (i + 1)]);
+      }
+      TF_RETURN_IF_ERROR(WriteRun(epoch_, fill_));
+      for (const auto& element : fill_) {
+        this->RecordBufferDequeue(ctx, element);
+      }
+      fill_.clear();
+      return Status::OK();
+    }
+
+    // Writes `elements` in order to a new run file and appends it to `runs_`.
+    Status WriteRun(int64 epoch,
+                    const std::vector<std::vector<Tensor>>& elements)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      auto run = absl::make_unique<Run>();
+      run->filename =
+          strings::StrCat(run_file_prefix_, "_", num_runs_written_++);
+      run->epoch = epoch;
+      run->num_remaining = elements.size();
+      Status s = WriteRunFile(run->filename, elements);
+      if (s.ok()) {
+        s = env_->NewRandomAccessFile(run->filename, &run->file);
+      }
+      if (!s.ok()) {
+        env_->DeleteFile(run->filename).IgnoreError();
+        return s;
+      }
+      run->reader = absl::make_unique<io::RecordReader>(run->file.get());
+      runs_.push_back(std::move(run));
+      return Status::OK();
+    }
+
+    Status WriteRunFile(const string& filename,
+                        const std::vector<std::vector<Tensor>>& elements)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      std::unique_ptr<WritableFile> file;
+      TF_RETURN_IF_ERROR(env_->NewWritableFile(filename, &file));
+      io::RecordWriter writer(file.get());
+      string record;
+      for (const auto& element : elements) {
+        // CompressElement() appends to the metadata of `compressed`, so each
+        // element needs a fresh message.
+        CompressedElement compressed;
+        TF_RETURN_IF_ERROR(CompressElement(element, &compressed));
+        compressed.SerializeToString(&record);
+        TF_RETURN_IF_ERROR(writer.WriteRecord(record));
+      }
+      TF_RETURN_IF_ERROR(writer.Close());
+      return file->Close();
+    }
+
+    static Status ReadElement(const string& filename, io::RecordReader* reader,
+                              uint64* offset, std::vector<Tensor>* element) {
+      tstring record;
+      TF_RETURN_IF_ERROR(reader->ReadRecord(offset, &record));
+      CompressedElement compressed;
+      if (!compressed.ParseFromArray(record.data(), record.size())) {
+        return errors::DataLoss("Failed to parse shuffle buffer element from ",
+                                filename);
+      }
+      return UncompressElement(compressed, element);
+    }
+
+    void DeleteRun(Run* run) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      run->reader.reset();
+      run->file.reset();
+      Status s = env_->DeleteFile(run->filename);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to delete shuffle buffer file "
+                     << run->filename << ": " << s.ToString();
+      }
+    }
+
+    void DeleteRuns() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (auto& run : runs_) {
+        DeleteRun(run.get());
+      }
+      runs_.clear();
+    }
+
+    mutex mu_;
+    SeedGenerator* const seed_generator_ TF_GUARDED_BY(mu_);  // Not owned.
+    Env* env_ TF_GUARDED_BY(mu_) = nullptr;
+    string run_file_prefix_ TF_GUARDED_BY(mu_);
+    int64 num_runs_written_ TF_GUARDED_BY(mu_) = 0;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_) = nullptr;
+    // The epoch the input iterator is in; all of `fill_` belongs to it.
+    int64 epoch_ TF_GUARDED_BY(mu_) = 0;
+    // The epoch of the most recently produced element.
+    int64 output_epoch_ TF_GUARDED_BY(mu_) = 0;
+    // The number of elements in `fill_` and `runs_`.
+    int64 num_elements_ TF_GUARDED_BY(mu_) = 0;
+    int64 seed_ TF_GUARDED_BY(mu_) = 0;
+    int64 seed2_ TF_GUARDED_BY(mu_) = 0;
+    std::vector<std::vector<Tensor>> fill_ TF_GUARDED_BY(mu_);
+    // Non-empty runs ordered by epoch.
+    std::deque<std::unique_ptr<Run>> runs_ TF_GUARDED_BY(mu_);
+    random::PhiloxRandom parent_generator_ TF_GUARDED_BY(mu_);
+    random::SingleSampleAdapter<random::PhiloxRandom> generator_
+        TF_GUARDED_BY(mu_);
+    int64 num_random_samples_ TF_GUARDED_BY(mu_) = 0;
+    bool data_produced_ TF_GUARDED_BY(mu_) = false;
+  };
+
   const DatasetBase* const input_;
   const int64 buffer_size_;
   const std::shared_ptr<SeedGenerator> seed_generator_;
@@ -431,6 +852,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   // fuse shuffle and repeat together, and make the shuffle dataset op
   // responsible for repeating as well.
   const int64 count_;
+  // Configuration of `ExternalIterator`; unused unless both are set.
+  const string spill_directory_;
+  const int64 in_memory_buffer_size_;
   const TraceMeMetadata traceme_metadata_;
 };  // ShuffleDatasetBase
 
@@ -554,8 +978,10 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
  public:
   DatasetV3(OpKernelContext* ctx, const DatasetBase* input, int64 buffer_size,
             int64 count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-            ResourceHandle&& resource_handle, bool owns_resource)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+            ResourceHandle&& resource_handle, bool owns_resource,
+            const string& spill_directory, int64 in_memory_buffer_size)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           spill_directory, in_memory_buffer_size),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -594,13 +1020,18 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
-    TF_RETURN_IF_ERROR(
-        b->AddDataset(this,
-                      {input_graph_node, buffer_size_node, seed_node,
-                       seed2_node, resource_handle_node},  // Inputs
-                      {std::make_pair(kReshuffleEachIteration,
-                                      reshuffle_each_iteration)},  // Attrs
-                      output));
+    AttrValue spill_directory;
+    b->BuildAttrValue(spill_directory_, &spill_directory);
+    AttrValue in_memory_buffer_size;
+    b->BuildAttrValue(in_memory_buffer_size_, &in_memory_buffer_size);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {input_graph_node, buffer_size_node, seed_node, seed2_node,
+         resource_handle_node},  // Inputs
+        {std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration),
+         std::make_pair(kSpillDirectory, spill_directory),
+         std::make_pair(kInMemoryBufferSize, in_memory_buffer_size)},  // Attrs
+        output));
     return Status::OK();
   }
 
@@ -626,6 +1057,17 @@ ShuffleDatasetOp::ShuffleDatasetOp(OpKernelConstruction* ctx)
     OP_REQUIRES_OK(
         ctx, ctx->GetAttr(kReshuffleEachIteration, &reshuffle_each_iteration_));
   }
+  if (ctx->HasAttr(kSpillDirectory)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kSpillDirectory, &spill_directory_));
+  }
+  if (ctx->HasAttr(kInMemoryBufferSize)) {
+    OP_REQUIRES_OK(
+        ctx, ctx->GetAttr(kInMemoryBufferSize, &in_memory_buffer_size_));
+    OP_REQUIRES(ctx, in_memory_buffer_size_ >= 0,
+                errors::InvalidArgument(
+                    "in_memory_buffer_size must be non-negative, but got ",
+                    in_memory_buffer_size_));
+  }
 }
 
 void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -676,9 +1118,10 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
     }
 
     // Ownership of manager is transferred onto `DatasetV3`.
-    *output = new ShuffleDatasetOp::DatasetV3(ctx, input, buffer_size, count,
-                                              std::move(seeds), manager,
-                                              std::move(handle), owns_resource);
+    *output = new ShuffleDatasetOp::DatasetV3(
+        ctx, input, buffer_size, count, std::move(seeds), manager,
+        std::move(handle), owns_resource, spill_directory_,
+        in_memory_buffer_size_);
   } else if (op_version_ == 2) {
     auto handle = HandleFromInput(ctx, 2);
     SeedGeneratorManager* manager = nullptr;
@@ -40,6 +40,9 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
 class ShuffleDatasetOp : public ShuffleDatasetOpBase {
  public:
   static constexpr const char* const kDatasetType = "Shuffle";
+  static constexpr const char* const kSpillDirectory = "spill_directory";
+  static constexpr const char* const kInMemoryBufferSize =
+      "in_memory_buffer_size";
 
   explicit ShuffleDatasetOp(OpKernelConstruction* ctx);
 
@@ -53,6 +56,11 @@ class ShuffleDatasetOp : public ShuffleDatasetOpBase {
   class DatasetV3;
   int op_version_ = 0;
   bool reshuffle_each_iteration_ = true;
+  // If non-empty, together with a positive `in_memory_buffer_size_` smaller
+  // than the buffer size, enables external shuffling with runs of shuffled
+  // elements spilled to files in this directory.
+  string spill_directory_;
+  int64 in_memory_buffer_size_ = 0;
 };
 
 class ShuffleAndRepeatDatasetOp : public ShuffleDatasetOpBase {
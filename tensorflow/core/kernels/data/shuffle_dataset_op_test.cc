@@ -13,6 +13,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/dataset_test_base.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 namespace data {
@@ -20,6 +22,7 @@ namespace {
 
 constexpr char kShuffleNodeName[] = "shuffle_dataset";
 constexpr char kShuffleAndRepeatNodeName[] = "shuffle_and_repeat_dataset";
+constexpr char kSeedGenerator[] = "seed_generator";
 
 class ShuffleDatasetParams : public DatasetParams {
  public:
@@ -28,14 +31,21 @@ class ShuffleDatasetParams : public DatasetParams {
                        int64 seed2, int64 count, bool reshuffle_each_iteration,
                        DataTypeVector output_dtypes,
                        std::vector<PartialTensorShape> output_shapes,
-                       string node_name)
+                       string node_name, string spill_directory = "",
+                       int64 in_memory_buffer_size = 0)
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
         buffer_size_(buffer_size),
         seed_(seed),
         seed2_(seed2),
         count_(count),
-        reshuffle_each_iteration_(reshuffle_each_iteration) {
+        reshuffle_each_iteration_(reshuffle_each_iteration),
+        spill_directory_(std::move(spill_directory)),
+        in_memory_buffer_size_(in_memory_buffer_size) {
+    // External shuffling is only exposed by `ShuffleDatasetV3`.
+    if (!spill_directory_.empty()) {
+      op_version_ = 3;
+    }
     input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
     iterator_prefix_ =
         name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
@@ -51,6 +61,11 @@ class ShuffleDatasetParams : public DatasetParams {
       input_tensors.emplace_back(
           CreateTensor<int64>(TensorShape({}), {count_}));
     }
+    if (op_version_ == 3) {
+      // An unset handle makes the kernel create its own seed generator.
+      input_tensors.emplace_back(
+          CreateTensor<ResourceHandle>(TensorShape({}), {ResourceHandle()}));
+    }
     return input_tensors;
   }
 
@@ -63,6 +78,9 @@ class ShuffleDatasetParams : public DatasetParams {
     if (count_ != 1) {
       input_names->emplace_back(ShuffleAndRepeatDatasetOp::kCount);
     }
+    if (op_version_ == 3) {
+      input_names->emplace_back(kSeedGenerator);
+    }
     return Status::OK();
   }
 
@@ -74,6 +92,12 @@ class ShuffleDatasetParams : public DatasetParams {
                               output_shapes_);
     attr_vector->emplace_back(ShuffleDatasetOp::kReshuffleEachIteration,
                               reshuffle_each_iteration_);
+    if (op_version_ == 3) {
+      attr_vector->emplace_back(ShuffleDatasetOp::kSpillDirectory,
+                                spill_directory_);
+      attr_vector->emplace_back(ShuffleDatasetOp::kInMemoryBufferSize,
+                                in_memory_buffer_size_);
+    }
     return Status::OK();
   }
 
@@ -86,12 +110,16 @@ class ShuffleDatasetParams : public DatasetParams {
 
   int64 count() const { return count_; }
 
+  const string& spill_directory() const { return spill_directory_; }
+
  private:
   int64 buffer_size_;
   int64 seed_;
   int64 seed2_;
   int64 count_;
   bool reshuffle_each_iteration_;
+  string spill_directory_;
+  int64 in_memory_buffer_size_;
 };
 
 class ShuffleDatasetOpTest : public DatasetOpsTestBase {};
@@ -240,6 +268,23 @@ ShuffleDatasetParams ShuffleAndRepeatDatasetParamsWithInvalidCount() {
                               /*node_name=*/kShuffleAndRepeatNodeName);
 }
 
+// Test case: shuffle_dataset that keeps at most 4 of its 10 buffered elements
+// in memory and spills the rest to files.
+ShuffleDatasetParams ExternalShuffleDatasetParams(const string& test_name) {
+  return ShuffleDatasetParams(
+      RangeDatasetParams(0, 20, 1),
+      /*buffer_size=*/10,
+      /*seed=*/1,
+      /*seed2=*/2,
+      /*count=*/1,
+      /*reshuffle_each_iteration=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kShuffleNodeName,
+      /*spill_directory=*/io::JoinPath(testing::TmpDir(), test_name),
+      /*in_memory_buffer_size=*/4);
+}
+
 template <typename T>
 struct GetNextTestCase {
   T dataset_params;
@@ -549,6 +594,84 @@ INSTANTIATE_TEST_CASE_P(ShuffleDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+TEST_F(ShuffleDatasetOpTest, ExternalShuffle) {
+  auto dataset_params = ExternalShuffleDatasetParams("external_shuffle");
+  TF_ASSERT_OK(Initialize(dataset_params));
+
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  std::vector<string> spill_files;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+    if (out_tensors.size() == 1) {
+      // Filling the buffer of 10 elements spills two runs of 4 elements.
+      TF_ASSERT_OK(Env::Default()->GetChildren(
+          dataset_params.spill_directory(), &spill_files));
+      EXPECT_EQ(spill_files.size(), 2);
+    }
+  }
+  std::vector<Tensor> expected_outputs;
+  for (int64 i = 0; i < 20; ++i) {
+    expected_outputs.push_back(CreateTensor<int64>(TensorShape({}), {i}));
+  }
+  TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                           /*compare_order=*/false));
+  // Runs are deleted once they have been consumed.
+  TF_ASSERT_OK(Env::Default()->GetChildren(dataset_params.spill_directory(),
+                                           &spill_files));
+  EXPECT_TRUE(spill_files.empty());
+}
+
+TEST_F(ShuffleDatasetOpTest, ExternalShuffleSaveAndRestore) {
+  auto dataset_params =
+      ExternalShuffleDatasetParams("external_shuffle_save_and_restore");
+  TF_ASSERT_OK(Initialize(dataset_params));
+
+  // The seeds are fixed, so an uninterrupted iteration produces the expected
+  // order.
+  bool end_of_sequence = false;
+  std::vector<Tensor> expected_outputs;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    expected_outputs.insert(expected_outputs.end(), next.begin(), next.end());
+  }
+
+  std::unique_ptr<SerializationContext> serialization_ctx;
+  TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+  TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &iterator_));
+  end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  int cur_iteration = 0;
+  for (int breakpoint : {0, 5, 13, 21}) {
+    VariantTensorDataWriter writer;
+    TF_EXPECT_OK(iterator_->Save(serialization_ctx.get(), &writer));
+    std::vector<const VariantTensorData*> data;
+    writer.GetData(&data);
+    VariantTensorDataReader reader(data);
+    TF_EXPECT_OK(RestoreIterator(iterator_ctx_.get(), &reader,
+                                 dataset_params.iterator_prefix(), *dataset_,
+                                 &iterator_));
+
+    while (cur_iteration <= breakpoint) {
+      std::vector<Tensor> next;
+      TF_EXPECT_OK(
+          iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+      cur_iteration++;
+    }
+  }
+
+  TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                           /*compare_order=*/true));
+}
+
 TEST_F(ShuffleDatasetOpTest, InvalidArguments) {
   std::vector<ShuffleDatasetParams> dataset_params_vec(
       {ShuffleDatasetParamsWithInvalidBufferSize(),
@@ -144,6 +144,31 @@ class TensorSliceDatasetOp::Dataset : public DatasetBase {
       return Status::OK();
     }
 
+    // Copies the slice straight from the dataset tensors into the batch
+    // buffers, skipping the per-element tensors `GetNextInternal` produces.
+    Status GetNextIntoSliceInternal(IteratorContext* ctx, int64 index,
+                                    std::vector<Tensor>* batch,
+                                    bool* end_of_sequence) override {
+      if (batch->size() != dataset()->tensors_.size()) {
+        return errors::InvalidArgument(
+            "Cannot copy an element with ", dataset()->tensors_.size(),
+            " components into a batch with ", batch->size(), " components.");
+      }
+      Tensor split;
+      TF_RETURN_IF_ERROR(split_provider_->GetNext(&split, end_of_sequence));
+      if (*end_of_sequence) {
+        return Status::OK();
+      }
+      int64 src_index = split.scalar<int64>()();
+      for (size_t i = 0; i < dataset()->tensors_.size(); ++i) {
+        TF_RETURN_IF_ERROR(batch_util::CopyContiguousSlices(
+            dataset()->tensors_[i], src_index, index, /*num_slices=*/1,
+            &(*batch)[i]));
+      }
+      *end_of_sequence = false;
+      return Status::OK();
+    }
+
    protected:
     std::shared_ptr<model::Node> CreateNode(
         IteratorContext* ctx, model::Node::Args args) const override {
@@ -14,13 +14,19 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <atomic>
+#include <deque>
+
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
+#include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/record_block.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
@@ -35,13 +41,18 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kFileNames;
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
+/* static */ constexpr const char* const TFRecordDatasetOp::kMaxReadaheadBytes;
 
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
+constexpr char kRecordInBlock[] = "record_in_block";
 constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64 kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64 kS3BlockSize = kCloudTpuBlockSize;
+// Maximum number of blocks of a block-compressed file that are read ahead and
+// decompressed in parallel.
+constexpr size_t kMaxParallelBlocks = 8;
 
 bool is_cloud_tpu_gcs_fs() {
 #if defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)
@@ -53,14 +64,18 @@ bool is_cloud_tpu_gcs_fs() {
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                   const string& compression_type, int64 buffer_size)
+                   const string& compression_type, int64 buffer_size,
+                   int64 max_readahead_bytes)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
+        block_compressed_(compression_type == io::compression::kBlockSnappy),
+        // Blocks are stored as the records of an uncompressed file.
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
-            compression_type)) {
+            block_compressed_ ? io::compression::kNone : compression_type)) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
+      options_.max_readahead_bytes = max_readahead_bytes;
     }
   }
 
@@ -101,8 +116,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
-    TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
+    AttrValue max_readahead_bytes;
+    b->BuildAttrValue(options_.max_readahead_bytes, &max_readahead_bytes);
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {filenames, compression_type, buffer_size},
+                      {{kMaxReadaheadBytes, max_readahead_bytes}}, output));
     return Status::OK();
   }
 
@@ -122,8 +140,8 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         if (reader_) {
           out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
                                     TensorShape({}));
-          Status s =
-              reader_->ReadRecord(&out_tensors->back().scalar<tstring>()());
+          Status s = ReadRecordLocked(ctx,
+                                      &out_tensors->back().scalar<tstring>()());
           if (s.ok()) {
             static monitoring::CounterCell* bytes_counter =
                 metrics::GetTFDataBytesReadCounter(kDatasetType);
@@ -167,8 +185,8 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         // the next (num_to_skip - *num_skipped) record.
         if (reader_) {
           int last_num_skipped;
-          Status s = reader_->SkipRecords(num_to_skip - *num_skipped,
-                                          &last_num_skipped);
+          Status s = SkipRecordsLocked(ctx->env(), num_to_skip - *num_skipped,
+                                       &last_num_skipped);
           *num_skipped += last_num_skipped;
           if (s.ok()) {
             *end_of_sequence = false;
@@ -211,7 +229,16 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCurrentFileIndex),
                                              current_file_index_));
 
-      if (reader_) {
+      if (reader_ && dataset()->block_compressed_) {
+        // Blocks that have been decompressed ahead of time are read again
+        // after restoring, so save the position within the first of them.
+        const uint64 offset =
+            blocks_.empty() ? reader_->TellOffset() : blocks_.front().offset;
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kOffset), offset));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            full_name(kRecordInBlock),
+            static_cast<int64>(blocks_.empty() ? 0 : next_record_)));
+      } else if (reader_) {
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(full_name(kOffset), reader_->TellOffset()));
       }
@@ -232,6 +259,14 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
         TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
       }
+      if (reader->Contains(full_name(kRecordInBlock))) {
+        int64 record_in_block;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kRecordInBlock),
+                                              &record_in_block));
+        int num_skipped;
+        TF_RETURN_IF_ERROR(SkipBlockRecordsLocked(
+            static_cast<int>(record_in_block), &num_skipped));
+      }
       return Status::OK();
     }
 
@@ -256,8 +291,230 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       reader_.reset();
       file_.reset();
+      index_.reset();
+      index_loaded_ = false;
+      blocks_.clear();
+      next_record_ = 0;
+    }
+
+    // Reads the next record of the current file.
+    Status ReadRecordLocked(IteratorContext* ctx, tstring* record)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!dataset()->block_compressed_) {
+        return reader_->ReadRecord(record);
+      }
+      while (true) {
+        while (!blocks_.empty() &&
+               next_record_ == blocks_.front().records.size()) {
+          blocks_.pop_front();
+          next_record_ = 0;
+        }
+        if (!blocks_.empty()) {
+          break;
+        }
+        TF_RETURN_IF_ERROR(ReadBlocksLocked(ctx));
+      }
+      *record = std::move(blocks_.front().records[next_record_++]);
+      return Status::OK();
+    }
+
+    // Reads up to `kMaxParallelBlocks` blocks of the current file and
+    // decompresses them, with help from the runner of `ctx`. Returns
+    // `OutOfRange` if the end of the file has been reached.
+    //
+    // The calling thread decompresses every block that no runner thread has
+    // started on, so while holding `mu_` it never waits for runner threads to
+    // be scheduled, only for decompressions that are already running. Runner
+    // threads that start late find no block left.
+    Status ReadBlocksLocked(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      auto batch = std::make_shared<DecodeBatch>();
+      std::vector<uint64> offsets;
+      Status s;
+      while (batch->raw_blocks.size() < kMaxParallelBlocks) {
+        const uint64 offset = reader_->TellOffset();
+        tstring raw_block;
+        s = reader_->ReadRecord(&raw_block);
+        if (!s.ok()) {
+          break;
+        }
+        offsets.push_back(offset);
+        batch->raw_blocks.push_back(std::move(raw_block));
+      }
+      const size_t num_blocks = batch->raw_blocks.size();
+      if (num_blocks == 0) {
+        return s;
+      }
+
+      batch->decoded.resize(num_blocks);
+      batch->statuses.resize(num_blocks);
+      for (size_t i = 1; i < num_blocks; ++i) {
+        (*ctx->runner())([batch]() { batch->DecodeBlocks(); });
+      }
+      batch->DecodeBlocks();
+      {
+        mutex_lock l(batch->mu);
+        while (batch->num_decoded < num_blocks) {
+          batch->cv.wait(l);
+        }
+      }
+
+      for (size_t i = 0; i < num_blocks; ++i) {
+        TF_RETURN_IF_ERROR(batch->statuses[i]);
+        batch->decoded[i].offset = offsets[i];
+        blocks_.push_back(std::move(batch->decoded[i]));
+      }
+      return Status::OK();
+    }
+
+    // Skips records of the current block-compressed file. Blocks that are
+    // skipped entirely are not decompressed.
+    Status SkipBlockRecordsLocked(int num_to_skip, int* num_skipped)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      *num_skipped = 0;
+      while (*num_skipped < num_to_skip && !blocks_.empty()) {
+        const size_t available =
+            blocks_.front().records.size() - next_record_;
+        const size_t n =
+            std::min(static_cast<size_t>(num_to_skip - *num_skipped),
+                     available);
+        next_record_ += n;
+        *num_skipped += n;
+        if (next_record_ == blocks_.front().records.size()) {
+          blocks_.pop_front();
+          next_record_ = 0;
+        }
+      }
+      tstring raw_block;
+      while (*num_skipped < num_to_skip) {
+        const uint64 offset = reader_->TellOffset();
+        TF_RETURN_IF_ERROR(reader_->ReadRecord(&raw_block));
+        uint32 num_records;
+        TF_RETURN_IF_ERROR(io::GetRecordBlockSize(raw_block, &num_records));
+        const int remaining = num_to_skip - *num_skipped;
+        if (num_records <= static_cast<uint32>(remaining)) {
+          *num_skipped += num_records;
+          continue;
+        }
+        DecodedBlock block;
+        block.offset = offset;
+        TF_RETURN_IF_ERROR(io::DecodeRecordBlock(raw_block, &block.records));
+        blocks_.push_back(std::move(block));
+        next_record_ = remaining;
+        *num_skipped += remaining;
+      }
+      return Status::OK();
     }
 
+    // Loads the sidecar `RecordIndex` of the current file, if there is one
+    // and it matches the file's current size. This is done lazily on the
+    // first skip so that plain iteration does not pay for the extra file
+    // system lookups.
+    void MaybeLoadIndexLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (index_loaded_) {
+        return;
+      }
+      index_loaded_ = true;
+      if (dataset()->options_.compression_type !=
+          io::RecordReaderOptions::NONE) {
+        return;
+      }
+      const string& filename = dataset()->filenames_[current_file_index_];
+      const string index_filename = io::RecordIndex::IndexFilename(filename);
+      if (!env->FileExists(index_filename).ok()) {
+        return;
+      }
+      auto index = absl::make_unique<io::RecordIndex>();
+      Status s = io::RecordIndex::Load(env, index_filename, index.get());
+      if (!s.ok()) {
+        LOG(WARNING) << "Ignoring record index " << index_filename << ": "
+                     << s;
+        return;
+      }
+      uint64 file_size;
+      s = env->GetFileSize(filename, &file_size);
+      if (!s.ok()) {
+        LOG(WARNING) << "Ignoring record index " << index_filename << ": "
+                     << s;
+        return;
+      }
+      // The file has been rewritten or appended to since the index was
+      // written, so its offsets may be wrong.
+      if (file_size != index->file_length()) {
+        LOG(WARNING) << "Ignoring record index " << index_filename
+                     << ", which is for a file of " << index->file_length()
+                     << " bytes, but " << filename << " has " << file_size
+                     << " bytes.";
+        return;
+      }
+      index_ = std::move(index);
+    }
+
+    // Skips records of the current file, seeking directly to the target record
+    // if the file has an index and scanning record headers otherwise.
+    Status SkipRecordsLocked(Env* env, int num_to_skip, int* num_skipped)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (dataset()->block_compressed_) {
+        return SkipBlockRecordsLocked(num_to_skip, num_skipped);
+      }
+      MaybeLoadIndexLocked(env);
+      uint64 current_record;
+      if (index_ &&
+          index_->RecordNumber(reader_->TellOffset(), &current_record).ok()) {
+        const uint64 remaining = index_->num_records() - current_record;
+        if (static_cast<uint64>(num_to_skip) <= remaining) {
+          *num_skipped = num_to_skip;
+          return reader_->SeekOffset(
+              index_->offset(current_record + num_to_skip));
+        }
+        // Skip to the end of the indexed records, then scan any that follow
+        // (none for indices written by RecordWriter).
+        TF_RETURN_IF_ERROR(
+            reader_->SeekOffset(index_->offset(index_->num_records())));
+        int num_scanned = 0;
+        Status s = reader_->SkipRecords(num_to_skip - remaining, &num_scanned);
+        *num_skipped = remaining + num_scanned;
+        return s;
+      }
+      return reader_->SkipRecords(num_to_skip, num_skipped);
+    }
+
+    // The records of a block of a block-compressed file.
+    struct DecodedBlock {
+      // Offset of the block in the file.
+      uint64 offset = 0;
+      std::vector<tstring> records;
+    };
+
+    // Blocks decompressed by `ReadBlocksLocked()`. Shared with the runner
+    // threads, which may outlive the call.
+    struct DecodeBatch {
+      // Decompresses blocks until none is left to start on.
+      void DecodeBlocks() {
+        size_t n = 0;
+        for (size_t i = next_block++; i < raw_blocks.size();
+             i = next_block++) {
+          statuses[i] =
+              io::DecodeRecordBlock(raw_blocks[i], &decoded[i].records);
+          ++n;
+        }
+        if (n > 0) {
+          mutex_lock l(mu);
+          num_decoded += n;
+          cv.notify_all();
+        }
+      }
+
+      std::vector<tstring> raw_blocks;
+      std::vector<DecodedBlock> decoded;
+      std::vector<Status> statuses;
+      // Index of the next block to start decompressing.
+      std::atomic<size_t> next_block{0};
+      mutex mu;
+      condition_variable cv;
+      size_t num_decoded TF_GUARDED_BY(mu) = 0;
+    };
+
     mutex mu_;
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
 
@@ -265,15 +522,28 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
+    // Index of the current file, if it has one and it has been loaded.
+    std::unique_ptr<io::RecordIndex> index_ TF_GUARDED_BY(mu_);
+    bool index_loaded_ TF_GUARDED_BY(mu_) = false;
+    // Decompressed blocks of the current block-compressed file that have not
+    // been fully consumed, and the index of the next record in the first one.
+    std::deque<DecodedBlock> blocks_ TF_GUARDED_BY(mu_);
+    size_t next_record_ TF_GUARDED_BY(mu_) = 0;
   };
 
   const std::vector<string> filenames_;
   const tstring compression_type_;
+  const bool block_compressed_;
   io::RecordReaderOptions options_;
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
-    : DatasetOpKernel(ctx) {}
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kMaxReadaheadBytes, &max_readahead_bytes_));
+  OP_REQUIRES(ctx, max_readahead_bytes_ >= 0,
+              errors::InvalidArgument(
+                  "`max_readahead_bytes` must be >= 0 (0 == no readahead)"));
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -321,8 +591,8 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kS3BlockSize;
   }
 
-  *output =
-      new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+  *output = new Dataset(ctx, std::move(filenames), compression_type,
+                        buffer_size, max_readahead_bytes_);
 }
 
 namespace {
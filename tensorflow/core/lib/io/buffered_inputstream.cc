@@ -15,11 +15,22 @@ limitations under the License.
 
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace io {
 
+namespace {
+
+// Number of consecutive refills after which reads are considered sequential.
+constexpr int kSequentialFillsForReadahead = 2;
+
+}  // namespace
+
 BufferedInputStream::BufferedInputStream(InputStreamInterface* input_stream,
                                          size_t buffer_bytes,
                                          bool owns_input_stream)
@@ -35,24 +46,81 @@ BufferedInputStream::BufferedInputStream(RandomAccessFile* file,
                           true) {}
 
 BufferedInputStream::~BufferedInputStream() {
+  if (readahead_done_) {
+    readahead_done_->WaitForNotification();
+  }
   if (owns_input_stream_) {
     delete input_stream_;
   }
 }
 
+void BufferedInputStream::EnableReadahead(size_t max_buffer_bytes) {
+  max_size_ = std::max(max_buffer_bytes, size_);
+}
+
 Status BufferedInputStream::FillBuffer() {
-  if (!file_status_.ok()) {
+  if (readahead_done_) {
+    // The buffer has been consumed, so the readahead data replaces it.
+    readahead_done_->WaitForNotification();
+    readahead_done_.reset();
+    buf_.swap(readahead_buf_);
+    if (!readahead_status_.ok()) {
+      file_status_ = readahead_status_;
+    }
+  } else if (!file_status_.ok()) {
     pos_ = 0;
     limit_ = 0;
     return file_status_;
+  } else {
+    Status s = input_stream_->ReadNBytes(size_, &buf_);
+    if (!s.ok()) {
+      file_status_ = s;
+    }
   }
-  Status s = input_stream_->ReadNBytes(size_, &buf_);
   pos_ = 0;
   limit_ = buf_.size();
-  if (!s.ok()) {
-    file_status_ = s;
+  if (max_size_ > 0 && file_status_.ok() &&
+      ++sequential_fills_ >= kSequentialFillsForReadahead) {
+    StartReadahead();
+  }
+  return file_status_;
+}
+
+void BufferedInputStream::StartReadahead() {
+  thread::ThreadPool* pool = RandomAccessFile::AsyncReadThreadPool();
+  if (pool->CurrentThreadId() >= 0) {
+    // This stream is being read by another stream's readahead, which must
+    // not wait for work on the same pool.
+    return;
+  }
+  size_ = std::min(2 * size_, max_size_);
+  readahead_pos_ = input_stream_->Tell();
+  readahead_done_ = std::make_shared<Notification>();
+  std::shared_ptr<Notification> done = readahead_done_;
+  const int64 bytes_to_read = size_;
+  pool->Schedule([this, bytes_to_read, done]() {
+    readahead_status_ =
+        input_stream_->ReadNBytes(bytes_to_read, &readahead_buf_);
+    done->Notify();
+  });
+}
+
+void BufferedInputStream::FinishReadahead() {
+  if (!readahead_done_) {
+    return;
+  }
+  readahead_done_->WaitForNotification();
+  readahead_done_.reset();
+  tstring merged;
+  merged.reserve(limit_ - pos_ + readahead_buf_.size());
+  merged.append(buf_.data() + pos_, limit_ - pos_);
+  merged.append(readahead_buf_);
+  buf_.swap(merged);
+  pos_ = 0;
+  limit_ = buf_.size();
+  if (!readahead_status_.ok()) {
+    file_status_ = readahead_status_;
   }
-  return s;
 }
 
 template <typename StringType>
@@ -129,6 +197,9 @@ Status BufferedInputStream::SkipNBytes(int64 bytes_to_skip) {
     return errors::InvalidArgument("Can only skip forward, not ",
                                    bytes_to_skip);
   }
+  if (pos_ + bytes_to_skip >= limit_) {
+    FinishReadahead();
+  }
   if (pos_ + bytes_to_skip < limit_) {
     // If we aren't skipping too much, then we can just move pos_;
     pos_ += bytes_to_skip;
@@ -148,7 +219,9 @@ Status BufferedInputStream::SkipNBytes(int64 bytes_to_skip) {
 }
 
 int64 BufferedInputStream::Tell() const {
-  return input_stream_->Tell() - (limit_ - pos_);
+  const int64 stream_pos =
+      readahead_done_ ? readahead_pos_ : input_stream_->Tell();
+  return stream_pos - (limit_ - pos_);
 }
 
 Status BufferedInputStream::Seek(int64 position) {
@@ -156,6 +229,7 @@ Status BufferedInputStream::Seek(int64 position) {
     return errors::InvalidArgument("Seeking to a negative position: ",
                                    position);
   }
+  FinishReadahead();
 
   // Position of the buffer's lower limit within file.
   const int64 buf_lower_limit = input_stream_->Tell() - limit_;
@@ -199,10 +273,12 @@ template Status BufferedInputStream::ReadAll<string>(string* result);
 template Status BufferedInputStream::ReadAll<tstring>(tstring* result);
 
 Status BufferedInputStream::Reset() {
+  FinishReadahead();
   TF_RETURN_IF_ERROR(input_stream_->Reset());
   pos_ = 0;
   limit_ = 0;
   file_status_ = Status::OK();
+  sequential_fills_ = 0;
   return Status::OK();
 }
 
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_LIB_IO_BUFFERED_INPUTSTREAM_H_
 #define TENSORFLOW_CORE_LIB_IO_BUFFERED_INPUTSTREAM_H_
 
+#include <memory>
+
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
 #include "tensorflow/core/platform/file_system.h"
 
@@ -85,8 +88,25 @@ class BufferedInputStream : public InputStreamInterface {
 
   tensorflow::Status Reset() override;
 
+  // Enables readahead. Once reads are found to be sequential, the next refill
+  // of the buffer is read from the underlying stream on
+  // `RandomAccessFile::AsyncReadThreadPool()` while the buffer is consumed.
+  // The size of refills doubles with every sequential refill, up to
+  // `max_buffer_bytes`, so up to twice `max_buffer_bytes` of memory may be
+  // used. Streams read from that pool, e.g. by another stream's readahead,
+  // don't read ahead.
+  void EnableReadahead(size_t max_buffer_bytes);
+
  private:
   tensorflow::Status FillBuffer();
+
+  // Starts reading the data following the buffer into `readahead_buf_`.
+  void StartReadahead();
+
+  // Waits for the pending readahead, if any, and appends the data read to
+  // the buffer, so that `input_stream_` is again positioned just past the
+  // buffered data.
+  void FinishReadahead();
   template <typename StringType>
   tensorflow::Status ReadLineHelper(StringType* result, bool include_eol);
 
@@ -101,6 +121,18 @@ class BufferedInputStream : public InputStreamInterface {
   // buffer allocations.
   tensorflow::Status file_status_ = Status::OK();
 
+  // Readahead state. `max_size_` is 0 if readahead is disabled.
+  size_t max_size_ = 0;
+  int sequential_fills_ = 0;  // Refills since the last backward seek.
+  // While a readahead is pending, `readahead_done_` is set and the
+  // background thread owns `input_stream_`, `readahead_buf_` and
+  // `readahead_status_`. `readahead_pos_` is the position of `input_stream_`
+  // when the readahead started.
+  std::shared_ptr<Notification> readahead_done_;
+  int64 readahead_pos_ = 0;
+  tstring readahead_buf_;
+  tensorflow::Status readahead_status_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(BufferedInputStream);
 };
 
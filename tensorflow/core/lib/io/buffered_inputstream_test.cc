@@ -291,6 +291,49 @@ TEST(BufferedInputStream, SkipNBytes) {
   }
 }
 
+TEST(BufferedInputStream, Readahead) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  string contents;
+  for (int i = 0; i < 1000; ++i) {
+    contents += static_cast<char>('a' + i % 26);
+  }
+  TF_ASSERT_OK(WriteStringToFile(env, fname, contents));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessInputStream> input_stream(
+        new RandomAccessInputStream(file.get()));
+    BufferedInputStream in(input_stream.get(), buf_size);
+    in.EnableReadahead(4 * buf_size);
+    tstring read;
+    string all;
+    while (all.size() < contents.size()) {
+      TF_ASSERT_OK(in.ReadNBytes(
+          std::min<int64>(7, contents.size() - all.size()), &read));
+      all.append(read.data(), read.size());
+      EXPECT_EQ(all.size(), in.Tell());
+      if (all.size() == 350) {
+        TF_ASSERT_OK(in.SkipNBytes(50));
+        all += contents.substr(350, 50);
+        EXPECT_EQ(400, in.Tell());
+      }
+    }
+    EXPECT_EQ(contents, all);
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+
+    TF_ASSERT_OK(in.Seek(5));
+    TF_ASSERT_OK(in.ReadNBytes(500, &read));
+    EXPECT_EQ(contents.substr(5, 500), read);
+    TF_ASSERT_OK(in.Seek(100));
+    TF_ASSERT_OK(in.ReadNBytes(10, &read));
+    EXPECT_EQ(contents.substr(100, 10), read);
+    EXPECT_EQ(110, in.Tell());
+  }
+}
+
 TEST(BufferedInputStream, ReadNBytesRandomAccessFile) {
   Env* env = Env::Default();
   string fname;
@@ -19,6 +19,7 @@ namespace tensorflow {
 namespace io {
 namespace compression {
 
+const char kBlockSnappy[] = "BLOCK_SNAPPY";
 const char kNone[] = "";
 const char kGzip[] = "GZIP";
 const char kSnappy[] = "SNAPPY";
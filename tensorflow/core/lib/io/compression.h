@@ -20,6 +20,7 @@ namespace tensorflow {
 namespace io {
 namespace compression {
 
+extern const char kBlockSnappy[];
 extern const char kNone[];
 extern const char kGzip[];
 extern const char kSnappy[];
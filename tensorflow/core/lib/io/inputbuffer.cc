@@ -15,12 +15,21 @@ limitations under the License.
 
 #include "tensorflow/core/lib/io/inputbuffer.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace tensorflow {
 namespace io {
 
+namespace {
+
+// Number of consecutive refills after which reads are considered sequential.
+constexpr int kSequentialFillsForReadahead = 2;
+
+}  // namespace
+
 InputBuffer::InputBuffer(RandomAccessFile* file, size_t buffer_bytes)
     : file_(file),
       file_pos_(0),
@@ -29,20 +38,72 @@ InputBuffer::InputBuffer(RandomAccessFile* file, size_t buffer_bytes)
       pos_(buf_),
       limit_(buf_) {}
 
-InputBuffer::~InputBuffer() { delete[] buf_; }
+InputBuffer::~InputBuffer() {
+  if (readahead_done_) {
+    readahead_done_->WaitForNotification();
+  }
+  delete[] readahead_buf_;
+  delete[] buf_;
+}
+
+void InputBuffer::EnableReadahead(size_t max_buffer_bytes) {
+  max_size_ = std::max(max_buffer_bytes, size_);
+}
 
 Status InputBuffer::FillBuffer() {
   StringPiece data;
-  Status s = file_->Read(file_pos_, size_, &data, buf_);
+  Status s;
+  if (!FinishReadahead(&data, &s)) {
+    s = file_->Read(file_pos_, size_, &data, buf_);
+  }
   if (data.data() != buf_) {
     memmove(buf_, data.data(), data.size());
   }
   pos_ = buf_;
   limit_ = pos_ + data.size();
   file_pos_ += data.size();
+  if (max_size_ > 0 && s.ok() &&
+      ++sequential_fills_ >= kSequentialFillsForReadahead) {
+    StartReadahead();
+  }
   return s;
 }
 
+void InputBuffer::StartReadahead() {
+  const size_t window = std::min(2 * size_, max_size_);
+  if (readahead_size_ < window) {
+    delete[] readahead_buf_;
+    readahead_buf_ = new char[window];
+    readahead_size_ = window;
+  }
+  readahead_.resize(1);
+  readahead_[0].offset = file_pos_;
+  readahead_[0].n = window;
+  readahead_[0].scratch = readahead_buf_;
+  readahead_done_ = std::make_shared<Notification>();
+  std::shared_ptr<Notification> done = readahead_done_;
+  file_->ReadAsync(&readahead_, [done]() { done->Notify(); });
+}
+
+bool InputBuffer::FinishReadahead(StringPiece* data, Status* status) {
+  if (!readahead_done_) {
+    return false;
+  }
+  readahead_done_->WaitForNotification();
+  readahead_done_.reset();
+  const RandomAccessFile::ReadRequest request = readahead_[0];
+  readahead_.clear();
+  if (request.offset != file_pos_) {
+    // The buffer was moved by a seek or hint since the readahead started.
+    return false;
+  }
+  std::swap(buf_, readahead_buf_);
+  std::swap(size_, readahead_size_);
+  *data = request.result;
+  *status = request.status;
+  return true;
+}
+
 template <typename T>
 Status InputBuffer::ReadLine(T* result) {
   result->clear();
@@ -193,6 +254,7 @@ Status InputBuffer::Seek(int64 position) {
     // Seeks to somewhere outside.  Discards the buffered data.
     pos_ = limit_ = buf_;
     file_pos_ = position;
+    sequential_fills_ = 0;
   }
   return Status::OK();
 }
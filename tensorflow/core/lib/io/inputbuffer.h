@@ -16,9 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_LIB_IO_INPUTBUFFER_H_
 #define TENSORFLOW_LIB_IO_INPUTBUFFER_H_
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
@@ -84,9 +87,24 @@ class InputBuffer {
   // Returns the underlying RandomAccessFile.
   RandomAccessFile* file() const { return file_; }
 
+  // Enables readahead. Once reads are found to be sequential, the next refill
+  // of the buffer is read in the background with
+  // `RandomAccessFile::ReadAsync()` while the buffer is consumed. The size of
+  // refills doubles with every sequential refill, up to `max_buffer_bytes`,
+  // so up to twice `max_buffer_bytes` of memory may be used.
+  void EnableReadahead(size_t max_buffer_bytes);
+
  private:
   Status FillBuffer();
 
+  // Starts reading the data following the buffer into `readahead_buf_`.
+  void StartReadahead();
+
+  // Waits for the pending readahead, if any. Returns true and makes the data
+  // read the contents of `buf_` if it starts at `file_pos_`, in which case
+  // `*data` and `*status` are set as by `RandomAccessFile::Read()`.
+  bool FinishReadahead(StringPiece* data, Status* status);
+
   // Internal slow-path routine used by ReadVarint32().
   Status ReadVarint32Fallback(uint32* result);
 
@@ -107,6 +125,15 @@ class InputBuffer {
   char* pos_;    // Current position in "buf"
   char* limit_;  // Just past end of valid data in "buf"
 
+  // Readahead state. `max_size_` is 0 if readahead is disabled.
+  size_t max_size_ = 0;
+  int sequential_fills_ = 0;  // Refills since the last seek.
+  char* readahead_buf_ = nullptr;
+  size_t readahead_size_ = 0;  // Size of "readahead_buf_"
+  // Holds the request while a readahead is pending.
+  std::vector<RandomAccessFile::ReadRequest> readahead_;
+  std::shared_ptr<Notification> readahead_done_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(InputBuffer);
 };
 
@@ -299,6 +299,42 @@ TEST(InputBuffer, Seek) {
   }
 }
 
+TEST(InputBuffer, Readahead) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  string contents;
+  for (int i = 0; i < 1000; ++i) {
+    contents += static_cast<char>('a' + i % 26);
+  }
+  TF_ASSERT_OK(WriteStringToFile(env, fname, contents));
+
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessFile> file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &file));
+    io::InputBuffer in(file.get(), buf_size);
+    in.EnableReadahead(4 * buf_size);
+    string read;
+    string all;
+    while (all.size() < contents.size()) {
+      TF_ASSERT_OK(in.ReadNBytes(
+          std::min<int64>(7, contents.size() - all.size()), &read));
+      all += read;
+      EXPECT_EQ(all.size(), in.Tell());
+    }
+    EXPECT_EQ(contents, all);
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+
+    // Seeking restarts the detection of sequential reads.
+    TF_CHECK_OK(in.Seek(5));
+    TF_CHECK_OK(in.ReadNBytes(500, &read));
+    EXPECT_EQ(contents.substr(5, 500), read);
+    TF_CHECK_OK(in.Seek(100));
+    TF_CHECK_OK(in.ReadNBytes(10, &read));
+    EXPECT_EQ(contents.substr(100, 10), read);
+  }
+}
+
 TEST(InputBuffer, ReadVarint32) {
   Env* env = Env::Default();
   string fname;
@@ -0,0 +1,91 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/record_block.h"
+
+#include <memory>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+namespace io {
+
+void AppendToRecordBlock(StringPiece record, string* contents) {
+  core::PutFixed64(contents, record.size());
+  contents->append(record.data(), record.size());
+}
+
+Status EncodeRecordBlock(StringPiece contents, uint32 num_records,
+                         string* block) {
+  string compressed;
+  if (!port::Snappy_Compress(contents.data(), contents.size(), &compressed)) {
+    return errors::Unimplemented(
+        "Block-compressed TFRecord files require Snappy support.");
+  }
+  block->clear();
+  block->reserve(sizeof(uint32) + compressed.size());
+  core::PutFixed32(block, num_records);
+  block->append(compressed);
+  return Status::OK();
+}
+
+Status GetRecordBlockSize(StringPiece block, uint32* num_records) {
+  if (block.size() < sizeof(uint32)) {
+    return errors::DataLoss("Truncated record block.");
+  }
+  *num_records = core::DecodeFixed32(block.data());
+  return Status::OK();
+}
+
+Status DecodeRecordBlock(StringPiece block, std::vector<tstring>* records) {
+  uint32 num_records;
+  TF_RETURN_IF_ERROR(GetRecordBlockSize(block, &num_records));
+  block.remove_prefix(sizeof(uint32));
+  size_t uncompressed_size;
+  if (!port::Snappy_GetUncompressedLength(block.data(), block.size(),
+                                          &uncompressed_size)) {
+    return errors::DataLoss("Failed to read the size of a record block.");
+  }
+  std::unique_ptr<char[]> uncompressed(new char[uncompressed_size]);
+  if (!port::Snappy_Uncompress(block.data(), block.size(),
+                               uncompressed.get())) {
+    return errors::DataLoss("Failed to decompress a record block.");
+  }
+
+  StringPiece data(uncompressed.get(), uncompressed_size);
+  records->reserve(records->size() + num_records);
+  for (uint32 i = 0; i < num_records; ++i) {
+    if (data.size() < sizeof(uint64)) {
+      return errors::DataLoss("Truncated record length in record block.");
+    }
+    const uint64 length = core::DecodeFixed64(data.data());
+    data.remove_prefix(sizeof(uint64));
+    if (data.size() < length) {
+      return errors::DataLoss("Truncated record in record block.");
+    }
+    records->emplace_back(data.data(), length);
+    data.remove_prefix(length);
+  }
+  if (!data.empty()) {
+    return errors::DataLoss("Record block has ", data.size(),
+                            " trailing bytes.");
+  }
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
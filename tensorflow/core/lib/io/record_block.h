@@ -0,0 +1,59 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_RECORD_BLOCK_H_
+#define TENSORFLOW_CORE_LIB_IO_RECORD_BLOCK_H_
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+// Block-compressed TFRecord files group consecutive records into blocks that
+// are compressed independently of each other. Each block is stored as a single
+// record of an otherwise uncompressed TFRecord file, so a file can be split at
+// block boundaries (e.g. using a `RecordIndex` of its blocks) and its blocks
+// can be decompressed by several threads.
+//
+// Format of a block:
+//  uint32    number of records in the block
+//  byte      snappy-compressed concatenation of the records, each of them
+//            prefixed by its uint64 length
+// The records are not checksummed individually since the enclosing TFRecord
+// already carries a crc of the whole block.
+
+// Appends `record` to the uncompressed contents of a block.
+void AppendToRecordBlock(StringPiece record, string* contents);
+
+// Compresses the uncompressed contents of a block holding `num_records`
+// records.
+Status EncodeRecordBlock(StringPiece contents, uint32 num_records,
+                         string* block);
+
+// Returns the number of records in `block` without decompressing it.
+Status GetRecordBlockSize(StringPiece block, uint32* num_records);
+
+// Decompresses `block` and appends its records to `*records`.
+Status DecodeRecordBlock(StringPiece block, std::vector<tstring>* records);
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_RECORD_BLOCK_H_
@@ -0,0 +1,111 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/record_index.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+// Bytes framing each record payload: a length, a masked crc of the length and
+// a masked crc of the payload.
+constexpr uint64 kRecordOverhead = sizeof(uint64) + 2 * sizeof(uint32);
+
+constexpr char kIndexSuffix[] = ".index";
+
+}  // namespace
+
+string RecordIndex::IndexFilename(StringPiece record_filename) {
+  return strings::StrCat(record_filename, kIndexSuffix);
+}
+
+Status RecordIndex::Load(Env* env, const string& index_filename,
+                         RecordIndex* index) {
+  string data;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, index_filename, &data));
+  Status s = index->Decode(data);
+  if (!s.ok()) {
+    return errors::DataLoss("Failed to parse record index ", index_filename,
+                            ": ", s.error_message());
+  }
+  return Status::OK();
+}
+
+void RecordIndex::AppendRecord(uint64 length) {
+  offsets_.push_back(offsets_.back() + length + kRecordOverhead);
+  file_length_ = offsets_.back();
+}
+
+Status RecordIndex::RecordNumber(uint64 offset, uint64* record_number) const {
+  auto it = std::lower_bound(offsets_.begin(), offsets_.end(), offset);
+  if (it == offsets_.end() || *it != offset) {
+    return errors::InvalidArgument("Offset ", offset,
+                                   " is not a record boundary.");
+  }
+  *record_number = it - offsets_.begin();
+  return Status::OK();
+}
+
+void RecordIndex::Encode(string* out) const {
+  out->clear();
+  out->reserve(sizeof(uint64) * (offsets_.size() + 2) + sizeof(uint32));
+  core::PutFixed64(out, num_records());
+  for (uint64 offset : offsets_) {
+    core::PutFixed64(out, offset);
+  }
+  core::PutFixed64(out, file_length_);
+  core::PutFixed32(out, crc32c::Mask(crc32c::Value(out->data(), out->size())));
+}
+
+Status RecordIndex::Decode(StringPiece data) {
+  if (data.size() < 3 * sizeof(uint64) + sizeof(uint32)) {
+    return errors::DataLoss("Record index is truncated.");
+  }
+  const size_t body_size = data.size() - sizeof(uint32);
+  const uint32 masked_crc = core::DecodeFixed32(data.data() + body_size);
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(data.data(), body_size)) {
+    return errors::DataLoss("Corrupted record index.");
+  }
+  const uint64 num_records = core::DecodeFixed64(data.data());
+  // `body_size` is at least 3 * sizeof(uint64), and comparing with it rather
+  // than with a size computed from `num_records` cannot overflow.
+  if (body_size % sizeof(uint64) != 0 ||
+      body_size / sizeof(uint64) - 3 != num_records) {
+    return errors::DataLoss("Record index size does not match its ",
+                            num_records, " records.");
+  }
+  offsets_.resize(num_records + 1);
+  for (uint64 i = 0; i <= num_records; ++i) {
+    offsets_[i] = core::DecodeFixed64(data.data() + sizeof(uint64) * (i + 1));
+  }
+  file_length_ =
+      core::DecodeFixed64(data.data() + sizeof(uint64) * (num_records + 2));
+  if (offsets_.back() > file_length_) {
+    return errors::DataLoss("Record index offsets extend past its file length ",
+                            file_length_, ".");
+  }
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,98 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
+#define TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class Env;
+
+namespace io {
+
+// Maps the record numbers of an uncompressed TFRecord file to the byte offsets
+// of their headers, so that readers can seek to record N without scanning the
+// records before it.
+//
+// The index is stored in a sidecar file next to the TFRecord file (see
+// `IndexFilename()`) with the following format:
+//  uint64    num_records
+//  uint64    offsets[num_records + 1]
+//  uint64    file_length
+//  uint32    masked crc of the above
+// where `offsets[num_records]` is the offset one past the last record, and
+// `file_length` is the length of the TFRecord file when the index was
+// written. Offsets assume that the first record starts at offset 0, so
+// indices of files that were appended to by a writer are invalid.
+//
+// The sidecar can go stale when the TFRecord file is rewritten or appended
+// to, so readers should only use an index whose `file_length()` matches the
+// current size of the file.
+//
+// Note: this class is not thread safe; external synchronization required.
+class RecordIndex {
+ public:
+  // Creates an index for an empty file.
+  RecordIndex() : offsets_({0}), file_length_(0) {}
+
+  // Returns the name of the sidecar index file for `record_filename`.
+  static string IndexFilename(StringPiece record_filename);
+
+  // Reads the index stored in `index_filename`.
+  static Status Load(Env* env, const string& index_filename,
+                     RecordIndex* index);
+
+  // Appends a record with a payload of `length` bytes to the index, extending
+  // the file length to its end.
+  void AppendRecord(uint64 length);
+
+  // Returns the number of indexed records.
+  uint64 num_records() const { return offsets_.size() - 1; }
+
+  // Returns the offset of record `record_number`. Passing `num_records()`
+  // returns the offset one past the last record.
+  uint64 offset(uint64 record_number) const {
+    return offsets_[record_number];
+  }
+
+  // Returns the length of the indexed TFRecord file.
+  uint64 file_length() const { return file_length_; }
+
+  // Looks up the number of the record that starts at `offset`. Returns
+  // `InvalidArgument` if `offset` is not a record boundary.
+  Status RecordNumber(uint64 offset, uint64* record_number) const;
+
+  // Serializes the index into `*out`.
+  void Encode(string* out) const;
+
+  // Parses an index serialized with `Encode()`.
+  Status Decode(StringPiece data);
+
+ private:
+  std::vector<uint64> offsets_;
+  uint64 file_length_;
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
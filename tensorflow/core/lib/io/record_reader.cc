@@ -46,6 +46,9 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordReaderOptions::SNAPPY_COMPRESSION;
+  } else if (compression_type == compression::kBlockSnappy) {
+    options.compression_type =
+        io::RecordReaderOptions::BLOCK_SNAPPY_COMPRESSION;
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -60,8 +63,12 @@ RecordReader::RecordReader(RandomAccessFile* file,
       input_stream_(new RandomAccessInputStream(file)),
       last_read_failed_(false) {
   if (options.buffer_size > 0) {
-    input_stream_.reset(new BufferedInputStream(input_stream_.release(),
-                                                options.buffer_size, true));
+    auto* buffered_stream = new BufferedInputStream(
+        input_stream_.release(), options.buffer_size, true);
+    if (options.max_readahead_bytes > 0) {
+      buffered_stream->EnableReadahead(options.max_readahead_bytes);
+    }
+    input_stream_.reset(buffered_stream);
   }
 #if defined(IS_SLIM_BUILD)
   if (options.compression_type != RecordReaderOptions::NONE) {
@@ -77,7 +84,9 @@ RecordReader::RecordReader(RandomAccessFile* file,
     input_stream_.reset(
         new SnappyInputStream(input_stream_.release(),
                               options.snappy_options.output_buffer_size, true));
-  } else if (options.compression_type == RecordReaderOptions::NONE) {
+  } else if (options.compression_type == RecordReaderOptions::NONE ||
+             options.compression_type ==
+                 RecordReaderOptions::BLOCK_SNAPPY_COMPRESSION) {
     // Nothing to do.
   } else {
     LOG(FATAL) << "Unrecognized compression type :" << options.compression_type;
@@ -85,6 +94,16 @@ RecordReader::RecordReader(RandomAccessFile* file,
 #endif
 }
 
+Status RecordReader::CheckCompressionType() const {
+  if (options_.compression_type ==
+      RecordReaderOptions::BLOCK_SNAPPY_COMPRESSION) {
+    return errors::Unimplemented("TFRecord files with compression type ",
+                                 compression::kBlockSnappy,
+                                 " can only be read with TFRecordDataset.");
+  }
+  return Status::OK();
+}
+
 // Read n+4 bytes from file, verify that checksum of first n bytes is
 // stored in the last 4 bytes and store the first n bytes in *result.
 //
@@ -120,6 +139,8 @@ Status RecordReader::GetMetadata(Metadata* md) {
         "Metadata object call to GetMetadata() was null");
   }
 
+  TF_RETURN_IF_ERROR(CheckCompressionType());
+
   // Compute the metadata of the TFRecord file if not cached.
   if (!cached_metadata_) {
     TF_RETURN_IF_ERROR(input_stream_->Reset());
@@ -183,6 +204,7 @@ Status RecordReader::PositionInputStream(uint64 offset) {
 }
 
 Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
+  TF_RETURN_IF_ERROR(CheckCompressionType());
   TF_RETURN_IF_ERROR(PositionInputStream(*offset));
 
   // Read header data.
@@ -211,6 +233,7 @@ Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
 
 Status RecordReader::SkipRecords(uint64* offset, int num_to_skip,
                                  int* num_skipped) {
+  TF_RETURN_IF_ERROR(CheckCompressionType());
   TF_RETURN_IF_ERROR(PositionInputStream(*offset));
 
   Status s;
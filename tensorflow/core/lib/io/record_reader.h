@@ -38,7 +38,11 @@ struct RecordReaderOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    // Block-compressed files are only readable with TFRecordDataset, which
+    // reads their blocks as uncompressed records. RecordReader returns an
+    // Unimplemented error instead of handing out the raw blocks.
+    BLOCK_SNAPPY_COMPRESSION = 3
   };
   CompressionType compression_type = NONE;
 
@@ -47,6 +51,11 @@ struct RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64 buffer_size = 0;
 
+  // If positive and `buffer_size` is non-zero, the buffer is refilled in the
+  // background once reads are found to be sequential, with refills growing up
+  // to `max_readahead_bytes`. See `BufferedInputStream::EnableReadahead()`.
+  int64 max_readahead_bytes = 0;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -116,6 +125,7 @@ class RecordReader {
   Status GetMetadata(Metadata* md);
 
  private:
+  Status CheckCompressionType() const;
   Status ReadChecksummed(uint64 offset, size_t n, tstring* result);
   Status PositionInputStream(uint64 offset);
 
@@ -13,6 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/io/record_block.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 
@@ -20,9 +23,11 @@ limitations under the License.
 #include <vector>
 #include "tensorflow/core/platform/env.h"
 
+#include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
@@ -305,6 +310,162 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestIndex) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_test";
+  string index_fname = io::RecordIndex::IndexFilename(fname);
+  std::vector<string> records = {"abc", "", "defghij", "klmnopqrstuvwxyz"};
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    std::unique_ptr<WritableFile> index_file;
+    TF_CHECK_OK(env->NewWritableFile(index_fname, &index_file));
+
+    io::RecordWriterOptions options;
+    options.build_index = true;
+    io::RecordWriter writer(file.get(), options);
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+    TF_CHECK_OK(writer.WriteIndex(index_file.get()));
+    TF_CHECK_OK(index_file->Close());
+  }
+
+  io::RecordIndex index;
+  TF_CHECK_OK(io::RecordIndex::Load(env, index_fname, &index));
+  ASSERT_EQ(records.size(), index.num_records());
+  EXPECT_EQ(GetFileSize(fname), index.offset(index.num_records()));
+  EXPECT_EQ(GetFileSize(fname), index.file_length());
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader reader(read_file.get());
+  // Read the records back in reverse order by seeking through the index.
+  for (int i = records.size() - 1; i >= 0; --i) {
+    uint64 offset = index.offset(i);
+    uint64 record_number;
+    TF_CHECK_OK(index.RecordNumber(offset, &record_number));
+    EXPECT_EQ(i, record_number);
+    tstring record;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(records[i], record);
+    EXPECT_EQ(index.offset(i + 1), offset);
+  }
+  uint64 record_number;
+  EXPECT_EQ(index.RecordNumber(1, &record_number).code(),
+            error::INVALID_ARGUMENT);
+}
+
+TEST(RecordReaderWriterTest, TestIndexWithOverflowingRecordCount) {
+  // 8 * (2^61 + 3) wraps around to the 24 bytes that the body actually has.
+  string data;
+  core::PutFixed64(&data, uint64{1} << 61);
+  core::PutFixed64(&data, 0);
+  core::PutFixed64(&data, 0);
+  core::PutFixed32(&data,
+                   crc32c::Mask(crc32c::Value(data.data(), data.size())));
+  io::RecordIndex index;
+  EXPECT_EQ(index.Decode(data).code(), error::DATA_LOSS);
+}
+
+TEST(RecordReaderWriterTest, TestIndexWithOffsetsPastFileLength) {
+  string data;
+  core::PutFixed64(&data, 0);   // num_records
+  core::PutFixed64(&data, 10);  // offsets[0]
+  core::PutFixed64(&data, 5);   // file_length
+  core::PutFixed32(&data,
+                   crc32c::Mask(crc32c::Value(data.data(), data.size())));
+  io::RecordIndex index;
+  EXPECT_EQ(index.Decode(data).code(), error::DATA_LOSS);
+}
+
+TEST(RecordReaderWriterTest, TestIndexRequiresNoCompression) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_zlib_test";
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(env->NewWritableFile(fname, &file));
+  std::unique_ptr<WritableFile> index_file;
+  TF_CHECK_OK(env->NewWritableFile(io::RecordIndex::IndexFilename(fname),
+                                   &index_file));
+
+  io::RecordWriterOptions options;
+  options.compression_type = io::RecordWriterOptions::ZLIB_COMPRESSION;
+  options.build_index = true;
+  io::RecordWriter writer(file.get(), options);
+  TF_EXPECT_OK(writer.WriteRecord("abc"));
+  EXPECT_EQ(writer.WriteIndex(index_file.get()).code(),
+            error::FAILED_PRECONDITION);
+}
+
+TEST(RecordReaderWriterTest, TestBlockSnappy) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_block_test";
+  std::vector<string> records = {"abc", "", "defghij", "klmnopqrstuvwxyz",
+                                 "0123"};
+
+  io::RecordWriterOptions options;
+  options.compression_type =
+      io::RecordWriterOptions::BLOCK_SNAPPY_COMPRESSION;
+  options.block_size = 20;
+  options.build_index = true;
+  io::RecordIndex index;
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get(), options);
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+
+    string index_fname = io::RecordIndex::IndexFilename(fname);
+    std::unique_ptr<WritableFile> index_file;
+    TF_CHECK_OK(env->NewWritableFile(index_fname, &index_file));
+    TF_CHECK_OK(writer.WriteIndex(index_file.get()));
+    TF_CHECK_OK(index_file->Close());
+    TF_CHECK_OK(io::RecordIndex::Load(env, index_fname, &index));
+  }
+
+  // Blocks are the records of an uncompressed file.
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader reader(read_file.get());
+  uint64 offset = 0;
+  uint64 num_blocks = 0;
+  std::vector<tstring> decoded;
+  tstring block;
+  while (reader.ReadRecord(&offset, &block).ok()) {
+    uint32 num_records;
+    TF_CHECK_OK(io::GetRecordBlockSize(block, &num_records));
+    const size_t old_size = decoded.size();
+    TF_CHECK_OK(io::DecodeRecordBlock(block, &decoded));
+    EXPECT_EQ(num_records, decoded.size() - old_size);
+    ++num_blocks;
+  }
+  EXPECT_GT(num_blocks, 1);
+  EXPECT_EQ(num_blocks, index.num_records());
+  ASSERT_EQ(records.size(), decoded.size());
+  for (size_t i = 0; i < records.size(); ++i) {
+    EXPECT_EQ(records[i], decoded[i]);
+  }
+
+  // Reading with the block compression type fails instead of returning the
+  // raw blocks.
+  io::RecordReader block_reader(
+      read_file.get(), io::RecordReaderOptions::CreateRecordReaderOptions(
+                           io::compression::kBlockSnappy));
+  offset = 0;
+  EXPECT_EQ(block_reader.ReadRecord(&offset, &block).code(),
+            error::UNIMPLEMENTED);
+  int num_skipped;
+  EXPECT_EQ(block_reader.SkipRecords(&offset, 1, &num_skipped).code(),
+            error::UNIMPLEMENTED);
+}
+
 TEST(RecordReaderWriterTest, TestUseAfterClose) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_flush_close_test";
@@ -16,8 +16,10 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_writer.h"
 
 #include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/io/record_block.h"
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
@@ -30,6 +32,11 @@ bool IsZlibCompressed(const RecordWriterOptions& options) {
 bool IsSnappyCompressed(const RecordWriterOptions& options) {
   return options.compression_type == RecordWriterOptions::SNAPPY_COMPRESSION;
 }
+
+bool IsBlockCompressed(const RecordWriterOptions& options) {
+  return options.compression_type ==
+         RecordWriterOptions::BLOCK_SNAPPY_COMPRESSION;
+}
 }  // namespace
 
 RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
@@ -49,6 +56,9 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordWriterOptions::SNAPPY_COMPRESSION;
+  } else if (compression_type == compression::kBlockSnappy) {
+    options.compression_type =
+        io::RecordWriterOptions::BLOCK_SNAPPY_COMPRESSION;
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -79,7 +89,8 @@ RecordWriter::RecordWriter(WritableFile* dest,
     dest_ =
         new SnappyOutputBuffer(dest, options.snappy_options.input_buffer_size,
                                options.snappy_options.output_buffer_size);
-  } else if (options.compression_type == RecordWriterOptions::NONE) {
+  } else if (options.compression_type == RecordWriterOptions::NONE ||
+             IsBlockCompressed(options)) {
     // Nothing to do
   } else {
     LOG(FATAL) << "Unspecified compression type :" << options.compression_type;
@@ -101,6 +112,18 @@ Status RecordWriter::WriteRecord(StringPiece data) {
     return Status(::tensorflow::error::FAILED_PRECONDITION,
                   "Writer not initialized or previously closed");
   }
+  if (IsBlockCompressed(options_)) {
+    AppendToRecordBlock(data, &block_);
+    ++block_num_records_;
+    if (static_cast<int64>(block_.size()) >= options_.block_size) {
+      return WriteBlock();
+    }
+    return Status::OK();
+  }
+  return AppendRecord(data);
+}
+
+Status RecordWriter::AppendRecord(StringPiece data) {
   // Format of a single record:
   //  uint64    length
   //  uint32    masked crc of length
@@ -112,7 +135,11 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   PopulateFooter(footer, data.data(), data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  if (options_.build_index) {
+    index_.AppendRecord(data.size());
+  }
+  return Status::OK();
 }
 
 #if defined(TF_CORD_SUPPORT)
@@ -121,6 +148,9 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
     return Status(::tensorflow::error::FAILED_PRECONDITION,
                   "Writer not initialized or previously closed");
   }
+  if (IsBlockCompressed(options_)) {
+    return WriteRecord(StringPiece(std::string(data)));
+  }
   // Format of a single record:
   //  uint64    length
   //  uint32    masked crc of length
@@ -132,12 +162,28 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   PopulateFooter(footer, data);
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  if (options_.build_index) {
+    index_.AppendRecord(data.size());
+  }
+  return Status::OK();
 }
 #endif
 
+Status RecordWriter::WriteBlock() {
+  if (block_num_records_ == 0) {
+    return Status::OK();
+  }
+  string block;
+  TF_RETURN_IF_ERROR(EncodeRecordBlock(block_, block_num_records_, &block));
+  block_.clear();
+  block_num_records_ = 0;
+  return AppendRecord(block);
+}
+
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return Status::OK();
+  TF_RETURN_IF_ERROR(WriteBlock());
   if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
     Status s = dest_->Close();
     delete dest_;
@@ -147,11 +193,28 @@ Status RecordWriter::Close() {
   return Status::OK();
 }
 
+Status RecordWriter::WriteIndex(WritableFile* index_file) {
+  if (!options_.build_index) {
+    return errors::FailedPrecondition(
+        "Writer was not created with `build_index` set.");
+  }
+  if (options_.compression_type != RecordWriterOptions::NONE &&
+      !IsBlockCompressed(options_)) {
+    return errors::FailedPrecondition(
+        "Record indices are only supported for uncompressed and "
+        "block-compressed files.");
+  }
+  string encoded;
+  index_.Encode(&encoded);
+  return index_file->Append(encoded);
+}
+
 Status RecordWriter::Flush() {
   if (dest_ == nullptr) {
     return Status(::tensorflow::error::FAILED_PRECONDITION,
                   "Writer not initialized or previously closed");
   }
+  TF_RETURN_IF_ERROR(WriteBlock());
   return dest_->Flush();
 }
 
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #if !defined(IS_SLIM_BUILD)
 #include "tensorflow/core/lib/io/snappy/snappy_compression_options.h"
 #include "tensorflow/core/lib/io/snappy/snappy_outputbuffer.h"
@@ -41,10 +42,28 @@ struct RecordWriterOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    // Groups records into independently compressed blocks (see
+    // record_block.h) that can be decompressed in parallel. Such files are
+    // read by TFRecordDataset with compression type "BLOCK_SNAPPY", but not
+    // by RecordReader. This is not yet exposed to Python: TFRecordOptions
+    // rejects "BLOCK_SNAPPY", so the files can only be written from C++.
+    BLOCK_SNAPPY_COMPRESSION = 3
   };
   CompressionType compression_type = NONE;
 
+  // Approximate size of the uncompressed contents of each block when using
+  // `BLOCK_SNAPPY_COMPRESSION`.
+  int64 block_size = 1 << 20;
+
+  // If true, the writer records the offset of every record so that a
+  // `RecordIndex` can be written with `RecordWriter::WriteIndex()`. Only
+  // supported for uncompressed files, and for block-compressed files, in which
+  // case the index maps block numbers to block offsets. Offsets are counted
+  // from the writer's first record, so the writer must start at offset 0 of
+  // the file, i.e. not append to an existing file.
+  bool build_index = false;
+
   static RecordWriterOptions CreateRecordWriterOptions(
       const string& compression_type);
 
@@ -94,6 +113,14 @@ class RecordWriter {
   // are invalid.
   Status Close();
 
+  // Writes the index of the records written so far to `index_file`, which is
+  // conventionally named `RecordIndex::IndexFilename()` of the record file.
+  // Requires `build_index` to be set and either no compression or block
+  // compression. The index records the current length of the file, and
+  // readers ignore it once more records are written, so it should be
+  // written after the last record.
+  Status WriteIndex(WritableFile* index_file);
+
   // Utility method to populate TFRecord headers.  Populates record-header in
   // "header[0,kHeaderSize-1]".  The record-header is based on data[0, n-1].
   inline static void PopulateHeader(char* header, const char* data, size_t n);
@@ -109,8 +136,20 @@ class RecordWriter {
 #endif
 
  private:
+  // Appends `data` to `dest_` framed as a single record.
+  Status AppendRecord(StringPiece data);
+
+  // Compresses the pending block, if any, and appends it as a record.
+  Status WriteBlock();
+
   WritableFile* dest_;
   RecordWriterOptions options_;
+  RecordIndex index_;
+
+  // Uncompressed contents and number of records of the pending block when
+  // using `BLOCK_SNAPPY_COMPRESSION`.
+  string block_;
+  uint32 block_num_records_ = 0;
 
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
@@ -256,6 +256,7 @@ REGISTER_OP("ParallelInterleaveDatasetV4")
     .Attr("f: func")
     // "true", "false", or "default".
     .Attr("deterministic: string = 'default'")
+    .Attr("work_stealing: bool = false")
     .Attr("Targuments: list(type) >= 0")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
@@ -511,6 +512,8 @@ REGISTER_OP("ShuffleDatasetV3")
     .Input("seed_generator: resource")
     .Output("handle: variant")
     .Attr("reshuffle_each_iteration: bool = true")
+    .Attr("spill_directory: string = \"\"")
+    .Attr("in_memory_buffer_size: int = 0")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
@@ -590,6 +593,8 @@ REGISTER_OP("CacheDataset")
     .Input("input_dataset: variant")
     .Input("filename: string")
     .Output("handle: variant")
+    .Attr("memory_budget_bytes: int = 0")
+    .Attr("use_mmap: bool = false")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
@@ -604,6 +609,8 @@ REGISTER_OP("CacheDatasetV2")
     .Input("filename: string")
     .Input("cache: resource")
     .Output("handle: variant")
+    .Attr("memory_budget_bytes: int = 0")
+    .Attr("use_mmap: bool = false")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
@@ -683,6 +690,7 @@ REGISTER_OP("TFRecordDataset")
     .Input("compression_type: string")
     .Input("buffer_size: int64")
     .Output("handle: variant")
+    .Attr("max_readahead_bytes: int = 0")
     .SetDoNotOptimize()  // TODO(b/123753214): Source dataset ops must
                          // disable constant folding.
     .SetShapeFn([](shape_inference::InferenceContext* c) {
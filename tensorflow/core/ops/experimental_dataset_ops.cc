@@ -136,6 +136,7 @@ REGISTER_OP("ExperimentalChooseFastestDataset")
 REGISTER_OP("CompressElement")
     .Input("components: input_types")
     .Output("compressed: variant")
+    .Attr("columnar: bool = false")
     .Attr("input_types: list(type) >= 1")
     .SetShapeFn(shape_inference::ScalarShape);
 
@@ -707,6 +708,8 @@ REGISTER_OP("ParseExampleDatasetV2")
                                               // sparse_keys combined) here.
     // "true", "false", or "default".
     .Attr("deterministic: string = 'default'")
+    .Attr("batch_size: int = 0")
+    .Attr("drop_remainder: bool = false")
     .Attr("ragged_keys: list(string) >= 0 = []")
     .Attr("ragged_value_types: list({float,int64,string}) >= 0 = []")
     .Attr("ragged_split_types: list({int32,int64}) >= 0 = []")
@@ -970,6 +973,9 @@ REGISTER_OP("SnapshotDatasetV2")
     .Attr("writer_prefix: string = ''")
     .Attr("hash_valid: bool = false")
     .Attr("hash: int = 0")
+    .Attr("num_parallel_reads: int = 0")
+    .Attr("readahead_elements: int = 16")
+    .Attr("deterministic_reads: bool = true")
     .Attr("reader_func: func")
     .Attr("shard_func: func")
     .Attr("Treader_func_args: list(type) >= 0")
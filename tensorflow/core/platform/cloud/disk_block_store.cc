@@ -0,0 +1,172 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/disk_block_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/str_util.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+
+namespace {
+
+constexpr char kMarkerSuffix[] = ".used";
+constexpr char kTempSuffix[] = ".tmp";
+// The store is trimmed each time this fraction of its capacity has been
+// inserted by the current process.
+constexpr size_t kTrimsPerCapacity = 16;
+// Temporary files older than this were left behind by a process that died
+// while inserting a block.
+constexpr int64 kAbandonedTempFileNanos = 3600LL * 1000 * 1000 * 1000;
+
+}  // namespace
+
+DiskBlockStore::DiskBlockStore(const string& directory, size_t max_bytes,
+                               Env* env)
+    : directory_(directory), max_bytes_(max_bytes), env_(env) {}
+
+string DiskBlockStore::BlockPath(const string& key) const {
+  return io::JoinPath(directory_, key);
+}
+
+string DiskBlockStore::MarkerPath(const string& key) const {
+  return strings::StrCat(BlockPath(key), kMarkerSuffix);
+}
+
+bool DiskBlockStore::Lookup(const string& key, uint64 max_age,
+                            std::vector<char>* data) {
+  const string path = BlockPath(key);
+  FileStatistics stat;
+  if (!env_->Stat(path, &stat).ok()) {
+    return false;
+  }
+  const int64 age_nanos = env_->NowNanos() - stat.mtime_nsec;
+  if (max_age > 0 && age_nanos > static_cast<int64>(max_age) * 1000000000) {
+    return false;
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  if (!env_->NewRandomAccessFile(path, &file).ok()) {
+    return false;
+  }
+  data->resize(stat.length);
+  StringPiece result;
+  Status status = file->Read(0, stat.length, &result, data->data());
+  // The block may have been replaced or evicted by another process since it
+  // was stat-ed, in which case this is treated as a miss.
+  if ((!status.ok() && !errors::IsOutOfRange(status)) ||
+      result.size() != stat.length) {
+    return false;
+  }
+  if (result.data() != data->data()) {
+    memmove(data->data(), result.data(), result.size());
+  }
+  // Refresh the block's position in the LRU order shared by all processes.
+  std::unique_ptr<WritableFile> marker;
+  if (env_->NewWritableFile(MarkerPath(key), &marker).ok()) {
+    marker->Close().IgnoreError();
+  }
+  return true;
+}
+
+Status DiskBlockStore::Insert(const string& key,
+                              const std::vector<char>& data) {
+  const string path = BlockPath(key);
+  const string temp_path =
+      strings::StrCat(path, ".", random::New64(), kTempSuffix);
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env_->NewWritableFile(temp_path, &file));
+  Status status = file->Append(StringPiece(data.data(), data.size()));
+  status.Update(file->Close());
+  if (status.ok()) {
+    status = env_->RenameFile(temp_path, path);
+  }
+  if (!status.ok()) {
+    env_->DeleteFile(temp_path).IgnoreError();
+    return status;
+  }
+  {
+    mutex_lock l(mu_);
+    bytes_since_trim_ += data.size();
+    if (bytes_since_trim_ < max_bytes_ / kTrimsPerCapacity) {
+      return Status::OK();
+    }
+    bytes_since_trim_ = 0;
+  }
+  return Trim();
+}
+
+Status DiskBlockStore::Trim() {
+  std::vector<string> children;
+  TF_RETURN_IF_ERROR(env_->GetChildren(directory_, &children));
+  struct Entry {
+    int64 last_use_nanos = 0;
+    uint64 bytes = 0;
+  };
+  std::map<string, Entry> entries;
+  uint64 total_bytes = 0;
+  const int64 now_nanos = env_->NowNanos();
+  for (const string& child : children) {
+    const string path = io::JoinPath(directory_, child);
+    FileStatistics stat;
+    if (!env_->Stat(path, &stat).ok()) {
+      // The file was removed concurrently by another process.
+      continue;
+    }
+    if (str_util::EndsWith(child, kTempSuffix)) {
+      if (now_nanos - stat.mtime_nsec > kAbandonedTempFileNanos) {
+        env_->DeleteFile(path).IgnoreError();
+      }
+      continue;
+    }
+    StringPiece key(child);
+    const bool is_marker = str_util::ConsumeSuffix(&key, kMarkerSuffix);
+    Entry& entry = entries[string(key)];
+    entry.last_use_nanos = std::max(entry.last_use_nanos, stat.mtime_nsec);
+    if (!is_marker) {
+      entry.bytes = stat.length;
+      total_bytes += stat.length;
+    }
+  }
+  if (total_bytes <= max_bytes_) {
+    return Status::OK();
+  }
+  std::vector<std::pair<int64, string>> lru;
+  lru.reserve(entries.size());
+  for (const auto& entry : entries) {
+    lru.emplace_back(entry.second.last_use_nanos, entry.first);
+  }
+  std::sort(lru.begin(), lru.end());
+  for (const auto& victim : lru) {
+    if (total_bytes <= max_bytes_) {
+      break;
+    }
+    // Another process trimming the same directory may have removed the files
+    // already, so failures to delete are ignored.
+    env_->DeleteFile(BlockPath(victim.second)).IgnoreError();
+    env_->DeleteFile(MarkerPath(victim.second)).IgnoreError();
+    total_bytes -= entries[victim.second].bytes;
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
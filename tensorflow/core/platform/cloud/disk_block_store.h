@@ -0,0 +1,84 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_DISK_BLOCK_STORE_H_
+#define TENSORFLOW_CORE_PLATFORM_CLOUD_DISK_BLOCK_STORE_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+/// \brief A store of file blocks in a directory on local disk.
+///
+/// DiskBlockStore is the second tier behind RamFileBlockCache: blocks that are
+/// not in memory are looked up here before being fetched from the remote
+/// filesystem. Each block is stored in its own file, which is written to a
+/// temporary name and then renamed into place, so several processes on the
+/// same host can safely share one directory.
+///
+/// Eviction is least-recently-used across all of those processes. Every
+/// lookup hit refreshes the modification time of an empty "<key>.used" marker
+/// file next to the block, and Trim() removes the blocks whose marker (or, if
+/// they have never been hit, whose data file) is oldest.
+///
+/// This class is thread safe.
+class DiskBlockStore {
+ public:
+  /// Creates a store in `directory`, which must already exist, holding at most
+  /// `max_bytes` bytes of block data.
+  DiskBlockStore(const string& directory, size_t max_bytes,
+                 Env* env = Env::Default());
+
+  /// Reads the block stored under `key` into `data`. Returns false if there is
+  /// no such block or, if `max_age` is nonzero, if the block was stored more
+  /// than `max_age` seconds ago.
+  bool Lookup(const string& key, uint64 max_age, std::vector<char>* data);
+
+  /// Stores `data` under `key`, replacing any existing block, and trims the
+  /// store once enough new data has been written to it.
+  Status Insert(const string& key, const std::vector<char>& data)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Removes least recently used blocks until the store holds at most
+  /// `max_bytes` bytes.
+  Status Trim();
+
+  /// Accessors for store parameters.
+  const string& directory() const { return directory_; }
+  size_t max_bytes() const { return max_bytes_; }
+
+ private:
+  string BlockPath(const string& key) const;
+  string MarkerPath(const string& key) const;
+
+  const string directory_;
+  const size_t max_bytes_;
+  Env* const env_;  // not owned
+
+  mutex mu_;
+  /// The number of bytes inserted by this process since the last Trim().
+  size_t bytes_since_trim_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_CLOUD_DISK_BLOCK_STORE_H_
@@ -0,0 +1,78 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/disk_block_store.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+string MakeStoreDir(const string& name) {
+  const string dir = io::JoinPath(testing::TmpDir(), name);
+  int64 undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  TF_CHECK_OK(Env::Default()->RecursivelyCreateDir(dir));
+  return dir;
+}
+
+TEST(DiskBlockStoreTest, InsertAndLookup) {
+  DiskBlockStore store(MakeStoreDir("insert_and_lookup"), 1024);
+  std::vector<char> data;
+  EXPECT_FALSE(store.Lookup("a", 0, &data));
+  TF_EXPECT_OK(store.Insert("a", std::vector<char>(16, 'a')));
+  EXPECT_TRUE(store.Lookup("a", 0, &data));
+  EXPECT_EQ(data, std::vector<char>(16, 'a'));
+  // Empty blocks (i.e. reads at the end of a file) are stored too.
+  TF_EXPECT_OK(store.Insert("b", std::vector<char>()));
+  EXPECT_TRUE(store.Lookup("b", 0, &data));
+  EXPECT_TRUE(data.empty());
+}
+
+TEST(DiskBlockStoreTest, SharedBetweenInstances) {
+  // Two stores on the same directory stand in for two processes on one host.
+  const string dir = MakeStoreDir("shared");
+  DiskBlockStore store1(dir, 1024);
+  DiskBlockStore store2(dir, 1024);
+  TF_EXPECT_OK(store1.Insert("a", std::vector<char>(16, 'a')));
+  std::vector<char> data;
+  EXPECT_TRUE(store2.Lookup("a", 0, &data));
+  EXPECT_EQ(data, std::vector<char>(16, 'a'));
+}
+
+TEST(DiskBlockStoreTest, TrimEvictsLeastRecentlyUsed) {
+  DiskBlockStore store(MakeStoreDir("trim"), 32);
+  TF_EXPECT_OK(store.Insert("a", std::vector<char>(16, 'a')));
+  Env::Default()->SleepForMicroseconds(20000);
+  TF_EXPECT_OK(store.Insert("b", std::vector<char>(16, 'b')));
+  Env::Default()->SleepForMicroseconds(20000);
+  // Using "a" makes "b" the least recently used block.
+  std::vector<char> data;
+  EXPECT_TRUE(store.Lookup("a", 0, &data));
+  Env::Default()->SleepForMicroseconds(20000);
+  TF_EXPECT_OK(store.Insert("c", std::vector<char>(16, 'c')));
+  TF_EXPECT_OK(store.Trim());
+  EXPECT_TRUE(store.Lookup("a", 0, &data));
+  EXPECT_FALSE(store.Lookup("b", 0, &data));
+  EXPECT_TRUE(store.Lookup("c", 0, &data));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -34,6 +34,7 @@ limitations under the License.
 #include "json/json.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/cloud/curl_http_request.h"
+#include "tensorflow/core/platform/cloud/disk_block_store.h"
 #include "tensorflow/core/platform/cloud/file_block_cache.h"
 #include "tensorflow/core/platform/cloud/google_auth_provider.h"
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
@@ -798,6 +799,16 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
+
+  // Enable the local disk tier of the block cache if a directory is provided.
+  StringPiece disk_cache_dir;
+  if (GetEnvVar(kDiskCacheDir, StringPieceIdentity, &disk_cache_dir)) {
+    disk_cache_dir_ = string(disk_cache_dir);
+  }
+  disk_cache_max_bytes_ = kDefaultDiskCacheMaxSize * 1024 * 1024;
+  if (GetEnvVar(kDiskCacheMaxSize, strings::safe_strtou64, &value)) {
+    disk_cache_max_bytes_ = value * 1024 * 1024;
+  }
   if (!make_default_cache) {
     max_bytes = 0;
   }
@@ -1030,13 +1041,25 @@ void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
 // A helper function to build a FileBlockCache for GcsFileSystem.
 std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
     size_t block_size, size_t max_bytes, uint64 max_staleness) {
+  std::unique_ptr<DiskBlockStore> disk_tier;
+  if (!disk_cache_dir_.empty() && disk_cache_max_bytes_ > 0 &&
+      block_size > 0 && max_bytes > 0) {
+    Status status = Env::Default()->RecursivelyCreateDir(disk_cache_dir_);
+    if (status.ok()) {
+      disk_tier.reset(
+          new DiskBlockStore(disk_cache_dir_, disk_cache_max_bytes_));
+    } else {
+      LOG(WARNING) << "GCS block cache disk tier disabled: " << status;
+    }
+  }
   std::unique_ptr<FileBlockCache> file_block_cache(new RamFileBlockCache(
       block_size, max_bytes, max_staleness,
       [this](const string& filename, size_t offset, size_t n, char* buffer,
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      std::move(disk_tier)));
   return file_block_cache;
 }
 
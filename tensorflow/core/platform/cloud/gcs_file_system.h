@@ -50,6 +50,14 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that sets a directory on local disk (e.g. an SSD) in
+// which blocks read from GCS are cached as a second tier behind the LRU cache.
+// The directory can be shared by all processes on the host.
+constexpr char kDiskCacheDir[] = "GCS_READ_CACHE_DISK_DIR";
+// The environment variable that overrides the max size of the blocks cached on
+// local disk. Specified in MB.
+constexpr char kDiskCacheMaxSize[] = "GCS_READ_CACHE_DISK_MAX_SIZE_MB";
+constexpr size_t kDefaultDiskCacheMaxSize = 16 * 1024;
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -403,6 +411,11 @@ class GcsFileSystem : public FileSystem {
   // Reads smaller than block_size_ will trigger a read of block_size_.
   uint64 block_size_;
 
+  // The local disk tier of the block cache, which is disabled if
+  // disk_cache_dir_ is empty.
+  string disk_cache_dir_;
+  size_t disk_cache_max_bytes_ = 0;
+
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
@@ -621,7 +621,7 @@ TEST(GcsFileSystemTest, NewRandomAccessFile_WithBlockCache) {
        new FakeHttpRequest(
            "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
            "Auth Token: fake_token\n"
-           "Range: 18-26\n"
+           "Range: 18-35\n"
            "Timeouts: 5 1 20\n",
            "")});
   GcsFileSystem fs(
@@ -668,9 +668,9 @@ TEST(GcsFileSystemTest, NewRandomAccessFile_WithBlockCache) {
     EXPECT_EQ("6789abcde", result);
 
     // The range cannot be satisfied, and the requested offset is past the end
-    // of the cache. A new request will be made to read 9 bytes starting at
-    // offset 18. This request will return an empty response, and there will not
-    // be another request.
+    // of the cache. A single request will be made to read the 2 blocks (18
+    // bytes) starting at offset 18. This request will return an empty response,
+    // and there will not be another request.
     EXPECT_EQ(errors::Code::OUT_OF_RANGE,
               file->Read(20, 10, &result, scratch).code());
     EXPECT_TRUE(result.empty());
@@ -683,6 +683,47 @@ TEST(GcsFileSystemTest, NewRandomAccessFile_WithBlockCache) {
   EXPECT_EQ("0123", result);
 }
 
+TEST(GcsFileSystemTest, NewRandomAccessFile_WithBlockCache_CoalescedRead) {
+  // Our underlying file in this test is a 15 byte file with contents
+  // "0123456789abcde".
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/storage/v1/b/bucket/o/"
+           "random_access.txt?fields=size%2Cgeneration%2Cupdated\n"
+           "Auth Token: fake_token\n"
+           "Timeouts: 5 1 10\n",
+           strings::StrCat("{\"size\": \"15\",\"generation\": \"1\","
+                           "\"updated\": \"2016-04-29T23:15:24.896Z\"}")),
+       new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 0-17\n"
+           "Timeouts: 5 1 20\n",
+           "0123456789abcde")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 9 /* block size */,
+      18 /* max bytes */, 0 /* max staleness */, 3600 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+
+  char scratch[100];
+  StringPiece result;
+  std::unique_ptr<RandomAccessFile> file;
+  TF_EXPECT_OK(
+      fs.NewRandomAccessFile("gs://bucket/random_access.txt", nullptr, &file));
+  // Both blocks of the file miss the cache, and are fetched with one request.
+  TF_EXPECT_OK(file->Read(0, 15, &result, scratch));
+  EXPECT_EQ("0123456789abcde", result);
+  // Both blocks are now cached, so no further requests are made.
+  TF_EXPECT_OK(file->Read(7, 4, &result, scratch));
+  EXPECT_EQ("789a", result);
+}
+
 TEST(GcsFileSystemTest, NewRandomAccessFile_WithBlockCache_Flush) {
   // Our underlying file in this test is a 15 byte file with contents
   // "0123456789abcde".
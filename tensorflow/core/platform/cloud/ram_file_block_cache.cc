@@ -14,10 +14,12 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
+#include <algorithm>
 #include <cstring>
 #include <memory>
-#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/strcat.h"
 
 namespace tensorflow {
 
@@ -98,58 +100,14 @@ Status RamFileBlockCache::UpdateLRU(const Key& key,
 
 Status RamFileBlockCache::MaybeFetch(const Key& key,
                                      const std::shared_ptr<Block>& block) {
-  bool downloaded_block = false;
-  auto reconcile_state =
-      gtl::MakeCleanup([this, &downloaded_block, &key, &block] {
-        // Perform this action in a cleanup callback to avoid locking mu_ after
-        // locking block->mu.
-        if (downloaded_block) {
-          mutex_lock l(mu_);
-          // Do not update state if the block is already to be evicted.
-          if (block->timestamp != 0) {
-            // Use capacity() instead of size() to account for all  memory
-            // used by the cache.
-            cache_size_ += block->data.capacity();
-            // Put to beginning of LRA list.
-            lra_list_.erase(block->lra_iterator);
-            lra_list_.push_front(key);
-            block->lra_iterator = lra_list_.begin();
-            block->timestamp = env_->NowSeconds();
-          }
-        }
-      });
   // Loop until either block content is successfully fetched, or our request
   // encounters an error.
-  mutex_lock l(block->mu);
-  Status status = Status::OK();
   while (true) {
+    if (ClaimBlock(block)) {
+      return FetchBlocks(key.first, {std::make_pair(key, block)});
+    }
+    mutex_lock l(block->mu);
     switch (block->state) {
-      case FetchState::ERROR:
-        TF_FALLTHROUGH_INTENDED;
-      case FetchState::CREATED:
-        block->state = FetchState::FETCHING;
-        block->mu.unlock();  // Release the lock while making the API call.
-        block->data.clear();
-        block->data.resize(block_size_, 0);
-        size_t bytes_transferred;
-        status.Update(block_fetcher_(key.first, key.second, block_size_,
-                                     block->data.data(), &bytes_transferred));
-        if (cache_stats_ != nullptr) {
-          cache_stats_->RecordCacheMissBlockSize(bytes_transferred);
-        }
-        block->mu.lock();  // Reacquire the lock immediately afterwards
-        if (status.ok()) {
-          block->data.resize(bytes_transferred, 0);
-          // Shrink the data capacity to the actual size used.
-          // NOLINTNEXTLINE: shrink_to_fit() may not shrink the capacity.
-          std::vector<char>(block->data).swap(block->data);
-          downloaded_block = true;
-          block->state = FetchState::FINISHED;
-        } else {
-          block->state = FetchState::ERROR;
-        }
-        block->cond_var.notify_all();
-        return status;
       case FetchState::FETCHING:
         block->cond_var.wait_for(l, std::chrono::seconds(60));
         if (block->state == FetchState::FINISHED) {
@@ -159,12 +117,189 @@ Status RamFileBlockCache::MaybeFetch(const Key& key,
         break;
       case FetchState::FINISHED:
         return Status::OK();
+      default:
+        // The fetch failed in the meantime; try to claim the block again.
+        break;
     }
   }
   return errors::Internal(
       "Control flow should never reach the end of RamFileBlockCache::Fetch.");
 }
 
+bool RamFileBlockCache::ClaimBlock(const std::shared_ptr<Block>& block) {
+  mutex_lock l(block->mu);
+  if (block->state == FetchState::CREATED ||
+      block->state == FetchState::ERROR) {
+    block->state = FetchState::FETCHING;
+    return true;
+  }
+  return false;
+}
+
+bool RamFileBlockCache::IsLastBlock(const std::shared_ptr<Block>& block) {
+  mutex_lock l(block->mu);
+  return block->state == FetchState::FINISHED &&
+         block->data.size() < block_size_;
+}
+
+Status RamFileBlockCache::FetchBlocks(const string& filename,
+                                      const std::vector<BlockRef>& blocks) {
+  std::vector<std::vector<char>> data(blocks.size());
+  std::vector<Status> statuses(blocks.size());
+  std::vector<string> disk_keys(blocks.size());
+  std::vector<bool> from_disk(blocks.size(), false);
+  if (disk_tier_) {
+    for (size_t i = 0; i < blocks.size(); ++i) {
+      disk_keys[i] = DiskTierKey(blocks[i].first);
+      from_disk[i] = !disk_keys[i].empty() &&
+                     disk_tier_->Lookup(disk_keys[i], max_staleness_, &data[i]);
+      if (from_disk[i] && cache_stats_ != nullptr) {
+        cache_stats_->RecordCacheHitBlockSize(data[i].size());
+      }
+    }
+  }
+  // Fetch each run of adjacent blocks that missed the disk tier with a single
+  // read of the underlying filesystem.
+  Status status;
+  size_t begin = 0;
+  while (begin < blocks.size()) {
+    if (from_disk[begin]) {
+      ++begin;
+      continue;
+    }
+    size_t end = begin + 1;
+    while (end < blocks.size() && !from_disk[end] &&
+           blocks[end].first.second ==
+               blocks[end - 1].first.second + block_size_) {
+      ++end;
+    }
+    const size_t run_size = (end - begin) * block_size_;
+    // A single block is read directly into its own buffer, while longer runs
+    // are read into a shared buffer and then split into blocks.
+    std::vector<char> run_buffer;
+    std::vector<char>& buffer = end - begin == 1 ? data[begin] : run_buffer;
+    buffer.resize(run_size, 0);
+    size_t bytes_transferred = 0;
+    Status run_status =
+        block_fetcher_(filename, blocks[begin].first.second, run_size,
+                       buffer.data(), &bytes_transferred);
+    if (cache_stats_ != nullptr) {
+      cache_stats_->RecordCacheMissBlockSize(bytes_transferred);
+    }
+    for (size_t i = begin; i < end; ++i) {
+      statuses[i] = run_status;
+      if (!run_status.ok() || &buffer == &data[i]) continue;
+      const size_t block_begin = (i - begin) * block_size_;
+      if (block_begin < bytes_transferred) {
+        const size_t block_end =
+            std::min(block_begin + block_size_, bytes_transferred);
+        data[i].assign(buffer.begin() + block_begin,
+                       buffer.begin() + block_end);
+      }
+    }
+    if (run_status.ok() && &buffer == &data[begin]) {
+      buffer.resize(std::min(bytes_transferred, run_size));
+    }
+    status.Update(run_status);
+    begin = end;
+  }
+  // Publish the blocks in order of offset. Blocks after a partial block lie
+  // past the end of the file, and are dropped rather than cached so that the
+  // partial block is not reported as inconsistent.
+  bool end_of_file = false;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    const Key& key = blocks[i].first;
+    const std::shared_ptr<Block>& block = blocks[i].second;
+    if (!statuses[i].ok()) {
+      FinishFetch(key, block, statuses[i], &data[i]);
+    } else if (end_of_file) {
+      DropBlock(key, block);
+    } else {
+      end_of_file = data[i].size() < block_size_;
+      if (!from_disk[i] && !disk_keys[i].empty()) {
+        Status disk_status = disk_tier_->Insert(disk_keys[i], data[i]);
+        if (!disk_status.ok()) {
+          LOG(WARNING) << "Failed to store block of " << filename << " @ "
+                       << key.second << " in " << disk_tier_->directory()
+                       << ": " << disk_status;
+        }
+      }
+      FinishFetch(key, block, statuses[i], &data[i]);
+    }
+  }
+  return status;
+}
+
+void RamFileBlockCache::FinishFetch(const Key& key,
+                                    const std::shared_ptr<Block>& block,
+                                    const Status& status,
+                                    std::vector<char>* data) {
+  {
+    mutex_lock l(block->mu);
+    if (status.ok()) {
+      block->data.swap(*data);
+      if (block->data.capacity() > block->data.size()) {
+        // Shrink the data capacity to the actual size used.
+        // NOLINTNEXTLINE: shrink_to_fit() may not shrink the capacity.
+        std::vector<char>(block->data).swap(block->data);
+      }
+      block->state = FetchState::FINISHED;
+    } else {
+      block->state = FetchState::ERROR;
+    }
+    block->cond_var.notify_all();
+  }
+  // Only lock mu_ after releasing block->mu, to avoid deadlocks.
+  if (status.ok()) {
+    mutex_lock l(mu_);
+    // Do not update state if the block is already to be evicted.
+    if (block->timestamp != 0) {
+      // Use capacity() instead of size() to account for all  memory
+      // used by the cache.
+      cache_size_ += block->data.capacity();
+      // Put to beginning of LRA list.
+      lra_list_.erase(block->lra_iterator);
+      lra_list_.push_front(key);
+      block->lra_iterator = lra_list_.begin();
+      block->timestamp = env_->NowSeconds();
+    }
+  }
+}
+
+void RamFileBlockCache::DropBlock(const Key& key,
+                                  const std::shared_ptr<Block>& block) {
+  {
+    mutex_lock l(block->mu);
+    std::vector<char>().swap(block->data);
+    block->state = FetchState::FINISHED;
+    block->cond_var.notify_all();
+  }
+  mutex_lock l(mu_);
+  if (block->timestamp != 0) {
+    auto entry = block_map_.find(key);
+    if (entry != block_map_.end() && entry->second == block) {
+      RemoveBlock(entry);
+    }
+  }
+}
+
+string RamFileBlockCache::DiskTierKey(const Key& key) {
+  int64 file_signature;
+  {
+    mutex_lock lock(mu_);
+    auto it = file_signature_map_.find(key.first);
+    if (it == file_signature_map_.end()) {
+      return "";
+    }
+    file_signature = it->second;
+  }
+  const Fprint128 fingerprint = Fingerprint128(key.first);
+  return strings::StrCat(strings::Hex(fingerprint.high64, strings::kZeroPad16),
+                         strings::Hex(fingerprint.low64, strings::kZeroPad16),
+                         "_", file_signature, "_", block_size_, "_",
+                         key.second);
+}
+
 Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
                                char* buffer, size_t* bytes_transferred) {
   *bytes_transferred = 0;
@@ -182,14 +317,32 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   if (finish < offset + n) {
     finish += block_size_;
   }
-  size_t total_bytes_transferred = 0;
-  // Now iterate through the blocks, reading them one at a time.
+  // Look up all of the blocks up front (stopping at a cached last block of
+  // the file), so that the ones that need fetching can be fetched together.
+  std::vector<BlockRef> blocks;
+  std::vector<BlockRef> claimed_blocks;
   for (size_t pos = start; pos < finish; pos += block_size_) {
     Key key = std::make_pair(filename, pos);
-    // Look up the block, fetching and inserting it if necessary, and update the
-    // LRU iterator for the key and block.
     std::shared_ptr<Block> block = Lookup(key);
     DCHECK(block) << "No block for key " << key.first << "@" << key.second;
+    blocks.emplace_back(key, block);
+    if (ClaimBlock(block)) {
+      claimed_blocks.emplace_back(key, block);
+    } else if (IsLastBlock(block)) {
+      break;
+    }
+  }
+  if (!claimed_blocks.empty()) {
+    TF_RETURN_IF_ERROR(FetchBlocks(filename, claimed_blocks));
+  }
+  size_t total_bytes_transferred = 0;
+  // Now iterate through the blocks, copying them one at a time.
+  for (const BlockRef& block_ref : blocks) {
+    const Key& key = block_ref.first;
+    const size_t pos = key.second;
+    const std::shared_ptr<Block>& block = block_ref.second;
+    // Wait for blocks fetched by other threads (fetching them again if those
+    // fetches failed), and update the LRU iterator for the key and block.
     TF_RETURN_IF_ERROR(MaybeFetch(key, block));
     TF_RETURN_IF_ERROR(UpdateLRU(key, block));
     // Copy the relevant portion of the block into the result buffer.
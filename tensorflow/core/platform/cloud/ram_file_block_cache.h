@@ -23,6 +23,7 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "tensorflow/core/platform/cloud/disk_block_store.h"
 #include "tensorflow/core/platform/cloud/file_block_cache.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -37,7 +38,14 @@ namespace tensorflow {
 /// \brief An LRU block cache of file contents, keyed by {filename, offset}.
 ///
 /// This class should be shared by read-only random access files on a remote
-/// filesystem (e.g. GCS).
+/// filesystem (e.g. GCS). Adjacent blocks that miss the cache within a single
+/// read are fetched from the remote filesystem with a single ranged read.
+///
+/// An optional DiskBlockStore can back the cache with a second tier on local
+/// disk, which is shared by all processes on the host that use the same
+/// directory. Only blocks of files with a known signature (see
+/// ValidateAndUpdateFileSignature) are stored there, so that the tier never
+/// serves contents of a file that has since been overwritten.
 class RamFileBlockCache : public FileBlockCache {
  public:
   /// The callback executed when a block is not found in the cache, and needs to
@@ -52,10 +60,21 @@ class RamFileBlockCache : public FileBlockCache {
 
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
                     BlockFetcher block_fetcher, Env* env = Env::Default())
+      : RamFileBlockCache(block_size, max_bytes, max_staleness,
+                          std::move(block_fetcher),
+                          std::unique_ptr<DiskBlockStore>(), env) {}
+
+  /// Creates a cache whose blocks are also looked up in and written to
+  /// `disk_tier`, if it is non-null.
+  RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
+                    BlockFetcher block_fetcher,
+                    std::unique_ptr<DiskBlockStore> disk_tier,
+                    Env* env = Env::Default())
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
+        disk_tier_(std::move(disk_tier)),
         env_(env) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
@@ -129,6 +148,8 @@ class RamFileBlockCache : public FileBlockCache {
   const uint64 max_staleness_;
   /// The callback to read a block from the underlying filesystem.
   const BlockFetcher block_fetcher_;
+  /// The local disk tier, or null if blocks are only cached in memory.
+  const std::unique_ptr<DiskBlockStore> disk_tier_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
 
@@ -188,6 +209,9 @@ class RamFileBlockCache : public FileBlockCache {
   /// The block map is an ordered map from Key to Block.
   typedef std::map<Key, std::shared_ptr<Block>> BlockMap;
 
+  /// A block together with its key.
+  typedef std::pair<Key, std::shared_ptr<Block>> BlockRef;
+
   /// Prune the cache by removing files with expired blocks.
   void Prune() TF_LOCKS_EXCLUDED(mu_);
 
@@ -200,6 +224,36 @@ class RamFileBlockCache : public FileBlockCache {
   Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
       TF_LOCKS_EXCLUDED(mu_);
 
+  /// Transitions `block` to FETCHING and returns true if it needs to be
+  /// fetched and no other thread is fetching it.
+  bool ClaimBlock(const std::shared_ptr<Block>& block);
+
+  /// Returns true if `block` has been fetched and ends before a full block,
+  /// i.e. it is the last block of its file.
+  bool IsLastBlock(const std::shared_ptr<Block>& block);
+
+  /// Fetches `blocks` of `filename`, which must have been claimed by the
+  /// calling thread and be sorted by offset. Blocks are read from the disk
+  /// tier where possible, and each run of adjacent remaining blocks is fetched
+  /// with a single call to the block fetcher.
+  Status FetchBlocks(const string& filename,
+                     const std::vector<BlockRef>& blocks)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Publishes the result of fetching `block`, waking up any waiting readers.
+  void FinishFetch(const Key& key, const std::shared_ptr<Block>& block,
+                   const Status& status, std::vector<char>* data)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Publishes `block` as empty and removes it from the cache, since it lies
+  /// past the end of its file.
+  void DropBlock(const Key& key, const std::shared_ptr<Block>& block)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Returns the name of the block at `key` in the disk tier, or an empty
+  /// string if the block must not be stored there.
+  string DiskTierKey(const Key& key) TF_LOCKS_EXCLUDED(mu_);
+
   /// Trim the block cache to make room for another entry.
   void Trim() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cloud/now_seconds_env.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -566,5 +567,87 @@ TEST(RamFileBlockCacheTest, Flush) {
   EXPECT_EQ(calls, 2);
 }
 
+TEST(RamFileBlockCacheTest, CoalesceAdjacentMisses) {
+  // Tests reads of a 40-byte file with block size 16.
+  const size_t block_size = 16;
+  const size_t file_size = 40;
+  std::vector<std::pair<size_t, size_t>> calls;
+  auto fetcher = [&calls, file_size](const string& filename, size_t offset,
+                                     size_t n, char* buffer,
+                                     size_t* bytes_transferred) {
+    calls.emplace_back(offset, n);
+    size_t bytes_to_copy =
+        offset < file_size ? std::min(n, file_size - offset) : 0;
+    memset(buffer, 'x', bytes_to_copy);
+    *bytes_transferred = bytes_to_copy;
+    return Status::OK();
+  };
+  RamFileBlockCache cache(block_size, 4 * block_size, 0, fetcher);
+  std::vector<char> out;
+  // The first two blocks are fetched with a single read.
+  TF_EXPECT_OK(ReadCache(&cache, "", 0, 2 * block_size, &out));
+  EXPECT_EQ(out.size(), 2 * block_size);
+  ASSERT_EQ(calls.size(), 1);
+  EXPECT_EQ(calls[0], std::make_pair(size_t{0}, 2 * block_size));
+  // Only the missing blocks are fetched. The read extends past the end of the
+  // file, and the block after the (partial) last block is not cached.
+  TF_EXPECT_OK(ReadCache(&cache, "", block_size, 3 * block_size, &out));
+  EXPECT_EQ(out.size(), file_size - block_size);
+  ASSERT_EQ(calls.size(), 2);
+  EXPECT_EQ(calls[1], std::make_pair(2 * block_size, 2 * block_size));
+  EXPECT_EQ(cache.CacheSize(), file_size);
+  // The last block is a cache hit, and is not reported as inconsistent.
+  TF_EXPECT_OK(ReadCache(&cache, "", 2 * block_size, block_size, &out));
+  EXPECT_EQ(out.size(), file_size - 2 * block_size);
+  EXPECT_EQ(calls.size(), 2);
+}
+
+TEST(RamFileBlockCacheTest, DiskTier) {
+  const string dir = io::JoinPath(testing::TmpDir(), "ram_file_block_cache");
+  int64 undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(dir));
+  int calls = 0;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    calls++;
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return Status::OK();
+  };
+  auto make_cache = [&fetcher, &dir]() {
+    return std::unique_ptr<RamFileBlockCache>(new RamFileBlockCache(
+        16, 32, 0, fetcher,
+        std::unique_ptr<DiskBlockStore>(new DiskBlockStore(dir, 1024))));
+  };
+  std::unique_ptr<RamFileBlockCache> cache = make_cache();
+  std::vector<char> out;
+  EXPECT_TRUE(cache->ValidateAndUpdateFileSignature("a", 1));
+  TF_EXPECT_OK(ReadCache(cache.get(), "a", 0, 16, &out));
+  EXPECT_EQ(calls, 1);
+  // Once the block has left memory, it is read back from disk.
+  cache->Flush();
+  TF_EXPECT_OK(ReadCache(cache.get(), "a", 0, 16, &out));
+  EXPECT_EQ(out, std::vector<char>(16, 'x'));
+  EXPECT_EQ(calls, 1);
+  // Another cache on the same directory (e.g. in another process) shares it.
+  std::unique_ptr<RamFileBlockCache> other_cache = make_cache();
+  EXPECT_TRUE(other_cache->ValidateAndUpdateFileSignature("a", 1));
+  TF_EXPECT_OK(ReadCache(other_cache.get(), "a", 0, 16, &out));
+  EXPECT_EQ(calls, 1);
+  // Blocks of an overwritten file are not served from disk.
+  EXPECT_FALSE(other_cache->ValidateAndUpdateFileSignature("a", 2));
+  TF_EXPECT_OK(ReadCache(other_cache.get(), "a", 0, 16, &out));
+  EXPECT_EQ(calls, 2);
+  // Blocks of files with an unknown signature are only cached in memory.
+  TF_EXPECT_OK(ReadCache(cache.get(), "b", 0, 16, &out));
+  EXPECT_EQ(calls, 3);
+  cache->Flush();
+  TF_EXPECT_OK(ReadCache(cache.get(), "b", 0, 16, &out));
+  EXPECT_EQ(calls, 4);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -582,6 +582,7 @@ def tf_additional_lib_hdrs():
         ],
         "//conditions:default": [
             "//tensorflow/core/platform/default:posix_file_system.h",
+            "//tensorflow/core/platform/default:posix_io_uring.h",
             "//tensorflow/core/platform/default:subprocess.h",
         ],
     })
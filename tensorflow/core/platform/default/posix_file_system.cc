@@ -30,6 +30,7 @@ limitations under the License.
 #include <unistd.h>
 
 #include "tensorflow/core/platform/default/posix_file_system.h"
+#include "tensorflow/core/platform/default/posix_io_uring.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/error.h"
 #include "tensorflow/core/platform/errors.h"
@@ -95,6 +96,16 @@ class PosixRandomAccessFile : public RandomAccessFile {
     return s;
   }
 
+  void ReadAsync(std::vector<ReadRequest>* requests,
+                 std::function<void()> done) const override {
+    PosixIoUring* io_uring = PosixIoUring::Get();
+    if (io_uring == nullptr) {
+      RandomAccessFile::ReadAsync(requests, std::move(done));
+      return;
+    }
+    io_uring->Read(fd_, filename_, requests, std::move(done));
+  }
+
 #if defined(TF_CORD_SUPPORT)
   Status Read(uint64 offset, size_t n, absl::Cord* cord) const override {
     if (n == 0) {
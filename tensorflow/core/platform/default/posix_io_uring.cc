@@ -0,0 +1,386 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/default/posix_io_uring.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define TF_POSIX_HAS_IO_URING 1
+#endif
+#endif
+
+#if defined(TF_POSIX_HAS_IO_URING)
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <utility>
+#endif
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/error.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+#if defined(TF_POSIX_HAS_IO_URING)
+// The C library headers may predate io_uring.
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#endif
+
+namespace tensorflow {
+
+#if defined(TF_POSIX_HAS_IO_URING)
+namespace {
+
+// Number of submission queue entries requested from the kernel.
+constexpr unsigned kNumEntries = 256;
+
+// Some kernels fail reads of more than fits in a 32-bit integer, so larger
+// reads are split into several operations.
+constexpr size_t kMaxReadLength = INT32_MAX;
+
+// How long to wait before submitting again when the kernel is out of
+// resources for new reads and none are in flight.
+constexpr int64 kSubmitBackoffMicros = 1000;
+
+class IoUring : public PosixIoUring {
+ public:
+  // Sets up a ring and its completion thread, or returns nullptr if the
+  // kernel does not support io_uring.
+  static IoUring* Create() {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    const int fd = syscall(__NR_io_uring_setup, kNumEntries, &params);
+    if (fd < 0) {
+      VLOG(1) << "io_uring is not available: " << strerror(errno);
+      return nullptr;
+    }
+    std::unique_ptr<IoUring> ring(new IoUring(fd));
+    Status s = ring->Init(params);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to set up io_uring: " << s;
+      return nullptr;
+    }
+    IoUring* r = ring.get();
+    ring->completion_thread_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "tf_io_uring", [r]() { r->CompletionLoop(); }));
+    return ring.release();
+  }
+
+  ~IoUring() override {
+    if (sqes_ != nullptr) munmap(sqes_, sqes_size_);
+    if (cq_ring_ != nullptr) munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_ != nullptr) munmap(sq_ring_, sq_ring_size_);
+    close(ring_fd_);
+  }
+
+  void Read(int fd, const std::string& filename,
+            std::vector<RandomAccessFile::ReadRequest>* requests,
+            std::function<void()> done) override {
+    Batch* batch = new Batch{fd, filename, std::move(done), 0};
+    std::vector<Operation*> operations;
+    operations.reserve(requests->size());
+    for (RandomAccessFile::ReadRequest& request : *requests) {
+      request.status = Status::OK();
+      request.result = StringPiece(request.scratch, 0);
+      if (request.n > 0) {
+        operations.push_back(new Operation{batch, &request});
+      }
+    }
+    if (operations.empty()) {
+      batch->done();
+      delete batch;
+      return;
+    }
+    batch->pending = operations.size();
+    std::vector<Batch*> finished;
+    {
+      mutex_lock l(mu_);
+      queued_.insert(queued_.end(), operations.begin(), operations.end());
+      if (!SubmitLocked(&finished)) {
+        SubmitWithBackoffLocked(&finished);
+      }
+    }
+    RunDone(&finished);
+  }
+
+ private:
+  // A batch of reads passed to `Read()`.
+  struct Batch {
+    int fd;
+    std::string filename;
+    std::function<void()> done;
+    // Number of reads of the batch that have not completed.
+    size_t pending;
+  };
+
+  // A read of a batch. Its address is the user data of the submission queue
+  // entries issued for it.
+  struct Operation {
+    Batch* batch;
+    RandomAccessFile::ReadRequest* request;
+    size_t bytes_read = 0;
+    struct iovec iov;
+  };
+
+  explicit IoUring(int ring_fd) : ring_fd_(ring_fd) {}
+
+  // Maps the rings shared with the kernel.
+  Status Init(const io_uring_params& params) {
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    sq_ring_ = Map(sq_ring_size_, IORING_OFF_SQ_RING);
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    cq_ring_ = Map(cq_ring_size_, IORING_OFF_CQ_RING);
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe*>(Map(sqes_size_, IORING_OFF_SQES));
+    if (sq_ring_ == nullptr || cq_ring_ == nullptr || sqes_ == nullptr) {
+      return IOError("mmap io_uring", errno);
+    }
+    char* sq_ring = static_cast<char*>(sq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq_ring + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.array);
+    char* cq_ring = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq_ring + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq_ring + params.cq_off.cqes);
+    // Bounding the reads in flight by the size of the submission queue
+    // ensures that neither queue can overflow.
+    max_in_flight_ = std::min(params.sq_entries, params.cq_entries);
+    return Status::OK();
+  }
+
+  void* Map(size_t size, off_t offset) {
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  }
+
+  // Moves as many queued operations as possible to the submission queue and
+  // submits them to the kernel. Batches that fail because their reads could
+  // not be submitted are added to `finished`.
+  //
+  // If the kernel is out of resources, the entries are left in the
+  // submission queue. They are submitted again once the completion thread
+  // has reaped the reads in flight. Returns false if no reads are in flight,
+  // in which case the caller must back off and submit again.
+  bool SubmitLocked(std::vector<Batch*>* finished)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    unsigned tail = *sq_tail_;
+    while (!queued_.empty() && in_flight_ < max_in_flight_) {
+      Operation* op = queued_.front();
+      queued_.pop_front();
+      RandomAccessFile::ReadRequest* request = op->request;
+      op->iov.iov_base = request->scratch + op->bytes_read;
+      op->iov.iov_len =
+          std::min(request->n - op->bytes_read, kMaxReadLength);
+      const unsigned index = tail & sq_mask_;
+      io_uring_sqe* sqe = &sqes_[index];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = IORING_OP_READV;
+      sqe->fd = op->batch->fd;
+      sqe->off = request->offset + op->bytes_read;
+      sqe->addr = reinterpret_cast<uintptr_t>(&op->iov);
+      sqe->len = 1;
+      sqe->user_data = reinterpret_cast<uintptr_t>(op);
+      sq_array_[index] = index;
+      ++tail;
+      ++unsubmitted_;
+      ++in_flight_;
+    }
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+    while (unsubmitted_ > 0) {
+      const int ret =
+          syscall(__NR_io_uring_enter, ring_fd_, unsubmitted_, 0, 0, nullptr,
+                  0);
+      if (ret >= 0) {
+        unsubmitted_ -= ret;
+      } else if (errno == EAGAIN || errno == EBUSY) {
+        return in_flight_ > unsubmitted_;
+      } else if (errno != EINTR) {
+        const int error = errno;
+        LOG(ERROR) << "io_uring_enter() failed: " << strerror(error);
+        FailUnsubmittedLocked(error, finished);
+      }
+    }
+    return true;
+  }
+
+  // Calls `SubmitLocked()` until it succeeds, releasing `mu_` while backing
+  // off.
+  void SubmitWithBackoffLocked(std::vector<Batch*>* finished)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    do {
+      mu_.unlock();
+      Env::Default()->SleepForMicroseconds(kSubmitBackoffMicros);
+      mu_.lock();
+    } while (!SubmitLocked(finished));
+  }
+
+  // Removes the entries that the kernel has not consumed from the submission
+  // queue, and fails their reads with `error`. Only this thread writes the
+  // tail and the kernel only reads entries during io_uring_enter(), so the
+  // entries can be taken back.
+  void FailUnsubmittedLocked(int error, std::vector<Batch*>* finished)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    unsigned tail = *sq_tail_;
+    for (; unsubmitted_ > 0; --unsubmitted_) {
+      --tail;
+      const io_uring_sqe& sqe = sqes_[sq_array_[tail & sq_mask_]];
+      Operation* op = reinterpret_cast<Operation*>(sqe.user_data);
+      Batch* batch = op->batch;
+      --in_flight_;
+      CompleteLocked(op, -error);
+      if (--batch->pending == 0) {
+        finished->push_back(batch);
+      }
+    }
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+  }
+
+  // Calls the `done` callbacks of `finished`, which must be called without
+  // holding `mu_`.
+  static void RunDone(std::vector<Batch*>* finished) {
+    for (Batch* batch : *finished) {
+      batch->done();
+      delete batch;
+    }
+    finished->clear();
+  }
+
+  // Records the result of a read into `op`. Returns true if the read has
+  // completed, in which case `op` is deleted, and false if the rest of it
+  // must be submitted again.
+  bool CompleteLocked(Operation* op, int result)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    RandomAccessFile::ReadRequest* request = op->request;
+    if (result == -EINTR || result == -EAGAIN) {
+      return false;
+    } else if (result < 0) {
+      request->status = IOError(op->batch->filename, -result);
+    } else if (result == 0) {
+      request->status = errors::OutOfRange("Read less bytes than requested");
+    } else {
+      op->bytes_read += result;
+      if (op->bytes_read < request->n) {
+        return false;
+      }
+    }
+    request->result = StringPiece(request->scratch, op->bytes_read);
+    delete op;
+    return true;
+  }
+
+  // Reaps completions and calls the `done` callbacks of finished batches.
+  void CompletionLoop() {
+    std::vector<std::pair<Operation*, int>> completions;
+    std::vector<Batch*> finished;
+    while (true) {
+      unsigned head = *cq_head_;
+      const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      if (head == tail) {
+        const int ret = syscall(__NR_io_uring_enter, ring_fd_, 0, 1,
+                                IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (ret < 0 && errno != EINTR) {
+          LOG(FATAL) << "io_uring_enter() failed: " << strerror(errno);
+        }
+        continue;
+      }
+      for (; head != tail; ++head) {
+        const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+        completions.emplace_back(reinterpret_cast<Operation*>(cqe.user_data),
+                                 cqe.res);
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+      {
+        mutex_lock l(mu_);
+        in_flight_ -= completions.size();
+        for (const auto& completion : completions) {
+          Operation* op = completion.first;
+          Batch* batch = op->batch;
+          if (!CompleteLocked(op, completion.second)) {
+            queued_.push_front(op);
+          } else if (--batch->pending == 0) {
+            finished.push_back(batch);
+          }
+        }
+        if (!SubmitLocked(&finished)) {
+          SubmitWithBackoffLocked(&finished);
+        }
+      }
+      completions.clear();
+      RunDone(&finished);
+    }
+  }
+
+  const int ring_fd_;
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  // Pointers into the rings. The submission queue is only written under
+  // `mu_` and the completion queue is only read by the completion thread.
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+  unsigned max_in_flight_ = 0;
+
+  mutex mu_;
+  // Operations waiting for space in the submission queue.
+  std::deque<Operation*> queued_ TF_GUARDED_BY(mu_);
+  // Number of entries added to the submission queue but not yet submitted.
+  unsigned unsubmitted_ TF_GUARDED_BY(mu_) = 0;
+  // Number of operations submitted whose completion has not been reaped.
+  unsigned in_flight_ TF_GUARDED_BY(mu_) = 0;
+  std::unique_ptr<Thread> completion_thread_;
+};
+
+}  // namespace
+#endif  // defined(TF_POSIX_HAS_IO_URING)
+
+PosixIoUring* PosixIoUring::Get() {
+#if defined(TF_POSIX_HAS_IO_URING)
+  static PosixIoUring* io_uring = IoUring::Create();
+  return io_uring;
+#else
+  return nullptr;
+#endif
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,49 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_DEFAULT_POSIX_IO_URING_H_
+#define TENSORFLOW_CORE_PLATFORM_DEFAULT_POSIX_IO_URING_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/file_system.h"
+
+namespace tensorflow {
+
+// Performs asynchronous reads of local files through a Linux io_uring
+// instance, so that deep queues of reads can be kept against fast local
+// storage with a single completion thread.
+class PosixIoUring {
+ public:
+  virtual ~PosixIoUring() = default;
+
+  // Returns the process-wide instance, or nullptr if io_uring is not
+  // supported by the platform or the kernel.
+  static PosixIoUring* Get();
+
+  // Reads each of `requests` from `fd`, then calls `done`, usually on the
+  // completion thread. If the reads cannot be submitted, the requests are
+  // failed and `done` may be called on the calling thread. `filename` is used
+  // in error messages.
+  virtual void Read(int fd, const std::string& filename,
+                    std::vector<RandomAccessFile::ReadRequest>* requests,
+                    std::function<void()> done) = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_DEFAULT_POSIX_IO_URING_H_
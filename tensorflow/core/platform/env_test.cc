@@ -20,7 +20,9 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cord.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/null_file_system.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -90,6 +92,86 @@ TEST_F(DefaultEnvTest, IncompleteReadOutOfRange) {
   EXPECT_EQ(input, result);
 }
 
+TEST_F(DefaultEnvTest, ReadAsync) {
+  const string filename = io::JoinPath(BaseDir(), "read_async");
+  const string input = CreateTestFile(env_, filename, 10000);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  // Reads at increasing offsets, an empty read, and a read past EOF.
+  std::vector<RandomAccessFile::ReadRequest> requests(5);
+  std::vector<string> scratch(requests.size(), string(3000, 0));
+  for (int i = 0; i < requests.size(); ++i) {
+    requests[i].offset = i * 2000;
+    requests[i].n = 1500;
+    requests[i].scratch = &scratch[i][0];
+  }
+  requests[2].n = 0;
+  requests[4].n = 3000;
+
+  Notification done;
+  f->ReadAsync(&requests, [&done]() { done.Notify(); });
+  done.WaitForNotification();
+
+  for (int i = 0; i < 4; ++i) {
+    TF_EXPECT_OK(requests[i].status);
+    EXPECT_EQ(input.substr(requests[i].offset, requests[i].n),
+              requests[i].result);
+  }
+  EXPECT_EQ(error::OUT_OF_RANGE, requests[4].status.code());
+  EXPECT_EQ(input.substr(8000), requests[4].result);
+}
+
+// File whose one-byte reads each wait until `num_reads` reads have started,
+// and which reads 'a' + offset.
+class ConcurrentReadsFile : public RandomAccessFile {
+ public:
+  explicit ConcurrentReadsFile(int num_reads) : started_(num_reads) {}
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    started_.DecrementCount();
+    if (!started_.WaitFor(std::chrono::seconds(10))) {
+      return errors::DeadlineExceeded("Reads did not run concurrently");
+    }
+    scratch[0] = 'a' + offset;
+    *result = StringPiece(scratch, 1);
+    return Status::OK();
+  }
+
+ private:
+  mutable BlockingCounter started_;
+};
+
+TEST(RandomAccessFileTest, DefaultReadAsyncReadsConcurrently) {
+  const int kNumReads = 4;
+  ConcurrentReadsFile f(kNumReads);
+  std::vector<RandomAccessFile::ReadRequest> requests(kNumReads);
+  string scratch(kNumReads, 0);
+  for (int i = 0; i < kNumReads; ++i) {
+    requests[i].offset = i;
+    requests[i].n = 1;
+    requests[i].scratch = &scratch[i];
+  }
+
+  Notification done;
+  f.ReadAsync(&requests, [&done]() { done.Notify(); });
+  done.WaitForNotification();
+
+  for (int i = 0; i < kNumReads; ++i) {
+    TF_EXPECT_OK(requests[i].status);
+    EXPECT_EQ(string(1, 'a' + i), requests[i].result);
+  }
+}
+
+TEST(RandomAccessFileTest, DefaultReadAsyncWithoutRequests) {
+  ConcurrentReadsFile f(/*num_reads=*/0);
+  std::vector<RandomAccessFile::ReadRequest> requests;
+  bool done = false;
+  f.ReadAsync(&requests, [&done]() { done = true; });
+  EXPECT_TRUE(done);
+}
+
 TEST_F(DefaultEnvTest, ReadFileToString) {
   for (const int length : {0, 1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1, (256 << 20) + 100}) {
@@ -18,7 +18,9 @@ limitations under the License.
 #include <sys/stat.h>
 
 #include <algorithm>
+#include <atomic>
 #include <deque>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -35,9 +37,18 @@ limitations under the License.
 #include "tensorflow/core/platform/scanner.h"
 #include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Number of threads in `RandomAccessFile::AsyncReadThreadPool()`. Its threads
+// mostly wait for I/O, so there can be more of them than cores.
+constexpr int kNumAsyncReadThreads = 16;
+
+}  // namespace
+
 bool FileSystem::Match(const string& filename, const string& pattern) {
 #if defined(PLATFORM_POSIX) || defined(IS_MOBILE_PLATFORM)
   // We avoid relying on RE2 on mobile platforms, because it incurs a
@@ -451,4 +462,41 @@ std::string FileSystem::DecodeTransaction(const TransactionToken* token) {
   return "No Transaction";
 }
 
+thread::ThreadPool* RandomAccessFile::AsyncReadThreadPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "async_file_read", kNumAsyncReadThreads);
+  return pool;
+}
+
+void RandomAccessFile::ReadAsync(std::vector<ReadRequest>* requests,
+                                 std::function<void()> done) const {
+  thread::ThreadPool* pool = AsyncReadThreadPool();
+  // Reading on the pool from one of its threads could deadlock once all of
+  // them wait for each other, so such reads are performed inline.
+  if (requests->empty() || pool->CurrentThreadId() >= 0) {
+    for (ReadRequest& request : *requests) {
+      request.status = Read(request.offset, request.n, &request.result,
+                            request.scratch);
+    }
+    done();
+    return;
+  }
+  struct Batch {
+    std::atomic<size_t> num_pending;
+    std::function<void()> done;
+  };
+  auto batch = std::make_shared<Batch>();
+  batch->num_pending = requests->size();
+  batch->done = std::move(done);
+  for (ReadRequest& request : *requests) {
+    pool->Schedule([this, &request, batch]() {
+      request.status = Read(request.offset, request.n, &request.result,
+                            request.scratch);
+      if (batch->num_pending.fetch_sub(1) == 1) {
+        batch->done();
+      }
+    });
+  }
+}
+
 }  // namespace tensorflow
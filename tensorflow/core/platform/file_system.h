@@ -44,6 +44,10 @@ class RandomAccessFile;
 class ReadOnlyMemoryRegion;
 class WritableFile;
 
+namespace thread {
+class ThreadPool;
+}  // namespace thread
+
 class FileSystem;
 struct TransactionToken {
   FileSystem* owner;
@@ -761,6 +765,43 @@ class RandomAccessFile {
   }
 #endif
 
+  /// \brief A read performed by `ReadAsync()`.
+  struct ReadRequest {
+    uint64 offset = 0;
+    size_t n = 0;
+    /// Buffer of at least `n` bytes that `result` may point into.
+    char* scratch = nullptr;
+    /// Set as by `Read()` once the read has completed.
+    StringPiece result;
+    tensorflow::Status status;
+  };
+
+  /// \brief Performs each of `requests` as by `Read()`, then calls `done`.
+  ///
+  /// Unlike `Read()`, the calling thread does not wait for the reads to
+  /// complete, so that many reads can be outstanding without dedicating a
+  /// thread to each. `requests`, their scratch buffers and this file must
+  /// remain live until `done` is called. `done` may be called on an internal
+  /// thread, or on the calling thread before `ReadAsync()` returns, and
+  /// should not block.
+  ///
+  /// The default implementation performs the reads concurrently with
+  /// `Read()` on `AsyncReadThreadPool()`, and calls `done` on the thread
+  /// that completes the last of them.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadAsync(std::vector<ReadRequest>* requests,
+                         std::function<void()> done) const;
+
+  /// \brief Returns the process-wide pool on which the default `ReadAsync()`
+  /// blocks in reads.
+  ///
+  /// The pool is created on first use and has a fixed number of threads, so
+  /// it bounds the threads blocked in background reads of all files. Other
+  /// readers that read ahead of their callers should schedule on it too.
+  /// Work on the pool must not wait for other work on the pool.
+  static thread::ThreadPool* AsyncReadThreadPool();
+
  private:
   TF_DISALLOW_COPY_AND_ASSIGN(RandomAccessFile);
 };
@@ -21,6 +21,7 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -64,6 +65,35 @@ const char* const kHeaderEntryKey = "";
 
 namespace {
 
+// A read-only TensorBuffer that aliases part of a memory-mapped data file. It
+// shares ownership of the mapping, so the mapping outlives the BundleReader
+// for as long as any tensor references the buffer.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("mmap");
+  }
+
+  // The mapping is read-only, so the buffer must never be forwarded to an
+  // output and written to in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
 // Reads "num_elements" string elements from file[offset, offset+size) into the
 // length-N "destination".  Discards the original content of "destination".
 //
@@ -741,13 +771,16 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 
 // Interface for reading a tensor bundle.
 
-BundleReader::BundleReader(Env* env, StringPiece prefix)
+BundleReader::BundleReader(Env* env, StringPiece prefix,
+                           const Options& options)
     : env_(env),
       prefix_(prefix),
+      options_(options),
       metadata_(nullptr),
       table_(nullptr),
       index_cache_(nullptr),
       iter_(nullptr),
+      mmap_unsupported_(false),
       need_to_swap_bytes_(false) {
   const string filename = MetaFilename(prefix_);
   uint64 file_size;
@@ -841,6 +874,10 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
 }
 
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
+  if (options_.use_mmap && !mmap_unsupported_ &&
+      DataTypeCanUseMemcpy(entry.dtype()) && !need_to_swap_bytes_) {
+    return GetMappedValue(entry, val);
+  }
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
   if (val->NumElements() == 0) {
@@ -950,6 +987,73 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::GetMappedValue(const BundleEntryProto& entry,
+                                    Tensor* val) {
+  const TensorShape stored_shape(TensorShape(entry.shape()));
+  const size_t expected_size =
+      stored_shape.num_elements() * DataTypeSize(entry.dtype());
+  if (entry.size() != expected_size ||
+      (val->NumElements() != 0 && entry.size() != val->TotalBytes())) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key(),
+                            "; stored size ", entry.size(),
+                            "; expected size ", expected_size);
+  }
+  if (entry.size() == 0) {
+    if (val->NumElements() == 0) {
+      *val = Tensor(entry.dtype(), stored_shape);
+    }
+    return Status::OK();
+  }
+
+  std::shared_ptr<ReadOnlyMemoryRegion>& region =
+      mapped_data_[entry.shard_id()];
+  if (region == nullptr) {
+    std::unique_ptr<ReadOnlyMemoryRegion> mapped;
+    Status s = env_->NewReadOnlyMemoryRegionFromFile(
+        DataFilename(prefix_, entry.shard_id(), num_shards_), &mapped);
+    if (errors::IsUnimplemented(s)) {
+      VLOG(1) << "Memory-mapping is not supported for " << prefix_
+              << ", falling back to buffered reads: " << s;
+      mapped_data_.erase(entry.shard_id());
+      mmap_unsupported_ = true;
+      return GetValue(entry, val);
+    }
+    TF_RETURN_IF_ERROR(s);
+    region = std::move(mapped);
+  }
+  if (entry.offset() + entry.size() > region->length()) {
+    return errors::DataLoss("TensorBundle at ", prefix_, " shard ",
+                            entry.shard_id(), ": entry ", key(), " at offset ",
+                            entry.offset(), " (", entry.size(),
+                            " bytes) extends past the end of the file (",
+                            region->length(), " bytes)");
+  }
+  const char* data =
+      static_cast<const char*>(region->data()) + entry.offset();
+  const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+        entry.size(), " bytes): Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the restored bytes ", actual_crc32c);
+  }
+
+  if (val->NumElements() == 0 &&
+      reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES == 0) {
+    MappedTensorBuffer* buf =
+        new MappedTensorBuffer(region, data, entry.size());
+    *val = Tensor(entry.dtype(), stored_shape, buf);
+    buf->Unref();
+    return Status::OK();
+  }
+  if (val->NumElements() == 0) {
+    *val = Tensor(entry.dtype(), stored_shape);
+  }
+  memcpy(const_cast<char*>(val->tensor_data().data()), data, entry.size());
+  return Status::OK();
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
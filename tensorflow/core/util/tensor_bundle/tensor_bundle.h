@@ -182,7 +182,19 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 // All threads accessing the same BundleReader must synchronize.
 class BundleReader {
  public:
-  BundleReader(Env* const env, StringPiece prefix);
+  struct Options {
+    Options() {}
+    // If true, data files are memory-mapped instead of being read through a
+    // buffer. Tensors whose type can be memcpy'd and whose data is suitably
+    // aligned in the file (see BundleWriter::Options::data_alignment) are
+    // then returned as read-only views into the mapping, which stays alive
+    // for as long as any such tensor references it. Other tensors are copied
+    // out of the mapping. Falls back to buffered reads if the file system
+    // does not support memory mapping.
+    bool use_mmap{false};
+  };
+  BundleReader(Env* const env, StringPiece prefix,
+               const Options& options = Options());
   ~BundleReader();
 
   // Is ok() iff the reader construction is successful (completed the read of
@@ -275,6 +287,13 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Like "GetValue()", but reads the value out of the memory-mapped data file.
+  // If "val" is empty and the stored data is aligned, "val" is set to a tensor
+  // aliasing the mapping instead of being copied.
+  // REQUIRES: DataTypeCanUseMemcpy(entry.dtype()) && !need_to_swap_bytes_
+  Status GetMappedValue(const BundleEntryProto& entry,
+                        Tensor* val) TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -285,6 +304,7 @@ class BundleReader {
 
   Env* env_;  // Not owned.
   const string prefix_;
+  const Options options_;
 
   Status status_;
   RandomAccessFile* metadata_;  // Owned.
@@ -293,6 +313,12 @@ class BundleReader {
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
+  // Memory-mapped data files, if "options_.use_mmap" is set. Shared with the
+  // tensors that alias them.
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
+  // Set if the file system does not support memory-mapping the data files.
+  bool mmap_unsupported_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -1112,6 +1112,59 @@ TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
   }
 }
 
+TEST(TensorBundleTest, MemoryMappedReads) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), Prefix("mmap"), opts);
+    TF_EXPECT_OK(writer.Add("float", Constant_2x3<float>(1.5)));
+    TF_EXPECT_OK(writer.Add("int64", Constant_2x3<int64>(7)));
+    TF_EXPECT_OK(writer.Add("string", Constant_2x3<tstring>("foo")));
+    TF_EXPECT_OK(writer.Add("empty", Constant(0.0f, TensorShape({0, 3}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor aliased;
+  {
+    BundleReader::Options opts;
+    opts.use_mmap = true;
+    BundleReader reader(Env::Default(), Prefix("mmap"), opts);
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "float", Constant_2x3<float>(1.5));
+    Expect<int64>(&reader, "int64", Constant_2x3<int64>(7));
+    Expect<tstring>(&reader, "string", Constant_2x3<tstring>("foo"));
+    Expect<float>(&reader, "empty", Constant(0.0f, TensorShape({0, 3})));
+
+    // Aligned tensors read into an empty tensor alias the mapping, so two
+    // lookups of the same key share their buffer.
+    Tensor other;
+    TF_ASSERT_OK(reader.Lookup("float", &aliased));
+    TF_ASSERT_OK(reader.Lookup("float", &other));
+    EXPECT_EQ(aliased.tensor_data().data(), other.tensor_data().data());
+    // Aliased buffers must never be forwarded and written to in place.
+    EXPECT_FALSE(other.RefCountIsOne());
+  }
+  // The mapping outlives the reader while it is referenced.
+  test::ExpectTensorEqual<float>(aliased, Constant_2x3<float>(1.5));
+}
+
+TEST(TensorBundleTest, MemoryMappedReadsOfUnalignedData) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("mmap_unaligned"));
+    TF_EXPECT_OK(writer.Add("a", Constant(true, TensorShape({1}))));
+    TF_EXPECT_OK(writer.Add("b", Constant_2x3<double>(2.5)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader::Options opts;
+  opts.use_mmap = true;
+  BundleReader reader(Env::Default(), Prefix("mmap_unaligned"), opts);
+  TF_ASSERT_OK(reader.status());
+  Expect<bool>(&reader, "a", Constant(true, TensorShape({1})));
+  Expect<double>(&reader, "b", Constant_2x3<double>(2.5));
+  reader.Seek(kHeaderEntryKey);
+  ExpectNext<bool>(&reader, Constant(true, TensorShape({1})));
+  ExpectNext<double>(&reader, Constant_2x3<double>(2.5));
+}
+
 static void BM_BundleAlignmentByteOff(::testing::benchmark::State& state,
                                       int alignment, int tensor_size) {
   {
@@ -30,10 +30,13 @@ from tensorflow.python.data.kernel_tests import test_base
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.eager import context
 from tensorflow.python.framework import combinations
+from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import errors_impl
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import sparse_tensor
+from tensorflow.python.framework import tensor_spec
+from tensorflow.python.ops import gen_experimental_dataset_ops
 from tensorflow.python.ops import parsing_ops
 from tensorflow.python.ops.ragged import ragged_factory_ops
 from tensorflow.python.platform import test
@@ -1147,6 +1150,67 @@ class ParseExampleDatasetTest(test_base.DatasetTestBase,
     else:
       self.assertCountEqual(expected, actual)
 
+  def _batched_parse_dataset(self, num_examples, batch_size, drop_remainder,
+                             batch_dim=None):
+    """Parses feature "a" of `num_examples` Examples in batches."""
+    serialized = [
+        example(features=features({
+            "a": int64_feature([i]),
+        })).SerializeToString() for i in range(num_examples)
+    ]
+    dataset = dataset_ops.Dataset.from_tensor_slices(serialized)
+    variant_tensor = gen_experimental_dataset_ops.parse_example_dataset_v2(
+        dataset._variant_tensor,  # pylint: disable=protected-access
+        num_parallel_calls=2,
+        dense_defaults=[constant_op.constant([], dtype=dtypes.int64)],
+        sparse_keys=[],
+        dense_keys=["a"],
+        sparse_types=[],
+        dense_shapes=[[1]],
+        output_types=[dtypes.int64],
+        output_shapes=[[batch_dim, 1]],
+        batch_size=batch_size,
+        drop_remainder=drop_remainder)
+    # pylint: disable=protected-access
+    return dataset_ops._VariantDataset(
+        variant_tensor, tensor_spec.TensorSpec([batch_dim, 1], dtypes.int64))
+
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(
+              num_examples=[4, 5],
+              drop_remainder=[True, False])))
+  def testBatchSize(self, num_examples, drop_remainder):
+    dataset = self._batched_parse_dataset(
+        num_examples, batch_size=2, drop_remainder=drop_remainder)
+    expected_output = [[[0], [1]], [[2], [3]]]
+    if num_examples == 5 and not drop_remainder:
+      # The partial last batch is kept.
+      expected_output.append([[4]])
+    self.assertDatasetProduces(dataset, expected_output=expected_output)
+    self.assertEqual(
+        len(expected_output), self.evaluate(dataset.cardinality()))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testBatchSizeWithStaticBatchDimension(self):
+    dataset = self._batched_parse_dataset(
+        5, batch_size=2, drop_remainder=True, batch_dim=2)
+    self.assertDatasetProduces(
+        dataset, expected_output=[[[0], [1]], [[2], [3]]])
+
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(
+              drop_remainder=[True, False])))
+  def testBatchSizeWithIncompatibleBatchDimension(self, drop_remainder):
+    with self.assertRaisesRegex(errors_impl.InvalidArgumentError,
+                                "is not compatible with batch_size"):
+      dataset = self._batched_parse_dataset(
+          5, batch_size=2, drop_remainder=drop_remainder, batch_dim=3)
+      self.evaluate(self.getNext(dataset)())
+
 
 if __name__ == "__main__":
   test.main()
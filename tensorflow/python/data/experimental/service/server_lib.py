@@ -218,7 +218,8 @@ class DispatchServer(object):
 class WorkerConfig(
     collections.namedtuple("WorkerConfig", [
         "dispatcher_address", "worker_address", "port", "protocol",
-        "heartbeat_interval_ms", "dispatcher_timeout_ms"
+        "heartbeat_interval_ms", "dispatcher_timeout_ms",
+        "cross_job_cache_size", "element_prefetch_bytes"
     ])):
   """Configuration class for tf.data service dispatchers.
 
@@ -238,6 +239,16 @@ class WorkerConfig(
       from finished jobs.
     dispatcher_timeout_ms: How long, in milliseconds, to retry requests to the
       dispatcher before giving up and reporting an error. Defaults to 1 hour.
+    cross_job_cache_size: (Optional.) If positive, jobs reading the same
+      infinite dataset in parallel epochs share a cache of this many elements
+      on the worker, so that each element is produced once instead of once
+      per job. A job that falls behind the others skips the elements that
+      have left the cache. Defaults to 0, which disables sharing.
+    element_prefetch_bytes: (Optional.) If positive, the worker produces
+      elements of non-round-robin tasks ahead of requests, buffering up to
+      about this many bytes per task, so that clients can fetch several
+      elements per request. Defaults to 0, which produces elements only when
+      they are requested.
   """
 
   def __new__(cls,
@@ -246,7 +257,9 @@ class WorkerConfig(
               port=0,
               protocol="grpc",
               heartbeat_interval_ms=None,
-              dispatcher_timeout_ms=None):
+              dispatcher_timeout_ms=None,
+              cross_job_cache_size=0,
+              element_prefetch_bytes=0):
     if worker_address is None:
       worker_address = "localhost:%port%"
     if heartbeat_interval_ms is None:
@@ -257,7 +270,8 @@ class WorkerConfig(
     return super(WorkerConfig,
                  cls).__new__(cls, dispatcher_address, worker_address, port,
                               protocol, heartbeat_interval_ms,
-                              dispatcher_timeout_ms)
+                              dispatcher_timeout_ms, cross_job_cache_size,
+                              element_prefetch_bytes)
 
 
 @tf_export("data.experimental.service.WorkerServer", v1=[])
@@ -308,7 +322,9 @@ class WorkerServer(object):
         protocol=config.protocol,
         heartbeat_interval_ms=config.heartbeat_interval_ms,
         dispatcher_timeout_ms=config.dispatcher_timeout_ms,
-        data_transfer_protocol=None)
+        data_transfer_protocol=None,
+        cross_job_cache_size=config.cross_job_cache_size,
+        element_prefetch_bytes=config.element_prefetch_bytes)
     self._server = _pywrap_server_lib.TF_DATA_NewWorkerServer(
         config_proto.SerializeToString())
     if start:
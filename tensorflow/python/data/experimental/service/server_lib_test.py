@@ -107,6 +107,13 @@ class ServerLibTest(test.TestCase):
         server_lib.WorkerConfig(dispatcher._address, port=port), start=True)
     self.assertEqual(worker._address, "localhost:{}".format(port))
 
+  def testStartWorkerWithCrossJobCacheConfig(self):
+    dispatcher = server_lib.DispatchServer()
+    worker = server_lib.WorkerServer(
+        server_lib.WorkerConfig(dispatcher._address, cross_job_cache_size=8),
+        start=True)
+    self.assertEqual(worker._config.cross_job_cache_size, 8)
+
   def testMultipleStartWorker(self):
     dispatcher = server_lib.DispatchServer()
     worker = server_lib.WorkerServer(
@@ -409,6 +409,15 @@ class TFRecordIteratorTest(TFCompressionTestCase):
     actual = list(tf_record.tf_record_iterator(gzfn))
     self.assertEqual(actual, original)
 
+  def testWriteSnappyRead(self):
+    original = [b"foo", b"bar"]
+    options = tf_record.TFRecordOptions(TFRecordCompressionType.SNAPPY)
+    fn = self._WriteRecordsToFile(original, "write_snappy_read.tfrecord",
+                                  options)
+
+    actual = list(tf_record.tf_record_iterator(fn, options=options))
+    self.assertEqual(actual, original)
+
   def testReadGrowingFile_preservesReadOffset(self):
     """Verify that tf_record_iterator preserves read offset even after EOF.
 